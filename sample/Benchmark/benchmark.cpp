@@ -0,0 +1,450 @@
+#include "benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Percentile of Sorted Samples (Nearest Rank)
+static double percentile( const std::vector<double>& sorted, const double rate )
+{
+    const size_t index = static_cast<size_t>( std::ceil( rate * sorted.size() ) );
+    return sorted[std::min( std::max<size_t>( index, 1 ), sorted.size() ) - 1];
+}
+
+// Constructor
+Benchmark::Benchmark( int argc, char* argv[] )
+{
+    // Initialize
+    initialize( argc, argv );
+}
+
+// Destructor
+Benchmark::~Benchmark()
+{
+    // Finalize
+    finalize();
+}
+
+// Processing
+void Benchmark::run()
+{
+    // Benchmark on Synthetic Frames
+    for( const cv::Size& resolution : resolutions ){
+        const source synthetic = createSynthetic( resolution.width, resolution.height );
+        benchmark( synthetic );
+    }
+
+    // Benchmark on Recorded Frames
+    if( !file_name.empty() ){
+        const source recorded = loadRecorded();
+        benchmark( recorded );
+    }
+
+    // Report Result
+    report();
+}
+
+// Initialize
+void Benchmark::initialize( int argc, char* argv[] )
+{
+    cv::setUseOptimized( true );
+
+    // Parse Arguments
+    parseArguments( argc, argv );
+}
+
+// Parse Arguments
+inline void Benchmark::parseArguments( int argc, char* argv[] )
+{
+    const std::string usage = "usage : benchmarks [--warmup N] [--repetitions N] [--frames N] [--output benchmark.json] [file.bag]";
+    for( int32_t i = 1; i < argc; i++ ){
+        const std::string argument = argv[i];
+        const bool has_value = i + 1 < argc;
+        if( argument == "--warmup" && has_value ){
+            warmup = static_cast<uint32_t>( std::stoul( argv[++i] ) );
+        }
+        else if( argument == "--repetitions" && has_value ){
+            repetitions = static_cast<uint32_t>( std::stoul( argv[++i] ) );
+        }
+        else if( argument == "--frames" && has_value ){
+            recorded_frames = static_cast<uint32_t>( std::stoul( argv[++i] ) );
+        }
+        else if( argument == "--output" && has_value ){
+            output_file_name = argv[++i];
+        }
+        else if( !argument.empty() && argument[0] != '-' ){
+            file_name = argument;
+        }
+        else{
+            throw std::runtime_error( usage );
+        }
+    }
+
+    if( !repetitions || !recorded_frames ){
+        throw std::runtime_error( usage );
+    }
+}
+
+// Finalize
+void Benchmark::finalize()
+{
+}
+
+// Create Synthetic Source
+inline Benchmark::source Benchmark::createSynthetic( const uint32_t width, const uint32_t height )
+{
+    source synthetic;
+    synthetic.name = "synthetic";
+    synthetic.width = width;
+    synthetic.height = height;
+
+    // Create Software Device with Depth and Color Sensor
+    rs2::software_device device;
+    rs2::software_sensor depth_sensor = device.add_sensor( "Depth" );
+    rs2::software_sensor color_sensor = device.add_sensor( "Color" );
+
+    // Field of View is Similar to D400 Series (Depth 87 deg, Color 69 deg)
+    const int32_t w = static_cast<int32_t>( width );
+    const int32_t h = static_cast<int32_t>( height );
+    const rs2_intrinsics depth_intrinsics = { w, h, w * 0.5f, h * 0.5f, w * 0.53f, w * 0.53f, rs2_distortion::RS2_DISTORTION_BROWN_CONRADY, { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f } };
+    const rs2_intrinsics color_intrinsics = { w, h, w * 0.5f, h * 0.5f, w * 0.73f, w * 0.73f, rs2_distortion::RS2_DISTORTION_BROWN_CONRADY, { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f } };
+    rs2::stream_profile depth_profile = depth_sensor.add_video_stream( { rs2_stream::RS2_STREAM_DEPTH, 0, 0, w, h, 30, 2, rs2_format::RS2_FORMAT_Z16, depth_intrinsics } );
+    rs2::stream_profile color_profile = color_sensor.add_video_stream( { rs2_stream::RS2_STREAM_COLOR, 0, 1, w, h, 30, 3, rs2_format::RS2_FORMAT_BGR8, color_intrinsics } );
+    depth_sensor.add_read_only_option( rs2_option::RS2_OPTION_DEPTH_UNITS, 0.001f );
+    depth_profile.register_extrinsics_to( color_profile, { { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.015f, 0.0f, 0.0f } } );
+    device.create_matcher( RS2_MATCHER_DEFAULT );
+
+    // Start Sensors into Syncer
+    rs2::syncer syncer;
+    depth_sensor.open( depth_profile );
+    color_sensor.open( color_profile );
+    depth_sensor.start( syncer );
+    color_sensor.start( syncer );
+
+    // Allocate Buffers (Buffers must be Alive while Frames are Alive)
+    synthetic.buffers.resize( synthetic_frames * 2 );
+    for( uint32_t i = 0; i < synthetic_frames; i++ ){
+        std::vector<uint8_t>& depth = synthetic.buffers[i * 2 + 0];
+        std::vector<uint8_t>& color = synthetic.buffers[i * 2 + 1];
+        depth.resize( width * height * sizeof( uint16_t ) );
+        color.resize( width * height * 3 );
+
+        // Generate Depth (Tilted Plane and Sphere, with Invalid Band and Holes) and Color (Gradient)
+        uint32_t random = 12345 + i;
+        uint16_t* depth_data = reinterpret_cast<uint16_t*>( depth.data() );
+        const float radius = height * 0.25f;
+        for( uint32_t y = 0; y < height; y++ ){
+            for( uint32_t x = 0; x < width; x++ ){
+                random = random * 1664525 + 1013904223;
+                const float dx = x - width * 0.5f + i * 4.0f;
+                const float dy = y - height * 0.5f;
+                const float distance = dx * dx + dy * dy;
+                float z = 1000.0f + 1500.0f * y / height;
+                if( distance < radius * radius ){
+                    z -= 400.0f * std::sqrt( 1.0f - distance / ( radius * radius ) );
+                }
+                const bool hole = ( x < width / 20 ) || ( ( random >> 24 ) < 5 );
+                depth_data[y * width + x] = hole ? 0 : static_cast<uint16_t>( z + ( ( random >> 16 ) & 0x3 ) );
+
+                uint8_t* color_data = color.data() + ( y * width + x ) * 3;
+                color_data[0] = static_cast<uint8_t>( x * 255 / width );
+                color_data[1] = static_cast<uint8_t>( y * 255 / height );
+                color_data[2] = static_cast<uint8_t>( i * 32 + x + y );
+            }
+        }
+    }
+
+    // Inject Frames until Synchronized Framesets are Collected
+    const uint32_t max_attempts = synthetic_frames * 10;
+    for( uint32_t frame_number = 0; synthetic.framesets.size() < synthetic_frames && frame_number < max_attempts; frame_number++ ){
+        const uint32_t index = frame_number % synthetic_frames;
+        const double timestamp = frame_number * 1000.0 / 30.0;
+        depth_sensor.on_video_frame( { synthetic.buffers[index * 2 + 0].data(), []( void* ){}, w * 2, 2, timestamp, rs2_timestamp_domain::RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, static_cast<int32_t>( frame_number ), depth_profile.get() } );
+        color_sensor.on_video_frame( { synthetic.buffers[index * 2 + 1].data(), []( void* ){}, w * 3, 3, timestamp, rs2_timestamp_domain::RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, static_cast<int32_t>( frame_number ), color_profile.get() } );
+
+        rs2::frameset frameset;
+        while( synthetic.framesets.size() < synthetic_frames && syncer.try_wait_for_frames( &frameset, 100 ) ){
+            if( frameset.get_depth_frame() && frameset.get_color_frame() ){
+                frameset.keep();
+                synthetic.framesets.push_back( frameset );
+            }
+        }
+    }
+
+    if( synthetic.framesets.empty() ){
+        throw std::runtime_error( "failed to create synthetic frames" );
+    }
+
+    synthetic.device = device;
+    return synthetic;
+}
+
+// Load Recorded Source
+inline Benchmark::source Benchmark::loadRecorded()
+{
+    source recorded;
+    recorded.name = "recorded";
+
+    // Play File as Fast as Possible without Dropping Frames
+    rs2::config config;
+    config.enable_device_from_file( file_name, false );
+    rs2::pipeline pipeline;
+    rs2::pipeline_profile pipeline_profile = pipeline.start( config );
+    rs2::playback playback = pipeline_profile.get_device().as<rs2::playback>();
+    playback.set_real_time( false );
+
+    // Keep Framesets (Kept Frames are Not Counted against Frame Pool)
+    rs2::frameset frameset;
+    while( recorded.framesets.size() < recorded_frames && pipeline.try_wait_for_frames( &frameset, 1000 ) ){
+        if( !frameset.get_depth_frame() ){
+            continue;
+        }
+        frameset.keep();
+        recorded.framesets.push_back( frameset );
+    }
+    pipeline.stop();
+
+    if( recorded.framesets.empty() ){
+        throw std::runtime_error( "failed to load depth frames from " + file_name );
+    }
+
+    const rs2::video_frame depth_frame = recorded.framesets.front().get_depth_frame();
+    recorded.width = depth_frame.get_width();
+    recorded.height = depth_frame.get_height();
+    recorded.device = pipeline_profile.get_device();
+    return recorded;
+}
+
+// Benchmark All Kernels on Source
+void Benchmark::benchmark( const source& source )
+{
+    std::cout << source.name << " " << source.width << "x" << source.height << " (" << source.framesets.size() << " frames)" << std::endl;
+
+    // Benchmark Depth Scaling (showDepth)
+    benchmarkShowDepth( source );
+
+    // Benchmark Texture Mapping of Point Cloud (drawPointCloud)
+    benchmarkPointCloudTexture( source );
+
+    // Benchmark Post-Processing Filters (applyFilters)
+    benchmarkApplyFilters( source );
+
+    // Benchmark Alignment (rs2::align)
+    benchmarkAlign( source );
+
+    // Benchmark Disparity Transform (rs2::disparity_transform)
+    benchmarkDisparity( source );
+}
+
+// Benchmark Depth Scaling (showDepth)
+inline void Benchmark::benchmarkShowDepth( const source& source )
+{
+    measure( "show_depth", source, [&]( const size_t index ){
+        const rs2::video_frame depth_frame = source.framesets[index].get_depth_frame();
+        const cv::Mat depth_mat( depth_frame.get_height(), depth_frame.get_width(), CV_16SC1, const_cast<void*>( depth_frame.get_data() ) );
+
+        // Same as RealSense::showDepth()
+        cv::Mat scale_mat;
+        depth_mat.convertTo( scale_mat, CV_8U, -255.0 / 10000.0, 255.0 ); // 0-10000 -> 255(white)-0(black)
+    } );
+}
+
+// Benchmark Texture Mapping of Point Cloud (drawPointCloud)
+inline void Benchmark::benchmarkPointCloudTexture( const source& source )
+{
+    // Calculate Point Cloud in Advance (Texture Mapping is Measured)
+    rs2::pointcloud pointcloud;
+    std::vector<rs2::points> points;
+    for( const rs2::frameset& frameset : source.framesets ){
+        const rs2::video_frame color_frame = frameset.get_color_frame();
+        if( !color_frame || color_frame.get_bytes_per_pixel() != 3 ){
+            return;
+        }
+        pointcloud.map_to( color_frame );
+        rs2::points point = pointcloud.calculate( frameset.get_depth_frame() );
+        point.keep();
+        points.push_back( point );
+    }
+
+    measure( "point_cloud_texture", source, [&]( const size_t index ){
+        const rs2::video_frame color_frame = source.framesets[index].get_color_frame();
+        const int32_t color_width = color_frame.get_width();
+        const int32_t color_height = color_frame.get_height();
+        const cv::Mat color_mat( color_height, color_width, CV_8UC3, const_cast<void*>( color_frame.get_data() ) );
+        const rs2::vertex* vertices = points[index].get_vertices();
+        const rs2::texture_coordinate* texture_coordinates = points[index].get_texture_coordinates();
+        const int32_t size = static_cast<int32_t>( points[index].size() );
+
+        // Same as RealSense::drawPointCloud()
+        cv::Mat vertices_mat = cv::Mat( source.height, source.width, CV_32FC3, cv::Vec3f::all( std::numeric_limits<float>::quiet_NaN() ) );
+        cv::Mat texture_mat = cv::Mat( source.height, source.width, CV_8UC3, cv::Vec3b::all( 0 ) );
+
+        #pragma omp parallel for
+        for( int32_t i = 0; i < size; i++ ){
+            if( vertices[i].z ){
+                const rs2::vertex vertex = vertices[i];
+                vertices_mat.at<cv::Vec3f>( i ) = cv::Vec3f( vertex.x, vertex.y, vertex.z );
+
+                const rs2::texture_coordinate texture_coordinate = texture_coordinates[i];
+                const int32_t x = static_cast<int32_t>( texture_coordinate.u * static_cast<float>( color_width ) ); // [0.0, 1.0) -> [0, width)
+                const int32_t y = static_cast<int32_t>( texture_coordinate.v * static_cast<float>( color_height ) ); // [0.0, 1.0) -> [0, height)
+                if( ( 0 <= x ) && ( x < color_width ) && ( 0 <= y ) && ( y < color_height ) ){
+                    texture_mat.at<cv::Vec3b>( i ) = color_mat.at<cv::Vec3b>( y, x );
+                }
+            }
+        }
+    } );
+}
+
+// Benchmark Post-Processing Filters (applyFilters)
+inline void Benchmark::benchmarkApplyFilters( const source& source )
+{
+    // Same Options as Filter Sample
+    rs2::decimation_filter decimation_filter;
+    rs2::spatial_filter spatial_filter;
+    rs2::temporal_filter temporal_filter;
+    rs2::disparity_transform disparity_transform( true );
+    rs2::disparity_transform depth_transform( false );
+    if( decimation_filter.supports( rs2_option::RS2_OPTION_FILTER_MAGNITUDE ) ){
+        rs2::option_range option_range = decimation_filter.get_option_range( rs2_option::RS2_OPTION_FILTER_MAGNITUDE );
+        decimation_filter.set_option( rs2_option::RS2_OPTION_FILTER_MAGNITUDE, option_range.min );
+    }
+    if( spatial_filter.supports( rs2_option::RS2_OPTION_HOLES_FILL ) ){
+        rs2::option_range option_range = spatial_filter.get_option_range( rs2_option::RS2_OPTION_HOLES_FILL );
+        spatial_filter.set_option( rs2_option::RS2_OPTION_HOLES_FILL, option_range.max );
+    }
+
+    measure( "apply_filters", source, [&]( const size_t index ){
+        // Same as RealSense::applyFilters()
+        rs2::frame filtered_frame = source.framesets[index].get_depth_frame();
+        filtered_frame = decimation_filter.process( filtered_frame );
+        filtered_frame = disparity_transform.process( filtered_frame );
+        filtered_frame = spatial_filter.process( filtered_frame );
+        filtered_frame = temporal_filter.process( filtered_frame );
+        filtered_frame = depth_transform.process( filtered_frame );
+    } );
+}
+
+// Benchmark Alignment (rs2::align)
+inline void Benchmark::benchmarkAlign( const source& source )
+{
+    if( !source.framesets.front().get_color_frame() ){
+        return;
+    }
+
+    rs2::align align( rs2_stream::RS2_STREAM_COLOR );
+    measure( "align", source, [&]( const size_t index ){
+        rs2::frameset frameset = source.framesets[index];
+        const rs2::frameset aligned_frameset = align.process( frameset );
+    } );
+}
+
+// Benchmark Disparity Transform (rs2::disparity_transform)
+inline void Benchmark::benchmarkDisparity( const source& source )
+{
+    rs2::disparity_transform disparity_transform( true );
+    measure( "disparity_transform", source, [&]( const size_t index ){
+        const rs2::frame disparity_frame = disparity_transform.process( source.framesets[index].get_depth_frame() );
+    } );
+}
+
+// Measure Kernel
+inline void Benchmark::measure( const std::string& kernel, const source& source, const std::function<void( const size_t )>& function )
+{
+    const size_t count = source.framesets.size();
+
+    // Warm-Up
+    for( uint32_t i = 0; i < warmup; i++ ){
+        function( i % count );
+    }
+
+    // Repetition
+    result result;
+    result.kernel = kernel;
+    result.source = source.name;
+    result.width = source.width;
+    result.height = source.height;
+    result.samples.reserve( repetitions );
+    for( uint32_t i = 0; i < repetitions; i++ ){
+        const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        function( i % count );
+        result.samples.push_back( std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - start ).count() );
+    }
+
+    // Print Progress
+    std::vector<double> sorted = result.samples;
+    std::sort( sorted.begin(), sorted.end() );
+    std::cout << "  " << std::left << std::setw( 22 ) << kernel << std::right << std::fixed << std::setprecision( 3 )
+              << " p50 " << std::setw( 8 ) << percentile( sorted, 0.5 ) * 1000.0 << " ms"
+              << " p99 " << std::setw( 8 ) << percentile( sorted, 0.99 ) * 1000.0 << " ms" << std::endl;
+    std::cout.unsetf( std::ios::floatfield );
+
+    results.push_back( result );
+}
+
+// Report Result
+void Benchmark::report()
+{
+    std::ofstream ofs( output_file_name );
+    if( !ofs.is_open() ){
+        throw std::runtime_error( "failed to open " + output_file_name );
+    }
+    ofs << json();
+    std::cout << "result is written to " << output_file_name << std::endl;
+}
+
+// Convert Result to JSON
+inline std::string Benchmark::json()
+{
+#ifdef _OPENMP
+    const int32_t threads = omp_get_max_threads();
+#else
+    const int32_t threads = 1;
+#endif
+
+    std::ostringstream oss;
+    oss << std::setprecision( 6 );
+    oss << "{\n";
+    oss << "  \"librealsense\": \"" << RS2_API_VERSION_STR << "\",\n";
+    oss << "  \"opencv\": \"" << cv::getVersionString() << "\",\n";
+    oss << "  \"threads\": " << threads << ",\n";
+    oss << "  \"warmup\": " << warmup << ",\n";
+    oss << "  \"repetitions\": " << repetitions << ",\n";
+    oss << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const result& result = results[i];
+        std::vector<double> sorted = result.samples;
+        std::sort( sorted.begin(), sorted.end() );
+        const double mean = std::accumulate( sorted.begin(), sorted.end(), 0.0 ) / sorted.size();
+        const double median = percentile( sorted, 0.5 );
+        const double pixels = static_cast<double>( result.width ) * result.height;
+
+        oss << "    {\n";
+        oss << "      \"kernel\": \"" << result.kernel << "\",\n";
+        oss << "      \"source\": \"" << result.source << "\",\n";
+        oss << "      \"width\": " << result.width << ",\n";
+        oss << "      \"height\": " << result.height << ",\n";
+        oss << "      \"samples\": " << sorted.size() << ",\n";
+        oss << "      \"min_ms\": " << sorted.front() * 1000.0 << ",\n";
+        oss << "      \"mean_ms\": " << mean * 1000.0 << ",\n";
+        oss << "      \"p50_ms\": " << median * 1000.0 << ",\n";
+        oss << "      \"p90_ms\": " << percentile( sorted, 0.9 ) * 1000.0 << ",\n";
+        oss << "      \"p99_ms\": " << percentile( sorted, 0.99 ) * 1000.0 << ",\n";
+        oss << "      \"max_ms\": " << sorted.back() * 1000.0 << ",\n";
+        oss << "      \"frames_per_second\": " << 1.0 / median << ",\n";
+        oss << "      \"megapixels_per_second\": " << pixels / median / 1000000.0 << "\n";
+        oss << "    }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    oss << "  ]\n";
+    oss << "}\n";
+    return oss.str();
+}
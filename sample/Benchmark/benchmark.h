@@ -0,0 +1,105 @@
+#ifndef __BENCHMARK__
+#define __BENCHMARK__
+
+#include <librealsense2/rs.hpp>
+#include <librealsense2/hpp/rs_internal.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+// Micro-Benchmark of Per-Frame Kernels in Samples
+// Each kernel is measured on synthetic frames (software device) at several resolutions and on recorded frames (.bag, optional).
+// Result is written in JSON, so that it can be compared across versions of librealsense and OpenCV.
+class Benchmark
+{
+private:
+    // Settings
+    uint32_t warmup = 10;
+    uint32_t repetitions = 100;
+    std::vector<cv::Size> resolutions = { cv::Size( 424, 240 ), cv::Size( 640, 480 ), cv::Size( 848, 480 ), cv::Size( 1280, 720 ) };
+    uint32_t synthetic_frames = 4;
+    uint32_t recorded_frames = 30;
+
+    // File
+    std::string file_name; // Recorded File (.bag), Empty is Synthetic Only
+    std::string output_file_name = "benchmark.json";
+
+    // Frames of Source
+    struct source
+    {
+        std::string name;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        rs2::device device;
+        std::vector<std::vector<uint8_t>> buffers; // Pixels of Synthetic Frames (Released after Framesets)
+        std::vector<rs2::frameset> framesets;
+    };
+
+    // Result of Kernel
+    struct result
+    {
+        std::string kernel;
+        std::string source;
+        uint32_t width;
+        uint32_t height;
+        std::vector<double> samples; // seconds
+    };
+    std::vector<result> results;
+
+public:
+    // Constructor
+    Benchmark( int argc, char* argv[] );
+
+    // Destructor
+    ~Benchmark();
+
+    // Processing
+    void run();
+
+private:
+    // Initialize
+    void initialize( int argc, char* argv[] );
+
+    // Parse Arguments
+    inline void parseArguments( int argc, char* argv[] );
+
+    // Finalize
+    void finalize();
+
+    // Create Synthetic Source
+    inline source createSynthetic( const uint32_t width, const uint32_t height );
+
+    // Load Recorded Source
+    inline source loadRecorded();
+
+    // Benchmark All Kernels on Source
+    void benchmark( const source& source );
+
+    // Benchmark Depth Scaling (showDepth)
+    inline void benchmarkShowDepth( const source& source );
+
+    // Benchmark Texture Mapping of Point Cloud (drawPointCloud)
+    inline void benchmarkPointCloudTexture( const source& source );
+
+    // Benchmark Post-Processing Filters (applyFilters)
+    inline void benchmarkApplyFilters( const source& source );
+
+    // Benchmark Alignment (rs2::align)
+    inline void benchmarkAlign( const source& source );
+
+    // Benchmark Disparity Transform (rs2::disparity_transform)
+    inline void benchmarkDisparity( const source& source );
+
+    // Measure Kernel (Argument of Kernel Function is Index of Frameset)
+    inline void measure( const std::string& kernel, const source& source, const std::function<void( const size_t )>& function );
+
+    // Report Result
+    void report();
+
+    // Convert Result to JSON
+    inline std::string json();
+};
+
+#endif // __BENCHMARK__
@@ -0,0 +1,16 @@
+#include <iostream>
+#include <sstream>
+
+#include "benchmark.h"
+
+int main( int argc, char* argv[] )
+{
+    try{
+        Benchmark benchmark( argc, argv );
+        benchmark.run();
+    } catch( std::exception& ex ){
+        std::cout << ex.what() << std::endl;
+    }
+
+    return 0;
+}
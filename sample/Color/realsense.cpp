@@ -45,6 +45,13 @@ void RealSense::initialize()
 
     // Initialize Sensor
     initializeSensor();
+
+    // Initialize Color Conversion
+    // e.g. Half Resolution Grayscale of Center Region
+    //color_options.roi = cv::Rect( color_width / 4, color_height / 4, color_width / 2, color_height / 2 );
+    //color_options.scale = 2;
+    //color_options.gray = true;
+    color_options.uyvy = ( color_format == rs2_format::RS2_FORMAT_UYVY );
 }
 
 // Initialize Sensor
@@ -52,10 +59,22 @@ inline void RealSense::initializeSensor()
 {
     // Set Device Config
     rs2::config config;
-    config.enable_stream( rs2_stream::RS2_STREAM_COLOR, color_width, color_height, rs2_format::RS2_FORMAT_BGR8, color_fps );
+    config.enable_stream( rs2_stream::RS2_STREAM_COLOR, color_width, color_height, color_format, color_fps );
+
+#ifdef SYNTHETIC
+    // Use Synthetic Device instead of Live Device
+    synthetic.add_to( context );
+    pipeline = rs2::pipeline( context );
+    config.enable_device( synthetic.serial() );
+#endif
 
     // Start Pipeline
     pipeline_profile = pipeline.start( config );
+
+#ifdef SYNTHETIC
+    // Start Generating Frames of Synthetic Device
+    synthetic.start( pipeline_profile );
+#endif
 }
 
 // Finalize
@@ -64,6 +83,11 @@ void RealSense::finalize()
     // Close Windows
     cv::destroyAllWindows();
 
+#ifdef SYNTHETIC
+    // Stop Generating Frames of Synthetic Device before Pipeline
+    synthetic.stop();
+#endif
+
     // Stop Pipline
     pipeline.stop();
 }
@@ -106,6 +130,13 @@ void RealSense::draw()
 // Draw Color
 inline void RealSense::drawColor()
 {
+    // Convert YUYV/UYVY Color Frame to cv::Mat (Buffer is Reused)
+    if( color_format == rs2_format::RS2_FORMAT_YUYV || color_format == rs2_format::RS2_FORMAT_UYVY ){
+        const int32_t color_stride = color_frame.as<rs2::video_frame>().get_stride_in_bytes();
+        yuyv::convert( static_cast<const uint8_t*>( color_frame.get_data() ), color_width, color_height, color_stride, color_options, color_mat );
+        return;
+    }
+
     // Create cv::Mat form Color Frame
     color_mat = cv::Mat( color_height, color_width, CV_8UC3, const_cast<void*>( color_frame.get_data() ) );
 }
@@ -4,9 +4,21 @@
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
 
+#ifdef SYNTHETIC
+#include "synthetic_device.h"
+#endif
+
+#include "yuyv.h"
+
 class RealSense
 {
 private:
+#ifdef SYNTHETIC
+    // Synthetic Device
+    rs2::context context;
+    synthetic_device synthetic;
+#endif
+
     // RealSense
     rs2::pipeline pipeline;
     rs2::pipeline_profile pipeline_profile;
@@ -18,6 +30,10 @@ private:
     uint32_t color_width = 640;
     uint32_t color_height = 480;
     uint32_t color_fps = 30;
+    rs2_format color_format = rs2_format::RS2_FORMAT_YUYV; // RS2_FORMAT_BGR8 is converted by SDK
+
+    // Color Conversion (YUYV/UYVY)
+    yuyv::options color_options;
 
 public:
     // Constructor
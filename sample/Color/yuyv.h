@@ -0,0 +1,195 @@
+// This is minimum implementation of YUYV/UYVY color conversion.
+// Conversion is vectorized with SSE2 (when available) and parallelized over rows with OpenMP.
+// Crop (ROI), downscaling (integer factor) and grayscale extraction are fused into conversion, so that full resolution BGR image is never created.
+// Coefficients are ITU-R BT.601 (limited range), same as cv::COLOR_YUV2BGR_YUYV.
+
+#ifndef __YUYV__
+#define __YUYV__
+
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define YUYV_SSE2
+#endif
+
+namespace yuyv
+{
+    // Conversion Options
+    struct options
+    {
+        bool uyvy = false;        // source byte order is U Y V Y (default is Y U Y V)
+        cv::Rect roi;             // region of source image (empty is whole image, x is aligned to even)
+        int32_t scale = 1;        // downscaling factor (1 is no scaling)
+        bool gray = false;        // extract luma only (CV_8UC1), otherwise BGR (CV_8UC3)
+    };
+
+    inline uint8_t saturate( const int32_t value )
+    {
+        return static_cast<uint8_t>( std::min( std::max( value, 0 ), 255 ) );
+    }
+
+    // Convert One Pixel (Fixed Point, 8bit Fraction)
+    inline void pixel( const int32_t y, const int32_t u, const int32_t v, uint8_t* bgr )
+    {
+        const int32_t c = 298 * ( y - 16 ) + 128;
+        const int32_t d = u - 128;
+        const int32_t e = v - 128;
+        bgr[0] = saturate( ( c + 516 * d ) >> 8 );
+        bgr[1] = saturate( ( c - 100 * d - 208 * e ) >> 8 );
+        bgr[2] = saturate( ( c + 409 * e ) >> 8 );
+    }
+
+#ifdef YUYV_SSE2
+    // Convert Channel of 8 Pixels (Same Fixed Point as pixel(), Products are 32bit by madd)
+    // luma : ( y - 16, 1 ) pairs, chroma : ( u - 128, v - 128 ) pairs, coefficient : ( d, e ) pairs of channel
+    inline __m128i channel8( const __m128i luma_lo, const __m128i luma_hi, const __m128i chroma_lo, const __m128i chroma_hi, const __m128i coefficient )
+    {
+        const __m128i lo = _mm_srai_epi32( _mm_add_epi32( luma_lo, _mm_madd_epi16( chroma_lo, coefficient ) ), 8 );
+        const __m128i hi = _mm_srai_epi32( _mm_add_epi32( luma_hi, _mm_madd_epi16( chroma_hi, coefficient ) ), 8 );
+        return _mm_packs_epi32( lo, hi );
+    }
+
+    // Convert 8 Pixels (16 Bytes) of Row to BGR
+    inline void pixels8( const uint8_t* source, uint8_t* bgr, const bool uyvy )
+    {
+        const __m128i packed = _mm_loadu_si128( reinterpret_cast<const __m128i*>( source ) );
+        const __m128i mask = _mm_set1_epi16( 0x00ff );
+
+        // Deinterleave Y and UV into 16bit Lanes
+        const __m128i y = uyvy ? _mm_srli_epi16( packed, 8 ) : _mm_and_si128( packed, mask );
+        const __m128i uv = uyvy ? _mm_and_si128( packed, mask ) : _mm_srli_epi16( packed, 8 );
+
+        // Duplicate U and V for Pair of Pixels (U0 U0 U1 U1 ..., V0 V0 V1 V1 ...)
+        const __m128i u = _mm_shufflehi_epi16( _mm_shufflelo_epi16( uv, _MM_SHUFFLE( 2, 2, 0, 0 ) ), _MM_SHUFFLE( 2, 2, 0, 0 ) );
+        const __m128i v = _mm_shufflehi_epi16( _mm_shufflelo_epi16( uv, _MM_SHUFFLE( 3, 3, 1, 1 ) ), _MM_SHUFFLE( 3, 3, 1, 1 ) );
+
+        // 298 * ( y - 16 ) + 128 (Rounding Term is Multiplied with 1)
+        const __m128i c = _mm_sub_epi16( y, _mm_set1_epi16( 16 ) );
+        const __m128i one = _mm_set1_epi16( 1 );
+        const __m128i luma_coefficient = _mm_set_epi16( 128, 298, 128, 298, 128, 298, 128, 298 );
+        const __m128i luma_lo = _mm_madd_epi16( _mm_unpacklo_epi16( c, one ), luma_coefficient );
+        const __m128i luma_hi = _mm_madd_epi16( _mm_unpackhi_epi16( c, one ), luma_coefficient );
+
+        // ( u - 128, v - 128 ) Pairs
+        const __m128i d = _mm_sub_epi16( u, _mm_set1_epi16( 128 ) );
+        const __m128i e = _mm_sub_epi16( v, _mm_set1_epi16( 128 ) );
+        const __m128i chroma_lo = _mm_unpacklo_epi16( d, e );
+        const __m128i chroma_hi = _mm_unpackhi_epi16( d, e );
+
+        const __m128i b = channel8( luma_lo, luma_hi, chroma_lo, chroma_hi, _mm_set_epi16( 0, 516, 0, 516, 0, 516, 0, 516 ) );
+        const __m128i g = channel8( luma_lo, luma_hi, chroma_lo, chroma_hi, _mm_set_epi16( -208, -100, -208, -100, -208, -100, -208, -100 ) );
+        const __m128i r = channel8( luma_lo, luma_hi, chroma_lo, chroma_hi, _mm_set_epi16( 409, 0, 409, 0, 409, 0, 409, 0 ) );
+
+        // Saturate to 8bit and Interleave BGR
+        alignas( 16 ) uint8_t lanes[3][16];
+        _mm_store_si128( reinterpret_cast<__m128i*>( lanes[0] ), _mm_packus_epi16( b, b ) );
+        _mm_store_si128( reinterpret_cast<__m128i*>( lanes[1] ), _mm_packus_epi16( g, g ) );
+        _mm_store_si128( reinterpret_cast<__m128i*>( lanes[2] ), _mm_packus_epi16( r, r ) );
+        for( int32_t i = 0; i < 8; i++ ){
+            bgr[i * 3 + 0] = lanes[0][i];
+            bgr[i * 3 + 1] = lanes[1][i];
+            bgr[i * 3 + 2] = lanes[2][i];
+        }
+    }
+
+    // Extract 16 Luma (32 Bytes) of Row
+    inline void luma16( const uint8_t* source, uint8_t* gray, const bool uyvy )
+    {
+        const __m128i packed0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( source ) );
+        const __m128i packed1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( source + 16 ) );
+        const __m128i mask = _mm_set1_epi16( 0x00ff );
+        const __m128i y0 = uyvy ? _mm_srli_epi16( packed0, 8 ) : _mm_and_si128( packed0, mask );
+        const __m128i y1 = uyvy ? _mm_srli_epi16( packed1, 8 ) : _mm_and_si128( packed1, mask );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( gray ), _mm_packus_epi16( y0, y1 ) );
+    }
+#endif
+
+    // Convert Row without Scaling
+    inline void row( const uint8_t* source, const int32_t width, uint8_t* destination, const options& option )
+    {
+        const int32_t y_offset = option.uyvy ? 1 : 0;
+        const int32_t u_offset = option.uyvy ? 0 : 1;
+        const int32_t v_offset = option.uyvy ? 2 : 3;
+        int32_t x = 0;
+
+        if( option.gray ){
+#ifdef YUYV_SSE2
+            for( ; x + 16 <= width; x += 16 ){
+                luma16( source + x * 2, destination + x, option.uyvy );
+            }
+#endif
+            for( ; x < width; x++ ){
+                destination[x] = source[x * 2 + y_offset];
+            }
+            return;
+        }
+
+#ifdef YUYV_SSE2
+        for( ; x + 8 <= width; x += 8 ){
+            pixels8( source + x * 2, destination + x * 3, option.uyvy );
+        }
+#endif
+        for( ; x < width; x++ ){
+            const uint8_t* pair = source + ( x & ~1 ) * 2;
+            pixel( source[x * 2 + y_offset], pair[u_offset], pair[v_offset], destination + x * 3 );
+        }
+    }
+
+    // Convert Row with Downscaling (Nearest Neighbor)
+    inline void row_scaled( const uint8_t* source, const int32_t width, uint8_t* destination, const options& option )
+    {
+        const int32_t y_offset = option.uyvy ? 1 : 0;
+        const int32_t u_offset = option.uyvy ? 0 : 1;
+        const int32_t v_offset = option.uyvy ? 2 : 3;
+
+        for( int32_t x = 0; x < width; x++ ){
+            const int32_t source_x = x * option.scale;
+            const uint8_t* pair = source + ( source_x & ~1 ) * 2;
+            if( option.gray ){
+                destination[x] = source[source_x * 2 + y_offset];
+            }
+            else{
+                pixel( source[source_x * 2 + y_offset], pair[u_offset], pair[v_offset], destination + x * 3 );
+            }
+        }
+    }
+
+    // Convert YUYV/UYVY Image to BGR (CV_8UC3) or Gray (CV_8UC1)
+    // Destination is reused when its size and type are unchanged.
+    inline void convert( const uint8_t* source, const int32_t width, const int32_t height, const int32_t stride, const options& option, cv::Mat& destination )
+    {
+        CV_Assert( option.scale >= 1 );
+
+        // Crop Region (X is Aligned to Even to Keep Pair of Pixels)
+        cv::Rect roi = option.roi.area() ? option.roi : cv::Rect( 0, 0, width, height );
+        roi.x &= ~1;
+        roi.width = std::min( roi.width, width - roi.x );
+        roi.height = std::min( roi.height, height - roi.y );
+        CV_Assert( roi.x >= 0 && roi.y >= 0 && roi.width > 0 && roi.height > 0 );
+
+        const int32_t destination_width = roi.width / option.scale;
+        const int32_t destination_height = roi.height / option.scale;
+        destination.create( destination_height, destination_width, option.gray ? CV_8UC1 : CV_8UC3 );
+
+        #pragma omp parallel for
+        for( int32_t y = 0; y < destination_height; y++ ){
+            const uint8_t* source_row = source + static_cast<size_t>( roi.y + y * option.scale ) * stride + roi.x * 2;
+            uint8_t* destination_row = destination.ptr<uint8_t>( y );
+            if( option.scale == 1 ){
+                row( source_row, destination_width, destination_row, option );
+            }
+            else{
+                row_scaled( source_row, destination_width, destination_row, option );
+            }
+        }
+    }
+}
+
+#endif // __YUYV__
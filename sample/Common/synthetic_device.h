@@ -0,0 +1,534 @@
+// This is minimum implementation of synthetic device for testing samples without camera.
+// Synthetic device is software device (rs2::software_device) that registers catalog of stream profiles similar to D400/T265 series.
+// Depth, infrared, color, gyro, accel and pose frames are generated in background thread, only for streams that pipeline opened.
+// Frames have intrinsics calculated from field of view, extrinsics between streams, and timestamps at nominal frame rate.
+//
+// Usage:
+//   synthetic_device synthetic;
+//   synthetic.add_to( context );
+//   rs2::pipeline pipeline( context );
+//   config.enable_device( synthetic.serial() );
+//   rs2::pipeline_profile pipeline_profile = pipeline.start( config );
+//   synthetic.start( pipeline_profile );
+
+#ifndef __SYNTHETIC_DEVICE__
+#define __SYNTHETIC_DEVICE__
+
+#include <librealsense2/rs.hpp>
+#include <librealsense2/hpp/rs_internal.hpp>
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace synthetic
+{
+    // Content Pattern
+    enum class pattern
+    {
+        scene, // room with wall, floor and moving sphere (ray-cast with intrinsics)
+        ramp,  // scrolling ramp
+        noise  // random values (worst case for filters and compression)
+    };
+
+    struct resolution
+    {
+        int32_t width;
+        int32_t height;
+    };
+
+    // Options of Synthetic Device
+    // Every combination of resolution, frame rate and format is registered as stream profile.
+    struct options
+    {
+        // Sensors
+        bool depth = true;  // depth (Z16) and infrared (Y8, left and right)
+        bool color = true;  // color
+        bool motion = true; // gyro and accel (MOTION_XYZ32F)
+        bool pose = true;   // pose (6DOF)
+
+        // Stream Profiles
+        std::vector<resolution> depth_resolutions = { { 424, 240 }, { 480, 270 }, { 640, 360 }, { 640, 480 }, { 848, 480 }, { 1280, 720 } };
+        std::vector<int32_t> depth_fps = { 6, 15, 30, 60, 90 };
+        std::vector<resolution> color_resolutions = { { 320, 180 }, { 320, 240 }, { 424, 240 }, { 640, 360 }, { 640, 480 }, { 848, 480 }, { 960, 540 }, { 1280, 720 }, { 1920, 1080 } };
+        std::vector<int32_t> color_fps = { 6, 15, 30, 60 };
+        std::vector<rs2_format> color_formats = { RS2_FORMAT_BGR8, RS2_FORMAT_RGB8, RS2_FORMAT_BGRA8, RS2_FORMAT_RGBA8, RS2_FORMAT_YUYV, RS2_FORMAT_UYVY, RS2_FORMAT_Y8 };
+        std::vector<int32_t> gyro_fps = { 200, 400 };
+        std::vector<int32_t> accel_fps = { 63, 250 };
+        int32_t pose_fps = 200;
+        float depth_units = 0.001f;
+
+        // Content
+        pattern content = pattern::scene;
+
+        // Pace frames at frame rate (false pushes frames as fast as possible for stress test)
+        bool real_time = true;
+    };
+
+    // Stream Profile Registered to Software Sensor
+    // Stream (Constructed with Sensor because Software Sensor is not Default Constructible)
+    struct stream
+    {
+        rs2::software_sensor sensor;
+        rs2::stream_profile profile;
+        rs2_stream type = RS2_STREAM_ANY;
+        int32_t index = 0;
+        int32_t fps = 0;
+        rs2_format format = RS2_FORMAT_ANY;
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t bpp = 0;
+        rs2_intrinsics intrinsics = {};
+
+        explicit stream( const rs2::software_sensor& sensor )
+            : sensor( sensor )
+        {
+        }
+    };
+
+    // Intrinsics from Field of View (Degree)
+    inline rs2_intrinsics intrinsics( const int32_t width, const int32_t height, const float horizontal_fov, const float vertical_fov, const rs2_distortion model )
+    {
+        constexpr float pi = 3.14159265358979f;
+        rs2_intrinsics intrinsics = {};
+        intrinsics.width = width;
+        intrinsics.height = height;
+        intrinsics.ppx = width * 0.5f;
+        intrinsics.ppy = height * 0.5f;
+        intrinsics.fx = width * 0.5f / std::tan( horizontal_fov * pi / 360.0f );
+        intrinsics.fy = height * 0.5f / std::tan( vertical_fov * pi / 360.0f );
+        intrinsics.model = model;
+        return intrinsics;
+    }
+
+    // Bytes per Pixel of Format
+    inline int32_t bytes_per_pixel( const rs2_format format )
+    {
+        switch( format ){
+            case RS2_FORMAT_Z16:
+            case RS2_FORMAT_YUYV:
+            case RS2_FORMAT_UYVY:
+                return 2;
+            case RS2_FORMAT_RGB8:
+            case RS2_FORMAT_BGR8:
+                return 3;
+            case RS2_FORMAT_RGBA8:
+            case RS2_FORMAT_BGRA8:
+                return 4;
+            default:
+                return 1;
+        }
+    }
+
+    // Position of Stream on Device in Meters (Origin is Depth = Left Imager)
+    inline float position( const rs2_stream type, const int32_t index )
+    {
+        switch( type ){
+            case RS2_STREAM_COLOR:
+                return 0.015f;
+            case RS2_STREAM_INFRARED:
+                return index == 2 ? 0.050f : 0.0f;
+            default:
+                return 0.0f;
+        }
+    }
+
+    // Hash of Pixel (Speckle and Noise)
+    inline uint32_t hash( uint32_t value )
+    {
+        value ^= value >> 16;
+        value *= 0x7feb352d;
+        value ^= value >> 15;
+        value *= 0x846ca68b;
+        value ^= value >> 16;
+        return value;
+    }
+
+    // Ray-Cast Scene (Room of 3m Depth with Floor at 0.8m below Camera and Sphere at Center X)
+    // Ray is ( dx, dy, 1 ) in camera coordinates. Returns distance along Z in meters and shade (0-255).
+    inline float raycast( const float dx, const float dy, const float cx, uint8_t& shade )
+    {
+        // Wall (Z = 3.0) with Checker Pattern
+        float depth = 3.0f;
+        const int32_t checker = ( static_cast<int32_t>( std::floor( dx * depth * 4.0f ) ) + static_cast<int32_t>( std::floor( dy * depth * 4.0f ) ) ) & 1;
+        shade = checker ? 200 : 120;
+
+        // Floor (Y = 0.8)
+        if( dy > 0.0f ){
+            const float floor = 0.8f / dy;
+            if( floor < depth ){
+                depth = floor;
+                shade = 90;
+            }
+        }
+
+        // Sphere
+        const float cy = 0.2f;
+        const float cz = 1.6f;
+        const float radius = 0.35f;
+        const float a = dx * dx + dy * dy + 1.0f;
+        const float b = dx * cx + dy * cy + cz;
+        const float c = cx * cx + cy * cy + cz * cz - radius * radius;
+        const float discriminant = b * b - a * c;
+        if( discriminant > 0.0f ){
+            const float t = ( b - std::sqrt( discriminant ) ) / a;
+            if( 0.0f < t && t < depth ){
+                depth = t;
+                const float nz = ( cz - t ) / radius; // normal toward camera
+                shade = static_cast<uint8_t>( 60.0f + 195.0f * std::max( 0.0f, std::min( 1.0f, nz ) ) );
+            }
+        }
+
+        return depth;
+    }
+}
+
+// Synthetic Device
+class synthetic_device
+{
+private:
+    std::string serial_number;
+    synthetic::options options;
+    rs2::software_device device;
+    std::vector<synthetic::stream> streams;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::chrono::steady_clock::time_point epoch;
+
+public:
+    synthetic_device( const std::string& serial_number = "SYNTHETIC-0000", const synthetic::options& options = synthetic::options() )
+        : serial_number( serial_number )
+        , options( options )
+        , running( false )
+        , epoch( std::chrono::steady_clock::now() )
+    {
+        initialize();
+    }
+
+    ~synthetic_device()
+    {
+        stop();
+    }
+
+    synthetic_device( const synthetic_device& ) = delete;
+    synthetic_device& operator=( const synthetic_device& ) = delete;
+
+    // Serial Number (for rs2::config::enable_device())
+    const std::string& serial() const
+    {
+        return serial_number;
+    }
+
+    // Add Device to Context (Pipeline Created from Context can Resolve Device)
+    void add_to( rs2::context& context )
+    {
+        device.add_to( context );
+    }
+
+    // Start Generating Frames of Streams that Pipeline Opened
+    void start( const rs2::pipeline_profile& pipeline_profile )
+    {
+        stop();
+
+        // Find Registered Streams of Active Profiles
+        std::vector<synthetic::stream> active;
+        for( const rs2::stream_profile& profile : pipeline_profile.get_streams() ){
+            for( const synthetic::stream& stream : streams ){
+                if( stream.profile.unique_id() == profile.unique_id() ){
+                    active.push_back( stream );
+                }
+            }
+        }
+
+        // Register Extrinsics between Active Streams
+        for( synthetic::stream& from : active ){
+            for( const synthetic::stream& to : active ){
+                if( from.profile.unique_id() == to.profile.unique_id() ){
+                    continue;
+                }
+                const rs2_extrinsics extrinsics = { { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { synthetic::position( from.type, from.index ) - synthetic::position( to.type, to.index ), 0.0f, 0.0f } };
+                from.profile.register_extrinsics_to( to.profile, extrinsics );
+            }
+        }
+
+        running = true;
+        thread = std::thread( &synthetic_device::generate, this, active );
+    }
+
+    // Stop Generating Frames
+    void stop()
+    {
+        running = false;
+        if( thread.joinable() ){
+            thread.join();
+        }
+    }
+
+private:
+    // Register Sensors and Stream Profiles
+    void initialize()
+    {
+        device.register_info( RS2_CAMERA_INFO_NAME, "Synthetic Device" );
+        device.register_info( RS2_CAMERA_INFO_SERIAL_NUMBER, serial_number );
+        int32_t uid = 0;
+
+        // Depth Sensor (Depth and Infrared)
+        if( options.depth ){
+            rs2::software_sensor sensor = device.add_sensor( "Stereo Module" );
+            sensor.add_read_only_option( RS2_OPTION_DEPTH_UNITS, options.depth_units );
+            for( const synthetic::resolution& resolution : options.depth_resolutions ){
+                for( const int32_t fps : options.depth_fps ){
+                    const bool is_default = resolution.width == 640 && resolution.height == 480 && fps == 30;
+                    const rs2_intrinsics intrinsics = synthetic::intrinsics( resolution.width, resolution.height, 87.0f, 58.0f, RS2_DISTORTION_BROWN_CONRADY );
+                    addVideoStream( sensor, RS2_STREAM_DEPTH, 0, uid++, fps, RS2_FORMAT_Z16, intrinsics, is_default );
+                    addVideoStream( sensor, RS2_STREAM_INFRARED, 1, uid++, fps, RS2_FORMAT_Y8, intrinsics, is_default );
+                    addVideoStream( sensor, RS2_STREAM_INFRARED, 2, uid++, fps, RS2_FORMAT_Y8, intrinsics, false );
+                }
+            }
+        }
+
+        // Color Sensor
+        if( options.color ){
+            rs2::software_sensor sensor = device.add_sensor( "RGB Camera" );
+            for( const synthetic::resolution& resolution : options.color_resolutions ){
+                for( const int32_t fps : options.color_fps ){
+                    for( const rs2_format format : options.color_formats ){
+                        const bool is_default = resolution.width == 640 && resolution.height == 480 && fps == 30 && format == RS2_FORMAT_RGB8;
+                        const rs2_intrinsics intrinsics = synthetic::intrinsics( resolution.width, resolution.height, 69.0f, 42.0f, RS2_DISTORTION_INVERSE_BROWN_CONRADY );
+                        addVideoStream( sensor, RS2_STREAM_COLOR, 0, uid++, fps, format, intrinsics, is_default );
+                    }
+                }
+            }
+        }
+
+        // Motion Sensor (Gyro and Accel)
+        if( options.motion ){
+            rs2::software_sensor sensor = device.add_sensor( "Motion Module" );
+            for( const int32_t fps : options.gyro_fps ){
+                addMotionStream( sensor, RS2_STREAM_GYRO, uid++, fps, fps == options.gyro_fps.front() );
+            }
+            for( const int32_t fps : options.accel_fps ){
+                addMotionStream( sensor, RS2_STREAM_ACCEL, uid++, fps, fps == options.accel_fps.front() );
+            }
+        }
+
+        // Pose Sensor
+        if( options.pose ){
+            rs2::software_sensor sensor = device.add_sensor( "Tracking Module" );
+            synthetic::stream stream( sensor );
+            stream.type = RS2_STREAM_POSE;
+            stream.fps = options.pose_fps;
+            stream.format = RS2_FORMAT_6DOF;
+            stream.profile = sensor.add_pose_stream( { RS2_STREAM_POSE, 0, uid++, options.pose_fps, RS2_FORMAT_6DOF }, true );
+            streams.push_back( stream );
+        }
+
+        // Synchronize Depth, Infrared and Color
+        device.create_matcher( RS2_MATCHER_DLR_C );
+    }
+
+    void addVideoStream( rs2::software_sensor& sensor, const rs2_stream type, const int32_t index, const int32_t uid, const int32_t fps, const rs2_format format, const rs2_intrinsics& intrinsics, const bool is_default )
+    {
+        synthetic::stream stream( sensor );
+        stream.type = type;
+        stream.index = index;
+        stream.fps = fps;
+        stream.format = format;
+        stream.width = intrinsics.width;
+        stream.height = intrinsics.height;
+        stream.bpp = synthetic::bytes_per_pixel( format );
+        stream.intrinsics = intrinsics;
+        stream.profile = sensor.add_video_stream( { type, index, uid, intrinsics.width, intrinsics.height, fps, stream.bpp, format, intrinsics }, is_default );
+        streams.push_back( stream );
+    }
+
+    void addMotionStream( rs2::software_sensor& sensor, const rs2_stream type, const int32_t uid, const int32_t fps, const bool is_default )
+    {
+        synthetic::stream stream( sensor );
+        stream.type = type;
+        stream.fps = fps;
+        stream.format = RS2_FORMAT_MOTION_XYZ32F;
+        stream.profile = sensor.add_motion_stream( { type, 0, uid, fps, RS2_FORMAT_MOTION_XYZ32F }, is_default );
+        streams.push_back( stream );
+    }
+
+    // Generate Frames at Nominal Frame Rate of Each Stream
+    void generate( std::vector<synthetic::stream> active )
+    {
+        if( active.empty() ){
+            return;
+        }
+
+        // Timestamps Continue from Previous Start (Seconds from Creation of Device)
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const double offset = std::chrono::duration<double>( start - epoch ).count();
+        std::vector<int32_t> frame_numbers( active.size(), 0 );
+        std::vector<double> due_times( active.size(), 0.0 ); // seconds from start
+
+        while( running ){
+            // Stream with Earliest Due Time
+            const size_t index = std::min_element( due_times.begin(), due_times.end() ) - due_times.begin();
+            const double time = due_times[index];
+            if( options.real_time ){
+                std::this_thread::sleep_until( start + std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( time ) ) );
+            }
+
+            // Push Frame (Timestamp is Nominal Time)
+            synthetic::stream& stream = active[index];
+            const int32_t frame_number = frame_numbers[index]++;
+            switch( stream.type ){
+                case RS2_STREAM_GYRO:
+                case RS2_STREAM_ACCEL:
+                    pushMotionFrame( stream, frame_number, offset + time );
+                    break;
+                case RS2_STREAM_POSE:
+                    pushPoseFrame( stream, frame_number, offset + time );
+                    break;
+                default:
+                    pushVideoFrame( stream, frame_number, offset + time );
+                    break;
+            }
+            due_times[index] = ( frame_number + 1 ) / static_cast<double>( stream.fps );
+        }
+    }
+
+    // Push Video Frame (Depth, Infrared, Color)
+    void pushVideoFrame( synthetic::stream& stream, const int32_t frame_number, const double time )
+    {
+        const int32_t stride = stream.width * stream.bpp;
+        uint8_t* pixels = new uint8_t[static_cast<size_t>( stride ) * stream.height];
+        const float t = static_cast<float>( time );
+        const float sphere_x = 0.6f * std::sin( t * 0.8f ); // sphere moves left and right
+        const uint32_t seed = synthetic::hash( static_cast<uint32_t>( frame_number ) * 0x9e3779b9u + stream.type );
+
+        for( int32_t y = 0; y < stream.height; y++ ){
+            uint8_t* row = pixels + static_cast<size_t>( y ) * stride;
+            const float dy = ( y - stream.intrinsics.ppy ) / stream.intrinsics.fy;
+            for( int32_t x = 0; x < stream.width; x++ ){
+                const float dx = ( x - stream.intrinsics.ppx ) / stream.intrinsics.fx;
+                const uint32_t random = synthetic::hash( seed ^ static_cast<uint32_t>( y * stream.width + x ) );
+
+                // Depth (Meters) and Shade
+                float depth = 0.0f;
+                uint8_t shade = 0;
+                switch( options.content ){
+                    case synthetic::pattern::scene:
+                        depth = synthetic::raycast( dx, dy, sphere_x, shade );
+                        break;
+                    case synthetic::pattern::ramp:{
+                        const int32_t offset = ( x + static_cast<int32_t>( t * 100.0f ) ) % stream.width;
+                        depth = 0.5f + 4.5f * offset / stream.width;
+                        shade = static_cast<uint8_t>( offset * 255 / stream.width );
+                        break;
+                    }
+                    case synthetic::pattern::noise:
+                        depth = 0.3f + ( random & 0xffff ) * ( 9.7f / 65535.0f );
+                        shade = static_cast<uint8_t>( random >> 24 );
+                        break;
+                }
+
+                switch( stream.type ){
+                    case RS2_STREAM_DEPTH:{
+                        // Invalid Band at Left (Stereo Occlusion) and Sparse Holes
+                        const bool hole = ( x < stream.width / 20 ) || ( ( random >> 24 ) < 3 );
+                        const uint16_t value = hole ? 0 : static_cast<uint16_t>( std::min( depth / options.depth_units + ( random & 0x3 ), 65535.0f ) );
+                        std::memcpy( row + x * 2, &value, sizeof( value ) );
+                        break;
+                    }
+                    case RS2_STREAM_INFRARED:
+                        // Projector Speckle on Shade
+                        row[x] = static_cast<uint8_t>( std::min( 255, shade / 2 + ( ( synthetic::hash( static_cast<uint32_t>( y * 7919 + x ) ) & 0x1f ) == 0 ? 120 : 0 ) ) );
+                        break;
+                    default:{
+                        // Color (Tinted by Region)
+                        const uint8_t b = static_cast<uint8_t>( shade * ( depth < 2.0f ? 0.3f : 1.0f ) );
+                        const uint8_t g = static_cast<uint8_t>( shade * ( depth < 2.0f ? 0.4f : 0.9f ) );
+                        const uint8_t r = shade;
+                        writeColor( row, x, stream.format, b, g, r );
+                        break;
+                    }
+                }
+            }
+        }
+
+        // Time of Arrival is Host Clock (milliseconds) as Live Device
+        stream.sensor.set_metadata( RS2_FRAME_METADATA_TIME_OF_ARRIVAL, std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count() );
+        stream.sensor.on_video_frame( { pixels, []( void* pixels ){ delete[] static_cast<uint8_t*>( pixels ); }, stride, stream.bpp, time * 1000.0, RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, frame_number, stream.profile.get() } );
+    }
+
+    // Write Color Pixel in Format
+    static void writeColor( uint8_t* row, const int32_t x, const rs2_format format, const uint8_t b, const uint8_t g, const uint8_t r )
+    {
+        switch( format ){
+            case RS2_FORMAT_BGR8:
+                row[x * 3 + 0] = b; row[x * 3 + 1] = g; row[x * 3 + 2] = r;
+                break;
+            case RS2_FORMAT_RGB8:
+                row[x * 3 + 0] = r; row[x * 3 + 1] = g; row[x * 3 + 2] = b;
+                break;
+            case RS2_FORMAT_BGRA8:
+                row[x * 4 + 0] = b; row[x * 4 + 1] = g; row[x * 4 + 2] = r; row[x * 4 + 3] = 255;
+                break;
+            case RS2_FORMAT_RGBA8:
+                row[x * 4 + 0] = r; row[x * 4 + 1] = g; row[x * 4 + 2] = b; row[x * 4 + 3] = 255;
+                break;
+            case RS2_FORMAT_YUYV:
+            case RS2_FORMAT_UYVY:{
+                // ITU-R BT.601 (Limited Range), Chroma of Even Pixel is Shared with Odd Pixel
+                const int32_t luma = ( ( 66 * r + 129 * g + 25 * b + 128 ) >> 8 ) + 16;
+                const int32_t chroma = ( x & 1 ) ? ( ( ( 112 * r - 94 * g - 18 * b + 128 ) >> 8 ) + 128 ) : ( ( ( -38 * r - 74 * g + 112 * b + 128 ) >> 8 ) + 128 );
+                const bool uyvy = format == RS2_FORMAT_UYVY;
+                row[x * 2 + ( uyvy ? 1 : 0 )] = static_cast<uint8_t>( luma );
+                row[x * 2 + ( uyvy ? 0 : 1 )] = static_cast<uint8_t>( chroma );
+                break;
+            }
+            default:
+                row[x] = static_cast<uint8_t>( ( 77 * r + 150 * g + 29 * b ) >> 8 );
+                break;
+        }
+    }
+
+    // Push Motion Frame (Gyro is Rotation of Pose, Accel is Gravity)
+    void pushMotionFrame( synthetic::stream& stream, const int32_t frame_number, const double time )
+    {
+        const float noise = ( synthetic::hash( static_cast<uint32_t>( frame_number ) ^ stream.type ) & 0xff ) / 255.0f * 0.01f - 0.005f;
+        float* data = new float[3];
+        if( stream.type == RS2_STREAM_GYRO ){
+            data[0] = noise;
+            data[1] = 0.5f + noise; // rad/s
+            data[2] = noise;
+        }
+        else{
+            data[0] = noise;
+            data[1] = -9.80665f + noise; // m/s^2
+            data[2] = noise;
+        }
+
+        stream.sensor.on_motion_frame( { data, []( void* data ){ delete[] static_cast<float*>( data ); }, time * 1000.0, RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, frame_number, stream.profile.get() } );
+    }
+
+    // Push Pose Frame (Circle of 0.5m Radius at 0.5 rad/s)
+    void pushPoseFrame( synthetic::stream& stream, const int32_t frame_number, const double time )
+    {
+        const float angle = static_cast<float>( time ) * 0.5f;
+        rs2_pose* pose = new rs2_pose();
+        pose->translation = { 0.5f * std::sin( angle ), 0.0f, 0.5f * std::cos( angle ) - 0.5f };
+        pose->velocity = { 0.25f * std::cos( angle ), 0.0f, -0.25f * std::sin( angle ) };
+        pose->acceleration = { -0.125f * std::sin( angle ), 0.0f, -0.125f * std::cos( angle ) };
+        pose->rotation = { 0.0f, std::sin( angle * 0.5f ), 0.0f, std::cos( angle * 0.5f ) };
+        pose->angular_velocity = { 0.0f, 0.5f, 0.0f };
+        pose->angular_acceleration = { 0.0f, 0.0f, 0.0f };
+        pose->tracker_confidence = 3;
+        pose->mapper_confidence = 3;
+
+        stream.sensor.on_pose_frame( { pose, []( void* pose ){ delete static_cast<rs2_pose*>( pose ); }, time * 1000.0, RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, frame_number, stream.profile.get() } );
+    }
+};
+
+#endif // __SYNTHETIC_DEVICE__
@@ -0,0 +1,432 @@
+#include "export.h"
+
+#include <librealsense2/rsutil.h>
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Constructor
+Export::Export( int argc, char* argv[] )
+    : framesets( 0 )
+    , exported( 0 )
+    , skipped( 0 )
+    , written_bytes( 0 )
+{
+    // Initialize
+    initialize( argc, argv );
+}
+
+// Destructor
+Export::~Export()
+{
+    // Finalize
+    finalize();
+}
+
+// Processing
+void Export::run()
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Start Workers
+    std::vector<std::thread> threads;
+    for( uint32_t i = 0; i < workers; i++ ){
+        threads.emplace_back( &Export::process, this );
+    }
+
+    // Disable Real-Time Pacing, and Close Queue at End of File (Before Start, Same Device is Started by Pipeline)
+    rs2::config config;
+    config.enable_device_from_file( file_name, false );
+    rs2::playback playback = config.resolve( pipeline ).get_device().as<rs2::playback>();
+    playback.set_real_time( false );
+    playback.set_status_changed_callback( [this]( const rs2_playback_status status ){
+        if( status == rs2_playback_status::RS2_PLAYBACK_STATUS_STOPPED ){
+            jobs->close();
+        }
+    } );
+
+    // Start Playback with Callback that Waits while Queue is Full (Slow Encoding Throttles Reading)
+    pipeline.start( config, [this]( const rs2::frame& frame ){
+        const rs2::frameset frameset = frame.as<rs2::frameset>();
+        if( !frameset ){
+            return;
+        }
+
+        try{
+            push( frameset );
+        }
+        catch( ... ){
+            std::lock_guard<std::mutex> lock( mutex );
+            exception = std::current_exception();
+            jobs->close();
+        }
+    } );
+
+    // Wait until Workers Drained Queue
+    for( std::thread& thread : threads ){
+        thread.join();
+    }
+    pipeline.stop();
+
+    if( exception ){
+        std::rethrow_exception( exception );
+    }
+
+    elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    // Report Result
+    report();
+}
+
+// Initialize
+void Export::initialize( int argc, char* argv[] )
+{
+    cv::setUseOptimized( true );
+
+    // Parse Arguments
+    parseArguments( argc, argv );
+
+    // Create Output Directory (Existing Directory is Reused to Resume Export)
+#ifdef _WIN32
+    const int32_t result = _mkdir( output_directory.c_str() );
+#else
+    const int32_t result = mkdir( output_directory.c_str(), 0755 );
+#endif
+    if( result != 0 && errno != EEXIST ){
+        throw std::runtime_error( "failed to create " + output_directory );
+    }
+
+    // Retrieve Depth Scale of Recording
+    rs2::context context;
+    rs2::playback playback = context.load_device( file_name );
+    for( rs2::sensor& sensor : playback.query_sensors() ){
+        if( sensor.is<rs2::depth_sensor>() ){
+            depth_scale = sensor.as<rs2::depth_sensor>().get_depth_scale();
+        }
+    }
+
+    // Create Queue of Jobs
+    jobs.reset( new bounded_queue<job>( queue_size ) );
+
+    std::cout << file_name << " : export to " << output_directory << " with " << workers << " workers" << std::endl;
+}
+
+// Parse Arguments
+inline void Export::parseArguments( int argc, char* argv[] )
+{
+    const std::string usage = "usage : Export [--workers N] [--queue N] [--no-depth] [--no-color] [--no-cloud] [--png-compression 0-9] [--jpeg-quality 0-100] [--output directory] file.bag";
+    for( int32_t i = 1; i < argc; i++ ){
+        const std::string argument = argv[i];
+        const bool has_value = i + 1 < argc;
+        if( argument == "--workers" && has_value ){
+            workers = static_cast<uint32_t>( std::stoul( argv[++i] ) );
+        }
+        else if( argument == "--queue" && has_value ){
+            queue_size = static_cast<size_t>( std::stoul( argv[++i] ) );
+        }
+        else if( argument == "--no-depth" ){
+            export_depth = false;
+        }
+        else if( argument == "--no-color" ){
+            export_color = false;
+        }
+        else if( argument == "--no-cloud" ){
+            export_cloud = false;
+        }
+        else if( argument == "--png-compression" && has_value ){
+            png_compression = std::stoi( argv[++i] );
+        }
+        else if( argument == "--jpeg-quality" && has_value ){
+            jpeg_quality = std::stoi( argv[++i] );
+        }
+        else if( argument == "--output" && has_value ){
+            output_directory = argv[++i];
+        }
+        else if( !argument.empty() && argument[0] != '-' ){
+            file_name = argument;
+        }
+        else{
+            throw std::runtime_error( usage );
+        }
+    }
+
+    if( file_name.empty() || png_compression < 0 || png_compression > 9 || jpeg_quality < 0 || jpeg_quality > 100 ){
+        throw std::runtime_error( usage );
+    }
+
+    if( !workers ){
+        workers = std::max( std::thread::hardware_concurrency(), 1u );
+    }
+
+    if( !queue_size ){
+        queue_size = workers * 2;
+    }
+}
+
+// Finalize
+void Export::finalize()
+{
+    // Release Callback Waiting for Queue
+    if( jobs ){
+        jobs->close();
+    }
+}
+
+// Push Jobs of Frameset (Playback Thread)
+void Export::push( const rs2::frameset& frameset )
+{
+    const rs2::video_frame depth_frame = frameset.get_depth_frame();
+    const rs2::video_frame color_frame = frameset.get_color_frame();
+
+    // Skip Frames that were Already Exported (Resume Export)
+    std::string depth_file_name, color_file_name, cloud_file_name;
+    if( export_depth && depth_frame ){
+        depth_file_name = name( "depth", depth_frame.get_frame_number(), ".png" );
+    }
+    if( export_color && color_frame ){
+        color_file_name = name( "color", color_frame.get_frame_number(), ".jpg" );
+    }
+    if( export_cloud && depth_frame ){
+        cloud_file_name = name( "cloud", depth_frame.get_frame_number(), ".ply" );
+    }
+    for( std::string* output_file_name : { &depth_file_name, &color_file_name, &cloud_file_name } ){
+        if( !output_file_name->empty() && exists( *output_file_name ) ){
+            output_file_name->clear();
+            skipped++;
+        }
+    }
+
+    // Copy Depth (Z16)
+    cv::Mat depth_mat;
+    if( ( !depth_file_name.empty() || !cloud_file_name.empty() ) && depth_frame.get_profile().format() == rs2_format::RS2_FORMAT_Z16 ){
+        depth_mat = cv::Mat( depth_frame.get_height(), depth_frame.get_width(), CV_16UC1, const_cast<void*>( depth_frame.get_data() ), depth_frame.get_stride_in_bytes() ).clone();
+    }
+
+    // Copy Color (Convert to BGR)
+    cv::Mat color_mat;
+    if( ( !color_file_name.empty() || !cloud_file_name.empty() ) && color_frame ){
+        const rs2_format format = color_frame.get_profile().format();
+        const int32_t type = ( format == rs2_format::RS2_FORMAT_YUYV ) ? CV_8UC2 : CV_8UC3;
+        const cv::Mat mat( color_frame.get_height(), color_frame.get_width(), type, const_cast<void*>( color_frame.get_data() ), color_frame.get_stride_in_bytes() );
+        switch( format ){
+            case rs2_format::RS2_FORMAT_BGR8:
+                color_mat = mat.clone();
+                break;
+            case rs2_format::RS2_FORMAT_RGB8:
+                cv::cvtColor( mat, color_mat, cv::COLOR_RGB2BGR );
+                break;
+            case rs2_format::RS2_FORMAT_YUYV:
+                cv::cvtColor( mat, color_mat, cv::COLOR_YUV2BGR_YUYV );
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Push Jobs (Queue Waits while Full, and Returns false after Closed)
+    if( !depth_file_name.empty() && !depth_mat.empty() ){
+        job job;
+        job.kind = job::depth;
+        job.file_name = depth_file_name;
+        job.depth_mat = depth_mat;
+        if( !jobs->push( std::move( job ) ) ){
+            return;
+        }
+    }
+
+    if( !color_file_name.empty() && !color_mat.empty() ){
+        job job;
+        job.kind = job::color;
+        job.file_name = color_file_name;
+        job.color_mat = color_mat;
+        if( !jobs->push( std::move( job ) ) ){
+            return;
+        }
+    }
+
+    if( !cloud_file_name.empty() && !depth_mat.empty() ){
+        job job;
+        job.kind = job::cloud;
+        job.file_name = cloud_file_name;
+        job.depth_mat = depth_mat;
+        job.depth_intrinsics = depth_frame.get_profile().as<rs2::video_stream_profile>().get_intrinsics();
+        if( !color_mat.empty() ){
+            job.color_mat = color_mat;
+            job.color_intrinsics = color_frame.get_profile().as<rs2::video_stream_profile>().get_intrinsics();
+            job.depth_to_color = depth_frame.get_profile().get_extrinsics_to( color_frame.get_profile() );
+        }
+        if( !jobs->push( std::move( job ) ) ){
+            return;
+        }
+    }
+
+    // Report Progress Every 300 Framesets
+    if( ++framesets % 300 == 0 ){
+        std::cout << "export : " << framesets << " framesets"
+                  << ", " << exported << " files exported"
+                  << ", " << skipped << " files skipped"
+                  << ", " << jobs->size() << " jobs queued" << std::endl;
+    }
+}
+
+// Process Jobs (Worker)
+void Export::process()
+{
+    job job;
+    while( jobs->pop( job ) ){
+        try{
+            switch( job.kind ){
+                case job::depth:
+                    exportDepth( job );
+                    break;
+                case job::color:
+                    exportColor( job );
+                    break;
+                case job::cloud:
+                    exportCloud( job );
+                    break;
+            }
+            exported++;
+        }
+        catch( ... ){
+            std::lock_guard<std::mutex> lock( mutex );
+            exception = std::current_exception();
+            jobs->close();
+            return;
+        }
+    }
+}
+
+// Export Depth to 16-bit PNG
+inline void Export::exportDepth( const job& job )
+{
+    std::vector<uint8_t> buffer;
+    cv::imencode( ".png", job.depth_mat, buffer, { cv::IMWRITE_PNG_COMPRESSION, png_compression } );
+    write( job.file_name, buffer );
+}
+
+// Export Color to JPEG
+inline void Export::exportColor( const job& job )
+{
+    std::vector<uint8_t> buffer;
+    cv::imencode( ".jpg", job.color_mat, buffer, { cv::IMWRITE_JPEG_QUALITY, jpeg_quality } );
+    write( job.file_name, buffer );
+}
+
+// Export Point Cloud to Binary PLY
+inline void Export::exportCloud( const job& job )
+{
+    const bool has_color = !job.color_mat.empty();
+    const size_t vertex_size = 3 * sizeof( float ) + ( has_color ? 3 * sizeof( uint8_t ) : 0 );
+
+    // Deproject Valid Pixels to Points (and Project Points to Color to Retrieve Color of Points)
+    std::vector<uint8_t> vertices;
+    vertices.reserve( job.depth_mat.total() * vertex_size );
+    size_t num_vertices = 0;
+    for( int32_t y = 0; y < job.depth_mat.rows; y++ ){
+        const uint16_t* depth = job.depth_mat.ptr<uint16_t>( y );
+        for( int32_t x = 0; x < job.depth_mat.cols; x++ ){
+            if( depth[x] == 0 ){
+                continue;
+            }
+
+            const float pixel[2] = { static_cast<float>( x ), static_cast<float>( y ) };
+            float point[3];
+            rs2_deproject_pixel_to_point( point, &job.depth_intrinsics, pixel, depth[x] * depth_scale );
+
+            uint8_t vertex[3 * sizeof( float ) + 3 * sizeof( uint8_t )];
+            std::memcpy( vertex, point, sizeof( point ) );
+            if( has_color ){
+                float color_point[3];
+                float color_pixel[2];
+                rs2_transform_point_to_point( color_point, &job.depth_to_color, point );
+                rs2_project_point_to_pixel( color_pixel, &job.color_intrinsics, color_point );
+                const int32_t u = static_cast<int32_t>( color_pixel[0] + 0.5f );
+                const int32_t v = static_cast<int32_t>( color_pixel[1] + 0.5f );
+                uint8_t* rgb = vertex + sizeof( point );
+                if( 0 <= u && u < job.color_mat.cols && 0 <= v && v < job.color_mat.rows ){
+                    const cv::Vec3b& bgr = job.color_mat.at<cv::Vec3b>( v, u );
+                    rgb[0] = bgr[2];
+                    rgb[1] = bgr[1];
+                    rgb[2] = bgr[0];
+                }
+                else{
+                    rgb[0] = rgb[1] = rgb[2] = 0;
+                }
+            }
+            vertices.insert( vertices.end(), vertex, vertex + vertex_size );
+            num_vertices++;
+        }
+    }
+
+    // Header
+    std::string header = "ply\nformat binary_little_endian 1.0\n";
+    header += "element vertex " + std::to_string( num_vertices ) + "\n";
+    header += "property float x\nproperty float y\nproperty float z\n";
+    if( has_color ){
+        header += "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+    }
+    header += "end_header\n";
+
+    std::vector<uint8_t> buffer( header.begin(), header.end() );
+    buffer.insert( buffer.end(), vertices.begin(), vertices.end() );
+    write( job.file_name, buffer );
+}
+
+// Output File Name of Frame
+inline std::string Export::name( const std::string& stream, const uint64_t frame_number, const std::string& extension ) const
+{
+    char number[32];
+    std::snprintf( number, sizeof( number ), "%010llu", static_cast<unsigned long long>( frame_number ) );
+    return output_directory + "/" + stream + "_" + number + extension;
+}
+
+// Check Frame was Already Exported
+// Files are renamed after written completely, so existing file is never partial.
+inline bool Export::exists( const std::string& file_name ) const
+{
+    std::ifstream ifs( file_name, std::ios::binary );
+    return ifs.is_open();
+}
+
+// Write File Atomically (Write Temporary File, then Rename)
+inline void Export::write( const std::string& file_name, const std::vector<uint8_t>& data )
+{
+    const std::string temporary_file_name = file_name + ".tmp";
+    {
+        std::ofstream ofs( temporary_file_name, std::ios::binary );
+        ofs.write( reinterpret_cast<const char*>( data.data() ), data.size() );
+        if( !ofs ){
+            throw std::runtime_error( "failed to write " + temporary_file_name );
+        }
+    }
+
+    if( std::rename( temporary_file_name.c_str(), file_name.c_str() ) != 0 ){
+        throw std::runtime_error( "failed to rename " + temporary_file_name );
+    }
+    written_bytes += data.size();
+}
+
+// Report Result
+void Export::report()
+{
+    const double megabytes = written_bytes / ( 1024.0 * 1024.0 );
+    std::cout << "export : " << framesets << " framesets"
+              << ", " << exported << " files exported"
+              << ", " << skipped << " files skipped (already exported)"
+              << ", " << megabytes << " MB written"
+              << ", processed " << elapsed << " s"
+              << ", " << ( elapsed > 0.0 ? framesets / elapsed : 0.0 ) << " fps"
+              << ", " << ( elapsed > 0.0 ? megabytes / elapsed : 0.0 ) << " MB/s" << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#ifndef __EXPORT__
+#define __EXPORT__
+
+#include <librealsense2/rs.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "bounded_queue.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <exception>
+
+// Multi-Threaded Export of Recording (.bag) to Image Sequences and Point Clouds
+// Playback reads frames as fast as possible, and encoding (16-bit PNG depth, JPEG color, binary PLY cloud) is distributed over worker threads.
+// Memory is bounded by queue of jobs (playback waits while queue is full), and files that were already exported are skipped, so export can be restarted.
+class Export
+{
+private:
+    // Settings
+    uint32_t workers = 0; // 0 is Number of Hardware Threads
+    size_t queue_size = 0; // 0 is Twice Number of Workers
+    bool export_depth = true;
+    bool export_color = true;
+    bool export_cloud = true;
+    int32_t png_compression = 3; // 0-9
+    int32_t jpeg_quality = 95; // 0-100
+
+    // File
+    std::string file_name;
+    std::string output_directory = "export";
+
+    // Depth Scale of Recording (meters per unit)
+    float depth_scale = 0.001f;
+
+    // Job of Worker (Images are Copied from Frames, so Playback can Reuse Frames)
+    struct job
+    {
+        enum kind_type { depth, color, cloud } kind;
+        std::string file_name;
+        cv::Mat depth_mat; // CV_16UC1
+        cv::Mat color_mat; // CV_8UC3 (BGR)
+        rs2_intrinsics depth_intrinsics;
+        rs2_intrinsics color_intrinsics;
+        rs2_extrinsics depth_to_color;
+    };
+    std::unique_ptr<bounded_queue<job>> jobs;
+
+    // Playback
+    rs2::pipeline pipeline;
+    std::mutex mutex;
+    std::exception_ptr exception;
+
+    // Statistics
+    std::atomic<uint64_t> framesets;
+    std::atomic<uint64_t> exported;
+    std::atomic<uint64_t> skipped;
+    std::atomic<uint64_t> written_bytes;
+    double elapsed = 0.0;
+
+public:
+    // Constructor
+    Export( int argc, char* argv[] );
+
+    // Destructor
+    ~Export();
+
+    // Processing
+    void run();
+
+private:
+    // Initialize
+    void initialize( int argc, char* argv[] );
+
+    // Parse Arguments
+    inline void parseArguments( int argc, char* argv[] );
+
+    // Finalize
+    void finalize();
+
+    // Push Jobs of Frameset (Playback Thread)
+    void push( const rs2::frameset& frameset );
+
+    // Process Jobs (Worker)
+    void process();
+
+    // Export Depth to 16-bit PNG
+    inline void exportDepth( const job& job );
+
+    // Export Color to JPEG
+    inline void exportColor( const job& job );
+
+    // Export Point Cloud to Binary PLY
+    inline void exportCloud( const job& job );
+
+    // Output File Name of Frame
+    inline std::string name( const std::string& stream, const uint64_t frame_number, const std::string& extension ) const;
+
+    // Check Frame was Already Exported
+    inline bool exists( const std::string& file_name ) const;
+
+    // Write File Atomically (Write Temporary File, then Rename)
+    inline void write( const std::string& file_name, const std::vector<uint8_t>& data );
+
+    // Report Result
+    void report();
+};
+
+#endif // __EXPORT__
\ No newline at end of file
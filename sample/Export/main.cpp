@@ -0,0 +1,16 @@
+#include <iostream>
+#include <sstream>
+
+#include "export.h"
+
+int main( int argc, char* argv[] )
+{
+    try{
+        Export exporter( argc, argv );
+        exporter.run();
+    } catch( std::exception& ex ){
+        std::cout << ex.what() << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
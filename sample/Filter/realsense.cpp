@@ -55,8 +55,20 @@ inline void RealSense::initializeSensor()
     rs2::config config;
     config.enable_stream( rs2_stream::RS2_STREAM_DEPTH, depth_width, depth_height, rs2_format::RS2_FORMAT_Z16, depth_fps );
 
+#ifdef SYNTHETIC
+    // Use Synthetic Device instead of Live Device
+    synthetic.add_to( context );
+    pipeline = rs2::pipeline( context );
+    config.enable_device( synthetic.serial() );
+#endif
+
     // Start Pipeline
     pipeline_profile = pipeline.start( config );
+
+#ifdef SYNTHETIC
+    // Start Generating Frames of Synthetic Device
+    synthetic.start( pipeline_profile );
+#endif
 }
 
 // Initialize Filter
@@ -81,6 +93,11 @@ void RealSense::finalize()
     // Close Windows
     cv::destroyAllWindows();
 
+#ifdef SYNTHETIC
+    // Stop Generating Frames of Synthetic Device before Pipeline
+    synthetic.stop();
+#endif
+
     // Stop Pipline
     pipeline.stop();
 }
@@ -53,8 +53,20 @@ inline void RealSense::initializeSensor()
     config.enable_stream( rs2_stream::RS2_STREAM_INFRARED, 1, infrared_width, infrared_height, rs2_format::RS2_FORMAT_Y8, infrared_fps ); // Left
     config.enable_stream( rs2_stream::RS2_STREAM_INFRARED, 2, infrared_width, infrared_height, rs2_format::RS2_FORMAT_Y8, infrared_fps ); // Right
 
+#ifdef SYNTHETIC
+    // Use Synthetic Device instead of Live Device
+    synthetic.add_to( context );
+    pipeline = rs2::pipeline( context );
+    config.enable_device( synthetic.serial() );
+#endif
+
     // Start Pipeline
     pipeline_profile = pipeline.start( config );
+
+#ifdef SYNTHETIC
+    // Start Generating Frames of Synthetic Device
+    synthetic.start( pipeline_profile );
+#endif
 }
 
 // Finalize
@@ -63,6 +75,11 @@ void RealSense::finalize()
     // Close Windows
     cv::destroyAllWindows();
 
+#ifdef SYNTHETIC
+    // Stop Generating Frames of Synthetic Device before Pipeline
+    synthetic.stop();
+#endif
+
     // Stop Pipline
     pipeline.stop();
 }
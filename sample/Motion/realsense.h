@@ -4,9 +4,19 @@
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
 
+#ifdef SYNTHETIC
+#include "synthetic_device.h"
+#endif
+
 class RealSense
 {
 private:
+#ifdef SYNTHETIC
+    // Synthetic Device
+    rs2::context context;
+    synthetic_device synthetic;
+#endif
+
     // RealSense
     rs2::pipeline pipeline;
     rs2::pipeline_profile pipeline_profile;
@@ -0,0 +1,299 @@
+// This is minimum implementation of hot-plug device management.
+// Devices changed callback of context only wakes up background thread, and background thread compares connected devices with known devices.
+// Slow work (starting pipeline of re-connected or new device, stopping pipeline of removed device) runs on background thread, main loop only swaps prepared devices in and out.
+// Time from removal (or failure) to re-connection is tracked per device.
+
+#ifndef __DEVICE_HOTPLUG__
+#define __DEVICE_HOTPLUG__
+
+#include <librealsense2/rs.hpp>
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <iostream>
+#include <exception>
+#include <algorithm>
+#include <cstdint>
+
+namespace hotplug
+{
+    // Options
+    struct options
+    {
+        std::chrono::milliseconds retry_interval = std::chrono::milliseconds( 500 ); // interval to retry connection of wanted device
+        std::set<std::string> ignore_names = { "Platform Camera" }; // devices that are not managed (friendly name)
+        std::set<std::string> ignore_serial_numbers; // devices that are not managed (e.g. not planned)
+    };
+
+    // Statistics of Device
+    struct statistics
+    {
+        uint32_t disconnects = 0;
+        uint32_t reconnects = 0;
+        double last = 0.0; // milliseconds of last reconnection
+        double total = 0.0; // milliseconds
+        double max = 0.0; // milliseconds
+    };
+
+    // Device Arrived on Background Thread
+    template<typename T>
+    struct arrival
+    {
+        std::string serial_number;
+        std::unique_ptr<T> device;
+        bool is_new; // device was not known (otherwise re-connected)
+    };
+}
+
+template<typename T>
+class device_hotplug
+{
+public:
+    // Factory Creates Device (Exception is Retried after Interval, nullptr is Not Managed)
+    using factory = std::function<std::unique_ptr<T>( const rs2::device& )>;
+
+private:
+    // State of Device
+    enum class state
+    {
+        connected, // owned by main loop
+        removing, // removed from system, waiting for release by main loop
+        wanted // released, waiting for connection
+    };
+
+    struct entry
+    {
+        state status = state::wanted;
+        bool is_new = false;
+        std::chrono::steady_clock::time_point lost_time;
+        hotplug::statistics statistics;
+    };
+
+    hotplug::options option;
+    factory create;
+
+    rs2::context context;
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    bool changed = true;
+    bool stopping = false;
+
+    std::map<std::string, entry> entries;
+    std::vector<std::unique_ptr<T>> retired; // destroyed on background thread
+    std::vector<std::string> removed; // to main loop
+    std::vector<hotplug::arrival<T>> arrived; // to main loop
+
+public:
+    device_hotplug( factory create, const std::vector<std::string>& connected, const hotplug::options& option = hotplug::options() )
+        : option( option )
+        , create( create )
+    {
+        for( const std::string& serial_number : connected ){
+            entries[serial_number].status = state::connected;
+        }
+
+        // Callback only Wakes Up Background Thread (Callback Thread of SDK is not Blocked)
+        context.set_devices_changed_callback( [this]( rs2::event_information& ){
+            std::lock_guard<std::mutex> lock( mutex );
+            changed = true;
+            condition.notify_one();
+        } );
+
+        thread = std::thread( &device_hotplug::run, this );
+    }
+
+    ~device_hotplug()
+    {
+        context.set_devices_changed_callback( []( rs2::event_information& ){} );
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            stopping = true;
+        }
+        condition.notify_one();
+        thread.join();
+    }
+
+    device_hotplug( const device_hotplug& ) = delete;
+    device_hotplug& operator=( const device_hotplug& ) = delete;
+
+    // Poll Removed and Arrived Devices (Main Loop, Non-Blocking)
+    // Removed devices must be released by release(), arrived devices are owned by main loop.
+    void poll( std::vector<std::string>& removed_devices, std::vector<hotplug::arrival<T>>& arrived_devices )
+    {
+        removed_devices.clear();
+        arrived_devices.clear();
+
+        std::lock_guard<std::mutex> lock( mutex );
+        std::swap( removed_devices, removed );
+        std::swap( arrived_devices, arrived );
+    }
+
+    // Release Device that is Removed or Failed (Destroyed on Background Thread, Re-Connected when Available)
+    void release( const std::string& serial_number, std::unique_ptr<T> device )
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            entry& entry = entries[serial_number];
+            if( entry.status == state::connected ){
+                // Failed on Main Loop before Removal is Detected
+                entry.lost_time = std::chrono::steady_clock::now();
+                entry.statistics.disconnects++;
+            }
+            entry.status = state::wanted;
+            entry.is_new = false;
+            if( device ){
+                retired.push_back( std::move( device ) );
+            }
+            changed = true;
+        }
+        condition.notify_one();
+    }
+
+    // Retrieve Statistics of Device
+    hotplug::statistics get_statistics( const std::string& serial_number ) const
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        const typename std::map<std::string, entry>::const_iterator it = entries.find( serial_number );
+        return ( it != entries.end() ) ? it->second.statistics : hotplug::statistics();
+    }
+
+private:
+    // Background Thread
+    void run()
+    {
+        while( true ){
+            // Wait Change of Devices, Release, or Retry Interval while Any Device is Wanted
+            std::vector<std::unique_ptr<T>> destroying;
+            {
+                std::unique_lock<std::mutex> lock( mutex );
+                const bool retry = wanted();
+                const auto predicate = [&]{ return stopping || changed || !retired.empty(); };
+                if( retry ){
+                    condition.wait_for( lock, option.retry_interval, predicate );
+                }
+                else{
+                    condition.wait( lock, predicate );
+                }
+                if( stopping ){
+                    return;
+                }
+                changed = false;
+                std::swap( destroying, retired );
+            }
+
+            // Stop Released Devices (Pipeline Stop may Take Time)
+            destroying.clear();
+
+            // Compare Connected Devices with Known Devices
+            try{
+                update();
+            }
+            catch( const std::exception& ex ){
+                std::cout << "Hot-Plug: " << ex.what() << std::endl;
+            }
+        }
+    }
+
+    // Detect Removed Devices and Connect Wanted Devices
+    void update()
+    {
+        std::map<std::string, rs2::device> present;
+        const rs2::device_list device_list = context.query_devices();
+        for( const rs2::device& device : device_list ){
+            const std::string friendly_name = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_NAME );
+            const std::string serial_number = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_SERIAL_NUMBER );
+            if( option.ignore_names.count( friendly_name ) || option.ignore_serial_numbers.count( serial_number ) ){
+                continue;
+            }
+            present[serial_number] = device;
+        }
+
+        std::vector<std::pair<std::string, rs2::device>> connecting;
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            // Removed Devices (Main Loop Releases Them)
+            for( std::pair<const std::string, entry>& entry : entries ){
+                if( entry.second.status == state::connected && !present.count( entry.first ) ){
+                    entry.second.status = state::removing;
+                    entry.second.lost_time = now;
+                    entry.second.statistics.disconnects++;
+                    removed.push_back( entry.first );
+                }
+            }
+
+            // New Devices
+            for( const std::pair<const std::string, rs2::device>& device : present ){
+                if( !entries.count( device.first ) ){
+                    entry& entry = entries[device.first];
+                    entry.status = state::wanted;
+                    entry.is_new = true;
+                    entry.lost_time = now;
+                }
+            }
+
+            // Wanted Devices that are Present
+            for( const std::pair<const std::string, entry>& entry : entries ){
+                if( entry.second.status == state::wanted && present.count( entry.first ) ){
+                    connecting.emplace_back( entry.first, present[entry.first] );
+                }
+            }
+        }
+
+        // Start Devices outside of Lock (Failed Devices are Retried after Interval)
+        for( const std::pair<std::string, rs2::device>& device : connecting ){
+            std::unique_ptr<T> connected;
+            try{
+                connected = create( device.second );
+            }
+            catch( const std::exception& ex ){
+                std::cout << "Hot-Plug (" << device.first << "): " << ex.what() << std::endl;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock( mutex );
+            entry& entry = entries[device.first];
+            if( !connected ){
+                // Device that Factory Declined is not Managed
+                option.ignore_serial_numbers.insert( device.first );
+                entries.erase( device.first );
+                continue;
+            }
+            if( entry.status != state::wanted ){
+                retired.push_back( std::move( connected ) );
+                continue;
+            }
+            entry.status = state::connected;
+            if( !entry.is_new ){
+                const double time = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - entry.lost_time ).count();
+                entry.statistics.reconnects++;
+                entry.statistics.last = time;
+                entry.statistics.total += time;
+                entry.statistics.max = std::max( entry.statistics.max, time );
+            }
+            arrived.push_back( { device.first, std::move( connected ), entry.is_new } );
+        }
+    }
+
+    bool wanted() const
+    {
+        for( const std::pair<const std::string, entry>& entry : entries ){
+            if( entry.second.status == state::wanted ){
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif // __DEVICE_HOTPLUG__
\ No newline at end of file
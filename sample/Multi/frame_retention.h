@@ -0,0 +1,168 @@
+// This is minimum implementation of frame retention manager.
+// SDK frames come from fixed size frame pool of each stream, so holding them across iterations stalls pipeline.
+// Manager keeps SDK frame (zero-copy) while number of kept frames is within budget, otherwise it copies frame into pooled slab and releases SDK frame immediately.
+// Retained frame is valid while retained_frame handle (or its copy) is alive.
+// Caller must release SDK frame (rs2::frame, rs2::frameset) after retain(), otherwise slab copy releases nothing.
+
+#ifndef __FRAME_RETENTION__
+#define __FRAME_RETENTION__
+
+#include <librealsense2/rs.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+class frame_retention;
+
+// Handle of Retained Frame
+class retained_frame
+{
+private:
+    friend class frame_retention;
+    std::shared_ptr<const uint8_t> data;
+    int32_t width = 0;
+    int32_t height = 0;
+    size_t stride = 0;
+
+public:
+    // Wrap Retained Data with cv::Mat (No Copy)
+    // cv::Mat doesn't own retained data, so this handle must outlive cv::Mat (and its copies), release cv::Mat before handle.
+    cv::Mat mat( const int32_t type ) const
+    {
+        if( !data ){
+            return cv::Mat();
+        }
+        return cv::Mat( height, width, type, const_cast<uint8_t*>( data.get() ), stride );
+    }
+
+    explicit operator bool() const
+    {
+        return static_cast<bool>( data );
+    }
+};
+
+class frame_retention
+{
+private:
+    // Pool State (Shared with Handles so that Handles can Outlive Manager)
+    struct state
+    {
+        std::mutex mutex;
+        size_t keep_budget;
+        size_t kept = 0;
+        std::vector<std::unique_ptr<uint8_t[]>> slabs;
+        std::vector<size_t> slab_capacities;
+        std::vector<size_t> free_slabs;
+        size_t max_slabs;
+        uint64_t kept_total = 0;
+        uint64_t copied_total = 0;
+        uint64_t dropped_total = 0;
+    };
+    std::shared_ptr<state> pool;
+
+public:
+    // keep_budget : max number of SDK frames kept at same time
+    // max_slabs : max number of slabs for copied frames
+    frame_retention( const size_t keep_budget = 2, const size_t max_slabs = 8 )
+        : pool( std::make_shared<state>() )
+    {
+        pool->keep_budget = keep_budget;
+        pool->max_slabs = max_slabs;
+    }
+
+    // Retain Frame
+    // Returns empty handle when both budget and slabs are exhausted. (Frame is dropped)
+    retained_frame retain( rs2::frame frame )
+    {
+        retained_frame retained;
+        if( !frame ){
+            return retained;
+        }
+
+        const rs2::video_frame video_frame = frame.as<rs2::video_frame>();
+        retained.width = video_frame.get_width();
+        retained.height = video_frame.get_height();
+        retained.stride = video_frame.get_stride_in_bytes();
+        const size_t size = retained.stride * retained.height;
+
+        std::shared_ptr<state> shared_pool = pool;
+        std::unique_lock<std::mutex> lock( pool->mutex );
+
+        // Keep SDK Frame within Budget (Zero-Copy)
+        if( pool->kept < pool->keep_budget ){
+            pool->kept++;
+            pool->kept_total++;
+            lock.unlock();
+
+            frame.keep();
+            const uint8_t* data = static_cast<const uint8_t*>( frame.get_data() );
+            retained.data = std::shared_ptr<const uint8_t>( data, [shared_pool, frame]( const uint8_t* ){
+                std::lock_guard<std::mutex> lock( shared_pool->mutex );
+                shared_pool->kept--;
+            } );
+            return retained;
+        }
+
+        // Copy into Pooled Slab and Release SDK Frame
+        const int32_t index = acquire( size );
+        if( index < 0 ){
+            pool->dropped_total++;
+            return retained;
+        }
+        pool->copied_total++;
+        uint8_t* slab = pool->slabs[index].get();
+        lock.unlock();
+
+        std::memcpy( slab, frame.get_data(), size );
+        retained.data = std::shared_ptr<const uint8_t>( slab, [shared_pool, index]( const uint8_t* ){
+            std::lock_guard<std::mutex> lock( shared_pool->mutex );
+            shared_pool->free_slabs.push_back( index );
+        } );
+        return retained;
+    }
+
+    // Report Pool Occupancy
+    std::string report() const
+    {
+        std::lock_guard<std::mutex> lock( pool->mutex );
+        std::ostringstream oss;
+        oss << "kept " << pool->kept << "/" << pool->keep_budget
+            << ", slabs " << ( pool->slabs.size() - pool->free_slabs.size() ) << "/" << pool->slabs.size() << " (max " << pool->max_slabs << ")"
+            << ", total kept " << pool->kept_total << " copied " << pool->copied_total << " dropped " << pool->dropped_total;
+        return oss.str();
+    }
+
+private:
+    // Acquire Free Slab and Return its Index, or -1 if Exhausted (Pool Mutex must be Locked)
+    int32_t acquire( const size_t size )
+    {
+        int32_t index = -1;
+        if( !pool->free_slabs.empty() ){
+            index = static_cast<int32_t>( pool->free_slabs.back() );
+            pool->free_slabs.pop_back();
+        }
+        else if( pool->slabs.size() < pool->max_slabs ){
+            index = static_cast<int32_t>( pool->slabs.size() );
+            pool->slabs.emplace_back();
+            pool->slab_capacities.push_back( 0 );
+        }
+        else{
+            return -1;
+        }
+
+        // Grow Slab when Frame is Larger than Capacity
+        if( pool->slab_capacities[index] < size ){
+            pool->slabs[index].reset( new uint8_t[size] );
+            pool->slab_capacities[index] = size;
+        }
+        return index;
+    }
+};
+
+#endif // __FRAME_RETENTION__
@@ -0,0 +1,296 @@
+#include "fusion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+#include <xmmintrin.h>
+#define FUSION_SSE
+#endif
+
+// Transform Valid Vertices by 4x4 Matrix and Append Device ID
+// Vertices whose depth is zero are skipped. Returns number of written points.
+static size_t transformVertices( const rs2::vertex* vertices, const size_t size, const cv::Matx44f& transform, const float device_id, cv::Vec4f* output )
+{
+    size_t count = 0;
+
+#ifdef FUSION_SSE
+    // Columns of Matrix (4th Lane of Translation Column Carries Device ID)
+    const __m128 column0 = _mm_setr_ps( transform( 0, 0 ), transform( 1, 0 ), transform( 2, 0 ), 0.0f );
+    const __m128 column1 = _mm_setr_ps( transform( 0, 1 ), transform( 1, 1 ), transform( 2, 1 ), 0.0f );
+    const __m128 column2 = _mm_setr_ps( transform( 0, 2 ), transform( 1, 2 ), transform( 2, 2 ), 0.0f );
+    const __m128 column3 = _mm_setr_ps( transform( 0, 3 ), transform( 1, 3 ), transform( 2, 3 ), device_id );
+
+    for( size_t index = 0; index < size; index++ ){
+        const rs2::vertex& vertex = vertices[index];
+        if( !vertex.z ){
+            continue;
+        }
+
+        __m128 point = _mm_add_ps( _mm_mul_ps( column0, _mm_set1_ps( vertex.x ) ), column3 );
+        point = _mm_add_ps( _mm_mul_ps( column1, _mm_set1_ps( vertex.y ) ), point );
+        point = _mm_add_ps( _mm_mul_ps( column2, _mm_set1_ps( vertex.z ) ), point );
+        _mm_storeu_ps( output[count++].val, point );
+    }
+#else
+    for( size_t index = 0; index < size; index++ ){
+        const rs2::vertex& vertex = vertices[index];
+        if( !vertex.z ){
+            continue;
+        }
+
+        output[count++] = cv::Vec4f( transform( 0, 0 ) * vertex.x + transform( 0, 1 ) * vertex.y + transform( 0, 2 ) * vertex.z + transform( 0, 3 ),
+                                     transform( 1, 0 ) * vertex.x + transform( 1, 1 ) * vertex.y + transform( 1, 2 ) * vertex.z + transform( 1, 3 ),
+                                     transform( 2, 0 ) * vertex.x + transform( 2, 1 ) * vertex.y + transform( 2, 2 ) * vertex.z + transform( 2, 3 ),
+                                     device_id );
+    }
+#endif
+
+    return count;
+}
+
+// Constructor
+PointCloudFusion::PointCloudFusion()
+{
+}
+
+// Destructor
+PointCloudFusion::~PointCloudFusion()
+{
+}
+
+// Initialize
+void PointCloudFusion::initialize( const std::vector<std::unique_ptr<RealSense>>& realsenses )
+{
+    // Initialize Extrinsics
+    initializeExtrinsics( realsenses );
+
+    // Initialize Device Buffer
+    device_mats.resize( realsenses.size() );
+    device_sizes.assign( realsenses.size(), 0 );
+    device_offsets.assign( realsenses.size() + 1, 0 );
+    device_times.assign( realsenses.size(), std::chrono::steady_clock::duration::zero() );
+}
+
+// Initialize Extrinsics
+inline void PointCloudFusion::initializeExtrinsics( const std::vector<std::unique_ptr<RealSense>>& realsenses )
+{
+    // Identity is used for devices that are not listed in file
+    extrinsics.assign( realsenses.size(), cv::Matx44f::eye() );
+    for( size_t i = 0; i < realsenses.size(); i++ ){
+        if( realsenses[i] ){
+            extrinsics[i] = readExtrinsics( realsenses[i]->getSerialNumber() );
+        }
+    }
+}
+
+// Read Extrinsics of Device from File
+inline cv::Matx44f PointCloudFusion::readExtrinsics( const std::string& serial_number )
+{
+    // Read Extrinsics from File
+    // e.g. T_<serial number>: !!opencv-matrix { rows: 4, cols: 4, dt: f, data: [ ... ] }
+    cv::FileStorage file_storage( extrinsics_file, cv::FileStorage::READ );
+    if( !file_storage.isOpened() ){
+        return cv::Matx44f::eye();
+    }
+
+    cv::Mat transform;
+    file_storage["T_" + serial_number] >> transform;
+    if( transform.empty() ){
+        return cv::Matx44f::eye();
+    }
+
+    CV_Assert( transform.rows == 4 && transform.cols == 4 );
+    transform.convertTo( transform, CV_32F );
+    return cv::Matx44f( transform.ptr<float>() );
+}
+
+// Fuse Point Clouds
+void PointCloudFusion::fuse( std::vector<std::unique_ptr<RealSense>>& realsenses, const std::vector<size_t>& updated )
+{
+    const int32_t num_updated = static_cast<int32_t>( updated.size() );
+
+    // Calculate and Transform Point Cloud of Each Updated Device (Slot of Removed Device is Emptied by detach())
+    #pragma omp parallel for schedule( dynamic, 1 )
+    for( int32_t i = 0; i < num_updated; i++ ){
+        const size_t index = updated[i];
+        if( realsenses[index] ){
+            transform( index, *realsenses[index] );
+        }
+    }
+
+    // Concatenate Point Clouds
+    concatenate();
+
+    // Report Throughput
+    report( realsenses.size() );
+}
+
+// Calculate and Transform Point Cloud of Device
+void PointCloudFusion::transform( const size_t index, RealSense& realsense )
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const rs2::points points = realsense.calculatePointCloud();
+    if( !points ){
+        device_sizes[index] = 0;
+        return;
+    }
+
+    cv::Mat& device_mat = device_mats[index];
+    device_mat.create( 1, static_cast<int32_t>( points.size() ), CV_32FC4 );
+    device_sizes[index] = transformVertices( points.get_vertices(), points.size(), extrinsics[index], static_cast<float>( index ), device_mat.ptr<cv::Vec4f>() );
+    device_times[index] = std::chrono::steady_clock::now() - start;
+}
+
+// Concatenate Transformed Point Clouds of All Devices
+void PointCloudFusion::concatenate()
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const int32_t num_devices = static_cast<int32_t>( device_sizes.size() );
+
+    // Calculate Offsets in Fused Buffer
+    for( int32_t i = 0; i < num_devices; i++ ){
+        device_offsets[i + 1] = device_offsets[i] + device_sizes[i];
+    }
+    fused_size = device_offsets[num_devices];
+
+    // Grow Fused Buffer (Reuse while Capacity is Enough)
+    if( fused_mat.empty() || static_cast<size_t>( fused_mat.cols ) < fused_size ){
+        fused_mat.create( 1, static_cast<int32_t>( std::max<size_t>( fused_size, 1 ) ), CV_32FC4 );
+    }
+
+    // Concatenate Point Clouds into Fused Buffer
+    #pragma omp parallel for
+    for( int32_t i = 0; i < num_devices; i++ ){
+        if( !device_sizes[i] ){
+            continue;
+        }
+
+        std::memcpy( fused_mat.ptr<cv::Vec4f>() + device_offsets[i], device_mats[i].ptr<cv::Vec4f>(), device_sizes[i] * sizeof( cv::Vec4f ) );
+    }
+
+    // Deduplicate Overlap
+    if( dedup_leaf_size > 0.0f ){
+        deduplicate();
+    }
+
+    // Accumulate Throughput
+    // Devices are transformed in parallel (OpenMP or pool), so slowest transform since last concatenate is time of transform.
+    std::chrono::steady_clock::duration transform_time = std::chrono::steady_clock::duration::zero();
+    for( std::chrono::steady_clock::duration& device_time : device_times ){
+        transform_time = std::max( transform_time, device_time );
+        device_time = std::chrono::steady_clock::duration::zero();
+    }
+    total_time += transform_time + ( std::chrono::steady_clock::now() - start );
+    total_points += fused_size;
+    total_frames++;
+}
+
+// Attach Device to Slot
+void PointCloudFusion::attach( const size_t index, const RealSense& realsense )
+{
+    // Grow Device Buffer for New Device
+    if( index >= device_sizes.size() ){
+        extrinsics.resize( index + 1, cv::Matx44f::eye() );
+        device_mats.resize( index + 1 );
+        device_sizes.resize( index + 1, 0 );
+        device_offsets.resize( index + 2, 0 );
+        device_times.resize( index + 1, std::chrono::steady_clock::duration::zero() );
+    }
+
+    extrinsics[index] = readExtrinsics( realsense.getSerialNumber() );
+    device_sizes[index] = 0;
+}
+
+// Detach Device from Slot
+void PointCloudFusion::detach( const size_t index )
+{
+    // Point Cloud of Removed Device is not Concatenated
+    device_sizes[index] = 0;
+}
+
+// Deduplicate Overlap
+inline void PointCloudFusion::deduplicate()
+{
+    // Drop points that fall into voxel already occupied by other device
+    occupied_voxels.clear();
+    const float inverse_leaf_size = 1.0f / dedup_leaf_size;
+    cv::Vec4f* points = fused_mat.ptr<cv::Vec4f>();
+    size_t count = 0;
+    for( size_t index = 0; index < fused_size; index++ ){
+        const cv::Vec4f& point = points[index];
+        const uint64_t x = static_cast<uint64_t>( static_cast<int64_t>( std::floor( point[0] * inverse_leaf_size ) ) + ( 1 << 20 ) ) & 0x1FFFFF;
+        const uint64_t y = static_cast<uint64_t>( static_cast<int64_t>( std::floor( point[1] * inverse_leaf_size ) ) + ( 1 << 20 ) ) & 0x1FFFFF;
+        const uint64_t z = static_cast<uint64_t>( static_cast<int64_t>( std::floor( point[2] * inverse_leaf_size ) ) + ( 1 << 20 ) ) & 0x1FFFFF;
+        const uint64_t key = ( x << 42 ) | ( y << 21 ) | z;
+
+        const std::pair<std::unordered_map<uint64_t, float>::iterator, bool> result = occupied_voxels.emplace( key, point[3] );
+        if( !result.second && result.first->second != point[3] ){
+            continue;
+        }
+
+        points[count++] = point;
+    }
+    fused_size = count;
+}
+
+// Report Throughput
+void PointCloudFusion::report( const size_t num_devices )
+{
+    if( total_frames < report_frames ){
+        return;
+    }
+
+    const double seconds = std::chrono::duration<double>( total_time ).count();
+    std::cout << "Fusion: " << num_devices << " cameras, "
+              << static_cast<uint64_t>( total_points / seconds ) << " points/s, "
+              << seconds * 1000.0 / total_frames << " ms/frame" << std::endl;
+
+    total_frames = 0;
+    total_points = 0;
+    total_time = std::chrono::steady_clock::duration::zero();
+}
+
+// Retrieve Fused Point Cloud (1xN, CV_32FC4)
+cv::Mat PointCloudFusion::cloud() const
+{
+    if( !fused_size ){
+        return cv::Mat();
+    }
+
+    return fused_mat.colRange( 0, static_cast<int32_t>( fused_size ) );
+}
+
+// Save Fused Point Cloud to PLY File
+void PointCloudFusion::save( const std::string& file_name ) const
+{
+    const cv::Mat points = cloud();
+
+    // Write Point Cloud to PLY File (x, y, z, device id)
+    std::ofstream ofs( file_name );
+    if( !ofs.is_open() ){
+        throw std::runtime_error( "failed to open " + file_name );
+    }
+
+    ofs << "ply\n"
+        << "format ascii 1.0\n"
+        << "element vertex " << points.cols << "\n"
+        << "property float x\n"
+        << "property float y\n"
+        << "property float z\n"
+        << "property uchar device\n"
+        << "end_header\n";
+    for( int32_t i = 0; i < points.cols; i++ ){
+        const cv::Vec4f& point = points.at<cv::Vec4f>( 0, i );
+        ofs << point[0] << " " << point[1] << " " << point[2] << " " << static_cast<int32_t>( point[3] ) << "\n";
+    }
+
+    std::cout << "Saved " << points.cols << " points to " << file_name << std::endl;
+}
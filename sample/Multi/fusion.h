@@ -0,0 +1,87 @@
+#ifndef __FUSION__
+#define __FUSION__
+
+#include "realsense.h"
+
+#include <librealsense2/rs.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <unordered_map>
+
+class PointCloudFusion
+{
+private:
+    // Extrinsics (Device to Common Frame)
+    std::vector<cv::Matx44f> extrinsics;
+    std::string extrinsics_file = "extrinsics.yml";
+
+    // Device Buffer
+    std::vector<cv::Mat> device_mats;
+    std::vector<size_t> device_sizes;
+    std::vector<size_t> device_offsets;
+    std::vector<std::chrono::steady_clock::duration> device_times; // time of last transform (devices are transformed in parallel)
+
+    // Fused Buffer (x, y, z, device id)
+    cv::Mat fused_mat;
+    size_t fused_size = 0;
+
+    // Deduplication
+    float dedup_leaf_size = 0.0f; // [m] (0.0 is disable deduplication)
+    std::unordered_map<uint64_t, float> occupied_voxels;
+
+    // Throughput
+    uint64_t report_frames = 30;
+    uint64_t total_frames = 0;
+    uint64_t total_points = 0;
+    std::chrono::steady_clock::duration total_time = std::chrono::steady_clock::duration::zero();
+
+public:
+    // Constructor
+    PointCloudFusion();
+
+    // Destructor
+    ~PointCloudFusion();
+
+    // Initialize
+    void initialize( const std::vector<std::unique_ptr<RealSense>>& realsenses );
+
+    // Fuse Point Clouds (Only Updated Devices are Transformed, Point Clouds of Other Devices are Kept)
+    void fuse( std::vector<std::unique_ptr<RealSense>>& realsenses, const std::vector<size_t>& updated );
+
+    // Calculate and Transform Point Cloud of Device (Devices can be Processed in Parallel)
+    void transform( const size_t index, RealSense& realsense );
+
+    // Concatenate Transformed Point Clouds of All Devices (Time of Transform and Concatenate is Accounted to Throughput)
+    void concatenate();
+
+    // Report Throughput (Every Report Frames)
+    void report( const size_t num_devices );
+
+    // Attach Device to Slot (Re-Connected or New Device)
+    void attach( const size_t index, const RealSense& realsense );
+
+    // Detach Device from Slot (Removed Device)
+    void detach( const size_t index );
+
+    // Retrieve Fused Point Cloud (1xN, CV_32FC4)
+    cv::Mat cloud() const;
+
+    // Save Fused Point Cloud to PLY File
+    void save( const std::string& file_name ) const;
+
+private:
+    // Initialize Extrinsics
+    inline void initializeExtrinsics( const std::vector<std::unique_ptr<RealSense>>& realsenses );
+
+    // Read Extrinsics of Device from File (Identity if not Listed)
+    inline cv::Matx44f readExtrinsics( const std::string& serial_number );
+
+    // Deduplicate Overlap
+    inline void deduplicate();
+};
+
+#endif // __FUSION__
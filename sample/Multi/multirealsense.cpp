@@ -1,5 +1,33 @@
 #include "multirealsense.h"
 
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+// Stop Requested by Signal (SIGINT, SIGTERM)
+// Main loop has no other exit without preview window, so finalize() (session file and recorders) runs by signal.
+static volatile std::sig_atomic_t stop_requested = 0;
+static void requestStop( int )
+{
+    stop_requested = 1;
+}
+
+// Percentile of Sorted Samples (Nearest Rank)
+static double percentile( const std::vector<double>& sorted, const double rate )
+{
+    if( sorted.empty() ){
+        return 0.0;
+    }
+    const size_t index = static_cast<size_t>( std::ceil( rate * sorted.size() ) );
+    return sorted[std::min( std::max<size_t>( index, 1 ), sorted.size() ) - 1];
+}
+
 // Constructor
 MultiRealSense::MultiRealSense()
 {
@@ -17,24 +45,85 @@ MultiRealSense::~MultiRealSense()
 // Processing
 void MultiRealSense::run()
 {
+    // Run Scaling Benchmark instead of Main Loop
+    if( enable_scaling_benchmark ){
+        runBenchmark();
+        return;
+    }
+
+    // Run Session Playback instead of Devices
+    if( player ){
+        runPlayback();
+        return;
+    }
+
     // Main Loop
     while( true ){
-        for( std::unique_ptr<RealSense>& realsense : realsenses ){
-            // Update Data
-            realsense->update();
+        // Swap Removed and Arrived Devices
+        updateHotplug();
 
-            // Draw Data
-            realsense->draw();
+        if( pool ){
+            // Update Cameras and Submit Processing to Pool
+            updatePool();
+        }
+        else{
+            updated_sensors.clear();
+            for( size_t i = 0; i < realsenses.size(); i++ ){
+                // Update Data
+                if( !updateSensor( i ) ){
+                    continue;
+                }
 
-            // Show Data
-            realsense->show();
+                // Draw Data
+                realsenses[i]->draw();
+                updated_sensors.push_back( i );
+            }
+
+            // Yield while No Camera has New Frames (Poll Mode)
+            if( updated_sensors.empty() ){
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+            }
+            // Fuse Point Clouds (Point Clouds of Cameras without New Frames are Kept)
+            else if( enable_fusion ){
+                fusion.fuse( realsenses, updated_sensors );
+            }
         }
 
+        // Show Mosaic
+        showMosaic();
+
         // Key Check
-        const int32_t key = cv::waitKey( 10 );
+        const int32_t key = checkKey();
         if( key == 'q' ){
             break;
         }
+        // Report Frame Retention when Pressed 'r' key
+        else if( key == 'r' ){
+            for( std::unique_ptr<RealSense>& realsense : realsenses ){
+                if( !realsense ){
+                    continue;
+                }
+                std::cout << "Retention (" << realsense->getSerialNumber() << "): " << realsense->reportRetention() << std::endl;
+            }
+        }
+        // Save Fused Point Cloud when Pressed 's' key
+        else if( key == 's' ){
+            saveFusion();
+        }
+        // Report Stall Events when Pressed 'w' key
+        else if( key == 'w' ){
+            for( std::unique_ptr<RealSense>& realsense : realsenses ){
+                if( !realsense ){
+                    continue;
+                }
+                for( const StallEvent& event : realsense->getStallEvents() ){
+                    std::cout << "Stall (" << realsense->getSerialNumber() << "): " << event.stream
+                              << " detected in " << event.detected << " ms, "
+                              << ( event.recovered > 0.0 ? "recovered in " + std::to_string( event.recovered ) + " ms" : std::string( "not recovered" ) )
+                              << " (" << event.restarts << " restarts)" << std::endl;
+                }
+            }
+        }
     }
 }
 
@@ -43,11 +132,40 @@ void MultiRealSense::initialize()
 {
     cv::setUseOptimized( true );
 
+    // Stop Main Loop by Signal
+    std::signal( SIGINT, requestStop );
+    std::signal( SIGTERM, requestStop );
+
+    // Cameras are Created for Each Step of Scaling Benchmark
+    if( enable_scaling_benchmark ){
+        return;
+    }
+
+    // Open Recorded Session instead of Devices
+    if( enable_playback ){
+        player.reset( new session_player( session_file_name, playback_options ) );
+        initializeMosaic();
+        initializePreview();
+        return;
+    }
+
+#ifdef SYNTHETIC
+    // Initialize Synthetic Sensors instead of Connected Sensors
+    for( uint32_t i = 0; i < synthetic_cameras; i++ ){
+        char serial_number[16];
+        std::snprintf( serial_number, sizeof( serial_number ), "SYNTHETIC-%04u", i );
+        RealSenseSettings settings;
+        settings.poll = enable_poll;
+        settings.pointcloud = enable_fusion;
+        realsenses.push_back( std::make_unique<RealSense>( serial_number, "Synthetic Device", settings ) );
+    }
+#else
     // Retrive Connected Sensors List
     rs2::context context;
     const rs2::device_list device_list = context.query_devices();
 
     // Initialize Connected Sensors
+    std::vector<rs2::device> devices;
     for( const rs2::device& device : device_list ){
         // Check Device
         // "Platform Camera" is not RealSense Devices
@@ -57,24 +175,682 @@ void MultiRealSense::initialize()
         }
 
         // Initialize Sensor
-        initializeSensor( device );
+        if( !enable_planner ){
+            initializeSensor( device );
+            continue;
+        }
+        devices.push_back( device );
+    }
+
+    // Initialize Sensors by Stream Profile Planner
+    initializePlannedSensors( devices );
+#endif
+
+    // Serial Number of Each Slot
+    for( std::unique_ptr<RealSense>& realsense : realsenses ){
+        serial_numbers.push_back( realsense->getSerialNumber() );
     }
+
+    // Initialize Mosaic
+    initializeMosaic();
+
+    // Initialize Preview Renderer
+    initializePreview();
+
+    // Initialize Point Cloud Fusion
+    fusion.initialize( realsenses );
+
+    // Initialize Session Recording
+    initializeRecording();
+
+    // Initialize Work-Stealing Pool
+    initializePool();
+
+    // Initialize Hot-Plug
+    initializeHotplug();
 }
 
 // Initialize Sensor
-inline void MultiRealSense::initializeSensor( const rs2::device& device )
+inline void MultiRealSense::initializeSensor( const rs2::device& device, const RealSenseSettings& settings )
 {
     // Retrive Serial Number (and Friendly Name)
     const std::string serial_number = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_SERIAL_NUMBER );
     const std::string friendly_name = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_NAME );
 
+    // Poll Mode
+    RealSenseSettings sensor_settings = settings;
+    sensor_settings.poll = enable_poll;
+    sensor_settings.pointcloud = enable_fusion;
+
     // Add Sensor to Container
-    realsenses.push_back( std::make_unique<RealSense>( serial_number, friendly_name ) );
+    realsenses.push_back( std::make_unique<RealSense>( serial_number, friendly_name, sensor_settings ) );
+    device_settings[serial_number] = sensor_settings;
+}
+
+// Initialize Sensors by Stream Profile Planner
+inline void MultiRealSense::initializePlannedSensors( const std::vector<rs2::device>& devices )
+{
+    if( devices.empty() ){
+        return;
+    }
+
+    // Plan Profiles within Bandwidth of Each USB Controller
+    const profile_planner stream_planner( planner_options );
+    const std::vector<planner::plan> plans = stream_planner.plan( devices );
+
+    // Start Devices in Planned Order with Interval (Inrush Current and Negotiation of Bandwidth are not Simultaneous)
+    for( const planner::plan& plan : plans ){
+        std::cout << "Plan: " << profile_planner::describe( plan ) << std::endl;
+        if( !plan.feasible ){
+            // Device that is not Planned is not Started by Hot-Plug either
+            hotplug_options.ignore_serial_numbers.insert( plan.serial_number );
+            continue;
+        }
+
+        if( !realsenses.empty() ){
+            std::this_thread::sleep_for( stagger_interval );
+        }
+        initializeSensor( plan.device, plan.settings() );
+    }
+}
+
+// Initialize Mosaic
+inline void MultiRealSense::initializeMosaic()
+{
+    if( realsenses.empty() && !player ){
+        return;
+    }
+
+    // Calculate Grid Size (Each Cell has Color and Depth Tiles Side by Side)
+    const int32_t num_devices = static_cast<int32_t>( player ? player->size() : realsenses.size() );
+    const int32_t grid_cols = static_cast<int32_t>( std::ceil( std::sqrt( static_cast<double>( num_devices ) ) ) );
+    const int32_t grid_rows = ( num_devices + grid_cols - 1 ) / grid_cols;
+
+    // Allocate Mosaic Buffer
+    const int32_t cell_width = tile_width * 2;
+    const int32_t cell_height = tile_height;
+    mosaic_mat = cv::Mat( grid_rows * cell_height, grid_cols * cell_width, CV_8UC3, cv::Scalar::all( 0 ) );
+
+    // Create Tiles that Refer to Mosaic Buffer
+    color_tiles.clear();
+    depth_tiles.clear();
+    for( int32_t i = 0; i < num_devices; i++ ){
+        const int32_t x = ( i % grid_cols ) * cell_width;
+        const int32_t y = ( i / grid_cols ) * cell_height;
+        color_tiles.push_back( mosaic_mat( cv::Rect( x, y, tile_width, tile_height ) ) );
+        depth_tiles.push_back( mosaic_mat( cv::Rect( x + tile_width, y, tile_width, tile_height ) ) );
+    }
+}
+
+// Initialize Preview Renderer
+inline void MultiRealSense::initializePreview()
+{
+    if( !enable_preview ){
+        return;
+    }
+
+    // Window is Created on Render Thread
+    preview::options option;
+    option.window_name = mosaic_window_name;
+    option.max_fps = preview_max_fps;
+    renderer.reset( new preview_renderer( option ) );
+}
+
+// Retrieve Key Pressed in Preview Window
+inline int32_t MultiRealSense::checkKey()
+{
+    // Stop Requested by Signal or Preview Window is Closed by User
+    if( stop_requested || ( renderer && !renderer->is_open() ) ){
+        return 'q';
+    }
+
+    // Key is Read by Render Thread (Processing does not Wait Window Events)
+    return renderer ? renderer->key() : -1;
+}
+
+// Initialize Hot-Plug
+inline void MultiRealSense::initializeHotplug()
+{
+#ifdef SYNTHETIC
+    // Synthetic Devices are not Listed in Context
+    return;
+#else
+    if( !enable_hotplug ){
+        return;
+    }
+
+    // Devices are Started and Stopped on Background Thread of Hot-Plug
+    hotplug_manager.reset( new device_hotplug<RealSense>( [this]( const rs2::device& device ){
+        return createSensor( device );
+    }, serial_numbers, hotplug_options ) );
+#endif
+}
+
+// Swap Removed and Arrived Devices
+inline void MultiRealSense::updateHotplug()
+{
+    if( !hotplug_manager ){
+        return;
+    }
+
+    // Poll Devices Changed on Background Thread (Non-Blocking)
+    hotplug_manager->poll( removed_devices, arrived_devices );
+
+    // Detach Removed Devices (Slot is Already Empty if Camera Failed before Removal is Detected)
+    for( const std::string& serial_number : removed_devices ){
+        for( size_t i = 0; i < realsenses.size(); i++ ){
+            if( serial_numbers[i] == serial_number && realsenses[i] ){
+                detachSensor( i );
+            }
+        }
+    }
+
+    // Attach Arrived Devices
+    for( hotplug::arrival<RealSense>& arrival : arrived_devices ){
+        attachSensor( arrival );
+    }
+    arrived_devices.clear();
+}
+
+// Update Camera
+inline bool MultiRealSense::updateSensor( const size_t index )
+{
+    if( !realsenses[index] ){
+        return false;
+    }
+
+    if( !hotplug_manager ){
+        return realsenses[index]->update();
+    }
+
+    // Camera that Failed (e.g. Timeout of Removed Device, Stall that Restarts could not Recover) is Detached, Other Cameras Keep Streaming
+    try{
+        return realsenses[index]->update();
+    }
+    catch( const std::exception& ex ){
+        std::cout << "Hot-Plug (" << serial_numbers[index] << "): " << ex.what() << std::endl;
+        detachSensor( index );
+        return false;
+    }
+}
+
+// Detach Camera from Slot
+inline void MultiRealSense::detachSensor( const size_t index )
+{
+    // Wait Processing of Camera (Task Refers to Camera)
+    if( pool ){
+        pool->wait( strands[index] );
+    }
+
+    // Clear Point Cloud and Tiles of Camera
+    if( enable_fusion ){
+        fusion.detach( index );
+    }
+    if( index < color_tiles.size() ){
+        color_tiles[index].setTo( cv::Scalar::all( 0 ) );
+        depth_tiles[index].setTo( cv::Scalar::all( 0 ) );
+    }
+
+    // Keep Clock Offset Measured while Recording (Re-Connected Camera is not Recorded, Its File would be Overwritten)
+    if( enable_record && index < session_manifest.devices.size() ){
+        session_manifest.devices[index].offset = realsenses[index]->getClockOffset();
+    }
+
+    // Release Camera to Hot-Plug (Pipeline is Stopped on Background Thread)
+    std::cout << "Hot-Plug (" << serial_numbers[index] << "): removed" << std::endl;
+    hotplug_manager->release( serial_numbers[index], std::move( realsenses[index] ) );
+}
+
+// Attach Arrived Camera to Slot
+inline void MultiRealSense::attachSensor( hotplug::arrival<RealSense>& arrival )
+{
+    // Slot of Same Device, or New Slot
+    const size_t index = std::find( serial_numbers.begin(), serial_numbers.end(), arrival.serial_number ) - serial_numbers.begin();
+    if( index == serial_numbers.size() ){
+        // Wait All Processing before Growing Containers that Tasks Refer to
+        if( pool ){
+            pool->wait_all();
+            strands.push_back( pool->create_strand() );
+            pool_latencies.emplace_back();
+        }
+        serial_numbers.push_back( arrival.serial_number );
+        realsenses.push_back( nullptr );
+        initializeMosaic();
+    }
+
+    realsenses[index] = std::move( arrival.device );
+    if( enable_fusion ){
+        fusion.attach( index, *realsenses[index] );
+    }
+    if( !pool ){
+        initializePool();
+    }
+
+    if( arrival.is_new ){
+        std::cout << "Hot-Plug (" << arrival.serial_number << "): added" << std::endl;
+        return;
+    }
+
+    // Report Reconnect Time
+    const hotplug::statistics statistics = hotplug_manager->get_statistics( arrival.serial_number );
+    std::cout << "Hot-Plug (" << arrival.serial_number << "): reconnected in " << std::fixed << std::setprecision( 1 ) << statistics.last << " ms"
+              << " (" << statistics.disconnects << " disconnects, mean " << statistics.total / std::max<uint32_t>( statistics.reconnects, 1 ) << " ms"
+              << ", max " << statistics.max << " ms)" << std::endl;
+    std::cout.unsetf( std::ios::floatfield );
+}
+
+// Create Camera of Device
+inline std::unique_ptr<RealSense> MultiRealSense::createSensor( const rs2::device& device ) const
+{
+    const std::string serial_number = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_SERIAL_NUMBER );
+    const std::string friendly_name = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_NAME );
+
+    // Re-Connected Device Uses Same Settings as Before
+    const std::map<std::string, RealSenseSettings>::const_iterator it = device_settings.find( serial_number );
+    if( it != device_settings.end() ){
+        return std::make_unique<RealSense>( serial_number, friendly_name, it->second );
+    }
+
+    RealSenseSettings settings;
+    if( enable_planner ){
+        // New Device is Planned Alone (Bandwidth of Other Devices on Same Controller is not Considered)
+        const profile_planner stream_planner( planner_options );
+        const std::vector<planner::plan> plans = stream_planner.plan( { device } );
+        std::cout << "Plan: " << profile_planner::describe( plans.front() ) << std::endl;
+        if( !plans.front().feasible ){
+            return nullptr;
+        }
+        settings = plans.front().settings();
+    }
+    settings.poll = enable_poll;
+    settings.pointcloud = enable_fusion;
+    return std::make_unique<RealSense>( serial_number, friendly_name, settings );
+}
+
+// Initialize Session Recording
+inline void MultiRealSense::initializeRecording()
+{
+    if( !enable_record ){
+        return;
+    }
+
+    // Start Recording of All Devices at Shared Session Start
+    session_manifest = session::manifest();
+    session_manifest.start = static_cast<int64_t>( session::now() );
+    for( std::unique_ptr<RealSense>& realsense : realsenses ){
+        const std::string file_name = realsense->getSerialNumber() + ".frames";
+        realsense->startRecording( file_name );
+        session_manifest.devices.push_back( { realsense->getSerialNumber(), file_name, 0.0 } );
+    }
+    std::cout << "Session: recording " << realsenses.size() << " devices to " << session_file_name << std::endl;
+}
+
+// Initialize Work-Stealing Pool
+inline void MultiRealSense::initializePool()
+{
+    if( !enable_pool || realsenses.empty() ){
+        return;
+    }
+
+    // Create Strand of Each Camera
+    pool.reset( new work_stealing_pool( pool_threads ) );
+    strands.clear();
+    for( size_t i = 0; i < realsenses.size(); i++ ){
+        strands.push_back( pool->create_strand() );
+    }
+    pool_latencies.assign( realsenses.size(), std::vector<double>() );
+    pool_report_time = std::chrono::steady_clock::now();
+    std::cout << "Pool: " << pool->size() << " threads, " << strands.size() << " cameras" << std::endl;
+}
+
+// Update Cameras and Submit Processing to Pool
+inline void MultiRealSense::updatePool()
+{
+    // Update Cameras whose Previous Frame is Processed (Processing Task is Only Accessor of Camera while Running)
+    bool submitted = false;
+    for( size_t i = 0; i < realsenses.size(); i++ ){
+        if( !realsenses[i] || !pool->is_idle( strands[i] ) ){
+            continue;
+        }
+
+        // Update Data
+        if( !updateSensor( i ) ){
+            continue;
+        }
+
+        // Submit Processing (Draw Data and Point Cloud) to Strand of Camera
+        const std::chrono::steady_clock::time_point submit_time = std::chrono::steady_clock::now();
+        pool->submit( strands[i], [this, i, submit_time](){
+            realsenses[i]->draw();
+            if( enable_fusion ){
+                fusion.transform( i, *realsenses[i] );
+            }
+            pool_latencies[i].push_back( std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - submit_time ).count() );
+        } );
+        submitted = true;
+    }
+
+    // Yield to Workers while All Cameras are Processing
+    if( !submitted ){
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    // Report Latency Fairness
+    if( std::chrono::steady_clock::now() - pool_report_time >= pool_report_interval ){
+        reportPool();
+    }
+}
+
+// Report Latency Fairness of Pool
+inline void MultiRealSense::reportPool()
+{
+    // Wait Processing of All Cameras before Reading Latencies
+    pool->wait_all();
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - pool_report_time ).count();
+
+    // Latency of Each Camera, and Jain's Fairness Index of Mean Latencies (1.0 is Perfectly Fair)
+    double sum = 0.0, square_sum = 0.0;
+    for( size_t i = 0; i < realsenses.size(); i++ ){
+        std::vector<double>& latencies = pool_latencies[i];
+        std::sort( latencies.begin(), latencies.end() );
+        const double mean = latencies.empty() ? 0.0 : std::accumulate( latencies.begin(), latencies.end(), 0.0 ) / latencies.size();
+        sum += mean;
+        square_sum += mean * mean;
+
+        std::cout << "Pool (" << serial_numbers[i] << "): "
+                  << std::fixed << std::setprecision( 1 ) << latencies.size() / seconds << " fps"
+                  << ", latency mean " << std::setprecision( 2 ) << mean << " ms"
+                  << " p99 " << percentile( latencies, 0.99 ) << " ms" << std::endl;
+        latencies.clear();
+    }
+
+    const double fairness = square_sum > 0.0 ? sum * sum / ( realsenses.size() * square_sum ) : 1.0;
+    std::cout << "Pool: fairness " << std::setprecision( 3 ) << fairness
+              << ", " << pool->executed_tasks() << " tasks, " << pool->stolen_tasks() << " stolen" << std::endl;
+    std::cout.unsetf( std::ios::floatfield );
+    pool_report_time = std::chrono::steady_clock::now();
+}
+
+// Save Fused Point Cloud
+inline void MultiRealSense::saveFusion()
+{
+    if( !enable_fusion ){
+        return;
+    }
+
+    // Wait Processing of All Cameras and Concatenate Their Point Clouds
+    if( pool ){
+        pool->wait_all();
+        fusion.concatenate();
+        fusion.report( realsenses.size() );
+    }
+
+    try{
+        fusion.save( fusion_file_name );
+    }
+    catch( const std::exception& ex ){
+        std::cout << ex.what() << std::endl;
+    }
+}
+
+// Show Mosaic
+inline void MultiRealSense::showMosaic()
+{
+    // Mosaic is not Composed without Preview (Processing Throughput does not Depend on Preview Window)
+    if( mosaic_mat.empty() || !renderer || !renderer->is_open() ){
+        return;
+    }
+
+    // Compose at Render Rate (Mosaic Composed Faster than Render Thread Shows It is Dropped)
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if( now - preview_time < std::chrono::duration<double>( 1.0 / preview_max_fps ) ){
+        return;
+    }
+    preview_time = now;
+
+    // Wait Processing of All Cameras before Reading Their Data
+    if( pool ){
+        pool->wait_all();
+        if( enable_fusion ){
+            fusion.concatenate();
+            fusion.report( realsenses.size() );
+        }
+    }
+
+    // Compose Data into Mosaic Tiles
+    for( size_t i = 0; i < realsenses.size(); i++ ){
+        if( realsenses[i] ){
+            realsenses[i]->compose( color_tiles[i], depth_tiles[i] );
+        }
+    }
+
+    // Publish Mosaic Image to Render Thread (Never Blocks)
+    renderer->publish( mosaic_mat );
+}
+
+// Run Session Playback
+inline void MultiRealSense::runPlayback()
+{
+    // Main Loop (Until End of Any File)
+    while( player->next( playback_framesets ) ){
+        if( renderer && renderer->is_open() ){
+            // Compose Aligned Framesets into Mosaic Tiles
+            for( size_t i = 0; i < playback_framesets.size(); i++ ){
+                composePlayback( playback_framesets[i], color_tiles[i], depth_tiles[i] );
+            }
+
+            // Publish Mosaic Image to Render Thread (Never Blocks)
+            renderer->publish( mosaic_mat );
+        }
+
+        // Key Check
+        const int32_t key = checkKey();
+        if( key == 'q' ){
+            break;
+        }
+    }
+
+    std::cout << "Session: " << player->delivered_framesets() << " aligned framesets, " << player->dropped_framesets() << " framesets dropped to align" << std::endl;
+}
+
+// Compose Playback Frameset into Mosaic Tiles
+inline void MultiRealSense::composePlayback( const session::frameset& frameset, cv::Mat& color_tile, cv::Mat& depth_tile )
+{
+    // Compose Color (Convert to BGR by Format of Recorded Frame before Resize)
+    if( !frameset.color.image.empty() ){
+        cv::Mat color_mat;
+        switch( frameset.color.header.format ){
+            case RS2_FORMAT_YUYV:
+                cv::cvtColor( frameset.color.image, color_mat, cv::COLOR_YUV2BGR_YUYV );
+                break;
+            case RS2_FORMAT_UYVY:
+                cv::cvtColor( frameset.color.image, color_mat, cv::COLOR_YUV2BGR_UYVY );
+                break;
+            case RS2_FORMAT_RGB8:
+                cv::cvtColor( frameset.color.image, color_mat, cv::COLOR_RGB2BGR );
+                break;
+            case RS2_FORMAT_BGR8:
+                color_mat = frameset.color.image;
+                break;
+            default:
+                break;
+        }
+        if( !color_mat.empty() ){
+            cv::resize( color_mat, color_tile, color_tile.size(), 0.0, 0.0, cv::INTER_NEAREST );
+        }
+    }
+
+    // Compose Depth
+    if( !frameset.depth.image.empty() ){
+        cv::Mat scale_mat;
+        cv::resize( frameset.depth.image, scale_mat, depth_tile.size(), 0.0, 0.0, cv::INTER_NEAREST );
+        scale_mat.convertTo( scale_mat, CV_8U, -255.0 / 10000.0, 255.0 ); // 0-10000 -> 255(white)-0(black)
+        cv::cvtColor( scale_mat, depth_tile, cv::COLOR_GRAY2BGR );
+    }
+}
+
+// Finalize Session Recording
+inline void MultiRealSense::finalizeRecording()
+{
+    if( !enable_record ){
+        return;
+    }
+
+    // Write Queued Frames of All Devices
+    for( std::unique_ptr<RealSense>& realsense : realsenses ){
+        if( realsense ){
+            realsense->stopRecording();
+        }
+    }
+
+    // Write Manifest with Clock Offsets Measured while Recording (Offset of Removed Device is Kept when Detached)
+    for( size_t i = 0; i < session_manifest.devices.size(); i++ ){
+        if( realsenses[i] ){
+            session_manifest.devices[i].offset = realsenses[i]->getClockOffset();
+        }
+    }
+    session::write( session_file_name, session_manifest );
+    std::cout << "Session: manifest is written to " << session_file_name << std::endl;
+}
+
+// Run Scaling Benchmark
+inline void MultiRealSense::runBenchmark()
+{
+#ifndef SYNTHETIC
+    if( benchmark_files.empty() ){
+        throw std::runtime_error( "scaling benchmark requires recorded files without synthetic device" );
+    }
+#endif
+
+    std::ofstream ofs( benchmark_file_name );
+    if( !ofs.is_open() ){
+        throw std::runtime_error( "failed to open " + benchmark_file_name );
+    }
+    ofs << "cameras,serial_number,fps,latency_p50,latency_p95,latency_p99,cpu,memory\n";
+
+    // Increase Number of Cameras
+    uint32_t sustained = 0;
+    for( const uint32_t cameras : benchmark_cameras ){
+        if( benchmark( cameras, ofs ) ){
+            sustained = std::max( sustained, cameras );
+        }
+    }
+
+    std::cout << "Scaling: " << sustained << " cameras sustained "
+              << benchmark_settings.width << "x" << benchmark_settings.height << " " << benchmark_settings.fps << " fps" << std::endl;
+    std::cout << "Scaling: result is written to " << benchmark_file_name << std::endl;
+}
+
+// Benchmark Number of Cameras
+inline bool MultiRealSense::benchmark( const uint32_t cameras, std::ofstream& ofs )
+{
+    // Create Cameras through Same Wrapper as Live Devices
+    realsenses.clear();
+    for( uint32_t i = 0; i < cameras; i++ ){
+        RealSenseSettings settings = benchmark_settings;
+        settings.pointcloud = false; // point cloud is not calculated in benchmark
+        char serial_number[32];
+#ifdef SYNTHETIC
+        std::snprintf( serial_number, sizeof( serial_number ), "SYNTHETIC-%04u", i );
+        if( benchmark_files.empty() ){
+            realsenses.push_back( std::make_unique<RealSense>( serial_number, "Synthetic Device", settings ) );
+            continue;
+        }
+#endif
+        std::snprintf( serial_number, sizeof( serial_number ), "RECORDED-%04u", i );
+        settings.file_name = benchmark_files[i % benchmark_files.size()];
+        realsenses.push_back( std::make_unique<RealSense>( serial_number, "Recorded Device", settings ) );
+    }
+
+    // Warm-Up
+    drive( benchmark_warmup );
+
+    // Measure
+    for( std::unique_ptr<RealSense>& realsense : realsenses ){
+        realsense->resetStatistics();
+    }
+    process_usage usage;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    drive( benchmark_duration );
+    const double wall = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    const double cpu = usage.cpu_usage();
+    const double memory = process_usage::memory() / ( 1024.0 * 1024.0 );
+
+    // Report Each Camera
+    bool sustained = true;
+    double minimum_fps = std::numeric_limits<double>::max();
+    std::vector<double> all_latencies;
+    ofs << std::fixed << std::setprecision( 3 );
+    for( std::unique_ptr<RealSense>& realsense : realsenses ){
+        const double fps = realsense->getFrames() / wall;
+        std::vector<double> latencies = realsense->getLatencies();
+        std::sort( latencies.begin(), latencies.end() );
+        all_latencies.insert( all_latencies.end(), latencies.begin(), latencies.end() );
+        minimum_fps = std::min( minimum_fps, fps );
+        sustained = sustained && fps >= benchmark_settings.fps * benchmark_sustained_rate;
+
+        ofs << cameras << "," << realsense->getSerialNumber() << "," << fps << ","
+            << percentile( latencies, 0.5 ) << "," << percentile( latencies, 0.95 ) << "," << percentile( latencies, 0.99 ) << ","
+            << cpu << "," << memory << "\n";
+    }
+    ofs.flush();
+
+    // Report Summary
+    std::sort( all_latencies.begin(), all_latencies.end() );
+    std::cout << "Scaling: " << std::setw( 3 ) << cameras << " cameras"
+              << ", min " << std::fixed << std::setprecision( 1 ) << minimum_fps << " fps"
+              << ", latency p50 " << percentile( all_latencies, 0.5 ) << " ms"
+              << " p95 " << percentile( all_latencies, 0.95 ) << " ms"
+              << " p99 " << percentile( all_latencies, 0.99 ) << " ms"
+              << ", cpu " << cpu << " %"
+              << ", memory " << memory << " MB"
+              << ( sustained ? "" : " (not sustained)" ) << std::endl;
+
+    // Release Cameras before Next Step
+    realsenses.clear();
+    return sustained;
+}
+
+// Drive Cameras for Seconds
+inline void MultiRealSense::drive( const double seconds )
+{
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( seconds ) );
+    while( std::chrono::steady_clock::now() < end ){
+        for( std::unique_ptr<RealSense>& realsense : realsenses ){
+            // Update Data
+            realsense->update();
+
+            // Draw Data
+            realsense->draw();
+        }
+    }
 }
 
 // Finalize
 void MultiRealSense::finalize()
 {
+    // Stop Hot-Plug Thread before Members it Uses (Device Settings) are Destroyed
+    hotplug_manager.reset();
+
+    // Wait Processing Tasks (Exception of Task is not Thrown from Destructor)
+    if( pool ){
+        try{
+            pool->wait_all();
+        }
+        catch( const std::exception& ex ){
+            std::cout << ex.what() << std::endl;
+        }
+    }
+
+    // Stop Preview Renderer
+    if( renderer ){
+        std::cout << "Preview: " << renderer->published_frames() << " published, " << renderer->rendered_frames() << " rendered, " << renderer->dropped_frames() << " dropped" << std::endl;
+        renderer.reset();
+    }
+
     // Close Windows
     cv::destroyAllWindows();
+
+    // Finalize Session Recording
+    finalizeRecording();
 }
\ No newline at end of file
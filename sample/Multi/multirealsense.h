@@ -2,12 +2,23 @@
 #define __MULTIREALSENSE__
 
 #include "realsense.h"
+#include "fusion.h"
+#include "session.h"
+#include "process_usage.h"
+#include "work_stealing_pool.h"
+#include "profile_planner.h"
+#include "device_hotplug.h"
+#include "preview_renderer.h"
 
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <map>
 
 class MultiRealSense
 {
@@ -15,6 +26,79 @@ private:
     // RealSense
     std::vector<std::unique_ptr<RealSense>> realsenses;
 
+#ifdef SYNTHETIC
+    // Number of Synthetic Sensors
+    uint32_t synthetic_cameras = 4;
+#endif
+
+    // Poll Mode (Cameras are Polled without Blocking, Watchdog Restarts Pipeline of Stalled Camera)
+    bool enable_poll = true;
+
+    // Stream Profile Planner (Best Profile of Each Device within Bandwidth of USB Controller, Staggered Start)
+    bool enable_planner = true;
+    planner::options planner_options;
+    std::chrono::milliseconds stagger_interval = std::chrono::milliseconds( 500 );
+
+    // Hot-Plug (Removed and Re-Connected Devices are Swapped Out and In on Background Thread, Other Cameras Keep Streaming)
+    // Slot of removed device is empty (nullptr) until same device is re-connected, new device is added to new slot.
+    bool enable_hotplug = true;
+    hotplug::options hotplug_options;
+    std::unique_ptr<device_hotplug<RealSense>> hotplug_manager;
+    std::vector<std::string> serial_numbers; // serial number of each slot
+    std::map<std::string, RealSenseSettings> device_settings; // settings of each device (planned at initialize)
+    std::vector<std::string> removed_devices;
+    std::vector<hotplug::arrival<RealSense>> arrived_devices;
+
+    // Mosaic Buffer
+    cv::Mat mosaic_mat;
+    std::vector<cv::Mat> color_tiles;
+    std::vector<cv::Mat> depth_tiles;
+    uint32_t tile_width = 320;
+    uint32_t tile_height = 240;
+    const std::string mosaic_window_name = "MultiRealSense";
+
+    // Preview Renderer (Render Thread Shows Latest Published Mosaic, Processing is not Blocked by Rendering)
+    bool enable_preview = true;
+    double preview_max_fps = 30.0; // cap of render rate (mosaic is also composed at this rate)
+    std::chrono::steady_clock::time_point preview_time;
+    std::unique_ptr<preview_renderer> renderer;
+
+    // Point Cloud Fusion
+    PointCloudFusion fusion;
+    bool enable_fusion = true;
+    std::string fusion_file_name = "fusion.ply"; // saved when pressed 's' key
+    std::vector<size_t> updated_sensors; // cameras updated in this pass of main loop (without pool)
+
+    // Work-Stealing Pool (Per-Frame Processing of All Cameras, One Strand per Camera Keeps Order of Frames)
+    bool enable_pool = true;
+    uint32_t pool_threads = 0; // 0 is Number of Hardware Threads
+    std::unique_ptr<work_stealing_pool> pool;
+    std::vector<size_t> strands;
+    std::vector<std::vector<double>> pool_latencies; // milliseconds from submit to processed
+    std::chrono::seconds pool_report_interval = std::chrono::seconds( 5 );
+    std::chrono::steady_clock::time_point pool_report_time;
+
+    // Session Recording (Each Device Records to Its Own File, Manifest has Session Start and Clock Offsets)
+    bool enable_record = false;
+    std::string session_file_name = "session.csv";
+    session::manifest session_manifest;
+
+    // Session Playback (Deliver Aligned Framesets of All Devices from Recorded Session)
+    bool enable_playback = false;
+    session::options playback_options;
+    std::unique_ptr<session_player> player;
+    std::vector<session::frameset> playback_framesets;
+
+    // Scaling Benchmark (Drive N Synthetic or Recorded Devices through RealSense and Report Scaling Curve)
+    bool enable_scaling_benchmark = false;
+    std::vector<uint32_t> benchmark_cameras = { 1, 2, 4, 8, 12, 16 };
+    RealSenseSettings benchmark_settings; // target resolution and fps
+    std::vector<std::string> benchmark_files; // recorded files (.bag) used in turn (required without synthetic device)
+    double benchmark_warmup = 2.0; // seconds
+    double benchmark_duration = 10.0; // seconds
+    double benchmark_sustained_rate = 0.9; // rate of target fps that is regarded as sustained
+    std::string benchmark_file_name = "scaling.csv";
+
 public:
     // Constructor
     MultiRealSense();
@@ -30,7 +114,73 @@ private:
     void initialize();
 
     // Initialize Sensor
-    inline void initializeSensor( const rs2::device& device );
+    inline void initializeSensor( const rs2::device& device, const RealSenseSettings& settings = RealSenseSettings() );
+
+    // Initialize Sensors by Stream Profile Planner
+    inline void initializePlannedSensors( const std::vector<rs2::device>& devices );
+
+    // Initialize Mosaic
+    inline void initializeMosaic();
+
+    // Initialize Preview Renderer
+    inline void initializePreview();
+
+    // Retrieve Key Pressed in Preview Window (-1 is No Key)
+    inline int32_t checkKey();
+
+    // Initialize Hot-Plug
+    inline void initializeHotplug();
+
+    // Swap Removed and Arrived Devices
+    inline void updateHotplug();
+
+    // Update Camera (Camera that Failed is Detached and Re-Connected by Hot-Plug)
+    inline bool updateSensor( const size_t index );
+
+    // Detach Camera from Slot (Stopped on Background Thread)
+    inline void detachSensor( const size_t index );
+
+    // Attach Arrived Camera to Slot
+    inline void attachSensor( hotplug::arrival<RealSense>& arrival );
+
+    // Create Camera of Device (Background Thread of Hot-Plug)
+    inline std::unique_ptr<RealSense> createSensor( const rs2::device& device ) const;
+
+    // Initialize Session Recording
+    inline void initializeRecording();
+
+    // Initialize Work-Stealing Pool
+    inline void initializePool();
+
+    // Update Cameras and Submit Processing to Pool
+    inline void updatePool();
+
+    // Report Latency Fairness of Pool
+    inline void reportPool();
+
+    // Show Mosaic
+    inline void showMosaic();
+
+    // Save Fused Point Cloud
+    inline void saveFusion();
+
+    // Run Session Playback
+    inline void runPlayback();
+
+    // Compose Playback Frameset into Mosaic Tiles
+    inline void composePlayback( const session::frameset& frameset, cv::Mat& color_tile, cv::Mat& depth_tile );
+
+    // Finalize Session Recording
+    inline void finalizeRecording();
+
+    // Run Scaling Benchmark
+    inline void runBenchmark();
+
+    // Benchmark Number of Cameras (Return true if All Cameras Sustained Target fps)
+    inline bool benchmark( const uint32_t cameras, std::ofstream& ofs );
+
+    // Drive Cameras for Seconds
+    inline void drive( const double seconds );
 
     // Finalize
     void finalize();
@@ -0,0 +1,199 @@
+// This is minimum implementation of decoupled preview renderer.
+// Processing publishes latest image into triple buffer without blocking, and render thread shows latest published image at capped rate.
+// Image that is published again before render thread reads it is dropped (stale), so render thread always shows freshest image.
+// Window (imshow and waitKey) is owned by render thread, and key pressed in window is passed to processing through key().
+
+#ifndef __PREVIEW_RENDERER__
+#define __PREVIEW_RENDERER__
+
+#include <opencv2/opencv.hpp>
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Triple Buffer (Single Producer and Single Consumer, Lock-Free)
+// Producer writes back buffer and swaps it with middle buffer, consumer swaps front buffer with middle buffer only if middle buffer is fresh.
+template<typename T>
+class triple_buffer
+{
+private:
+    static const uint8_t index_mask = 0x03;
+    static const uint8_t fresh = 0x04;
+
+    T buffers[3];
+    std::atomic<uint8_t> middle; // index of middle buffer (with fresh bit)
+    uint8_t back = 0; // producer only
+    uint8_t front = 1; // consumer only
+
+public:
+    triple_buffer()
+        : middle( 2 )
+    {
+    }
+
+    triple_buffer( const triple_buffer& ) = delete;
+    triple_buffer& operator=( const triple_buffer& ) = delete;
+
+    // Back Buffer (Producer)
+    T& back_buffer()
+    {
+        return buffers[back];
+    }
+
+    // Publish Back Buffer (Producer, Return false if Previous Published Buffer is Dropped without Read)
+    bool publish()
+    {
+        const uint8_t previous = middle.exchange( static_cast<uint8_t>( back | fresh ) );
+        back = previous & index_mask;
+        return !( previous & fresh );
+    }
+
+    // Acquire Latest Published Buffer as Front Buffer (Consumer, Return false if Nothing is Published since Last Acquire)
+    bool acquire()
+    {
+        if( !( middle.load() & fresh ) ){
+            return false;
+        }
+        const uint8_t previous = middle.exchange( front );
+        front = previous & index_mask;
+        return true;
+    }
+
+    // Front Buffer (Consumer)
+    T& front_buffer()
+    {
+        return buffers[front];
+    }
+};
+
+namespace preview
+{
+    // Options
+    struct options
+    {
+        std::string window_name = "Preview";
+        double max_fps = 30.0; // cap of render rate
+    };
+}
+
+class preview_renderer
+{
+private:
+    preview::options option;
+    triple_buffer<cv::Mat> buffer;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<bool> open;
+    std::atomic<int32_t> pressed;
+
+    // Statistics
+    std::atomic<uint64_t> published;
+    std::atomic<uint64_t> rendered;
+    std::atomic<uint64_t> dropped;
+
+public:
+    explicit preview_renderer( const preview::options& option = preview::options() )
+        : option( option )
+        , running( true )
+        , open( true )
+        , pressed( -1 )
+        , published( 0 )
+        , rendered( 0 )
+        , dropped( 0 )
+    {
+        thread = std::thread( &preview_renderer::run, this );
+    }
+
+    ~preview_renderer()
+    {
+        running = false;
+        thread.join();
+    }
+
+    preview_renderer( const preview_renderer& ) = delete;
+    preview_renderer& operator=( const preview_renderer& ) = delete;
+
+    // Publish Image (Copied into Back Buffer, Never Blocks)
+    void publish( const cv::Mat& image )
+    {
+        image.copyTo( buffer.back_buffer() );
+        if( !buffer.publish() ){
+            dropped++;
+        }
+        published++;
+    }
+
+    // Key Pressed in Window since Last Call (-1 is No Key)
+    int32_t key()
+    {
+        return pressed.exchange( -1 );
+    }
+
+    // Window is Open (Publishing is Unnecessary after Window is Closed)
+    bool is_open() const
+    {
+        return open;
+    }
+
+    uint64_t published_frames() const
+    {
+        return published;
+    }
+
+    uint64_t rendered_frames() const
+    {
+        return rendered;
+    }
+
+    uint64_t dropped_frames() const
+    {
+        return dropped;
+    }
+
+private:
+    // Render Thread
+    void run()
+    {
+        const std::chrono::steady_clock::duration interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( 1.0 / option.max_fps ) );
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+        bool shown = false;
+
+        cv::namedWindow( option.window_name, cv::WINDOW_AUTOSIZE );
+        while( running ){
+            // Show Latest Published Image
+            if( buffer.acquire() && !buffer.front_buffer().empty() ){
+                cv::imshow( option.window_name, buffer.front_buffer() );
+                rendered++;
+                shown = true;
+            }
+
+            // Process Window Events and Key
+            const int32_t key = cv::waitKey( 1 );
+            if( key >= 0 ){
+                pressed = key;
+            }
+
+            // Window is Closed by User
+            if( shown && cv::getWindowProperty( option.window_name, cv::WND_PROP_VISIBLE ) < 1.0 ){
+                open = false;
+                return;
+            }
+
+            // Cap Render Rate (Skip Intervals that are Behind)
+            next += interval;
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if( next < now ){
+                next = now;
+            }
+            std::this_thread::sleep_until( next );
+        }
+
+        cv::destroyWindow( option.window_name );
+        open = false;
+    }
+};
+
+#endif // __PREVIEW_RENDERER__
\ No newline at end of file
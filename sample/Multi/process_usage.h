@@ -0,0 +1,98 @@
+// This is minimum implementation of CPU and memory usage of current process.
+// CPU time is user + kernel time of all threads, and memory is resident set size (working set on Windows).
+// CPU usage between two samples is CPU time / wall time, 100% is one core fully used.
+
+#ifndef __PROCESS_USAGE__
+#define __PROCESS_USAGE__
+
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+class process_usage
+{
+private:
+    std::chrono::steady_clock::time_point wall_time;
+    double cpu_time = 0.0;
+
+public:
+    process_usage()
+    {
+        reset();
+    }
+
+    // Start New Interval
+    void reset()
+    {
+        wall_time = std::chrono::steady_clock::now();
+        cpu_time = cpu();
+    }
+
+    // CPU Usage since Reset (Percent of One Core)
+    double cpu_usage() const
+    {
+        const double wall = std::chrono::duration<double>( std::chrono::steady_clock::now() - wall_time ).count();
+        return wall > 0.0 ? ( cpu() - cpu_time ) / wall * 100.0 : 0.0;
+    }
+
+    // Resident Memory (Bytes)
+    static uint64_t memory()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) ){
+            return 0;
+        }
+        return static_cast<uint64_t>( counters.WorkingSetSize );
+#else
+        // Second Field of /proc/self/statm is Resident Pages (Linux)
+        std::ifstream statm( "/proc/self/statm" );
+        uint64_t size = 0, resident = 0;
+        if( statm >> size >> resident ){
+            return resident * static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+        }
+
+        // Peak Resident Memory on Other Platforms (Kilobytes on Linux and BSD, Bytes on macOS)
+        struct rusage usage;
+        getrusage( RUSAGE_SELF, &usage );
+#ifdef __APPLE__
+        return static_cast<uint64_t>( usage.ru_maxrss );
+#else
+        return static_cast<uint64_t>( usage.ru_maxrss ) * 1024;
+#endif
+#endif
+    }
+
+private:
+    // CPU Time of Process (Seconds)
+    static double cpu()
+    {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        if( !GetProcessTimes( GetCurrentProcess(), &creation, &exit, &kernel, &user ) ){
+            return 0.0;
+        }
+        auto seconds = []( const FILETIME& time ){
+            return ( ( static_cast<uint64_t>( time.dwHighDateTime ) << 32 ) | time.dwLowDateTime ) * 1e-7; // 100 ns
+        };
+        return seconds( kernel ) + seconds( user );
+#else
+        struct rusage usage;
+        getrusage( RUSAGE_SELF, &usage );
+        return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#endif
+    }
+};
+
+#endif // __PROCESS_USAGE__
\ No newline at end of file
@@ -0,0 +1,273 @@
+// This is minimum implementation of bandwidth-budgeted stream profile planner for multiple devices.
+// Planner enumerates stream profiles that each device supports (color and depth at same resolution and frame rate), and groups devices by USB controller.
+// Each device starts from its best profile, and while total bandwidth of controller is over budget, device that uses most bandwidth steps down to next profile.
+// Bandwidth is budgeted by transport format (BGR8/RGB8 are transported as YUYV and converted on host), so they cost same as YUYV on USB.
+// YUYV is preferred over BGR8 because conversion on host is skipped, and devices are started in staggered order across controllers.
+
+#ifndef __PROFILE_PLANNER__
+#define __PROFILE_PLANNER__
+
+#include <librealsense2/rs.hpp>
+
+#include "realsense.h"
+
+#include <vector>
+#include <map>
+#include <set>
+#include <tuple>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+namespace planner
+{
+    // Options
+    struct options
+    {
+        double usb3_bandwidth = 320.0 * 1024.0 * 1024.0; // bytes per second of USB 3 controller (practical)
+        double usb2_bandwidth = 30.0 * 1024.0 * 1024.0; // bytes per second of USB 2 controller (practical)
+        double headroom = 0.8; // rate of bandwidth that is planned
+        uint32_t min_fps = 15; // profiles under this frame rate are not planned
+        uint32_t max_width = 1280; // profiles over this resolution are not planned
+        std::vector<rs2_format> color_formats = { RS2_FORMAT_YUYV, RS2_FORMAT_BGR8 }; // in order of preference
+    };
+
+    // Profile of Device (Color and Depth at Same Resolution and Frame Rate)
+    struct profile
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t fps;
+        rs2_format color_format;
+        double bandwidth; // bytes per second
+    };
+
+    // Plan of Device
+    struct plan
+    {
+        rs2::device device;
+        std::string serial_number;
+        std::string friendly_name;
+        std::string controller;
+        std::vector<profile> profiles; // candidates in order of quality
+        size_t selected = 0;
+        bool feasible = true;
+
+        const profile& get() const
+        {
+            return profiles[selected];
+        }
+
+        RealSenseSettings settings() const
+        {
+            RealSenseSettings settings;
+            settings.width = get().width;
+            settings.height = get().height;
+            settings.fps = get().fps;
+            settings.color_format = get().color_format;
+            return settings;
+        }
+    };
+
+    // Bytes per Pixel of Format on USB (Transport Format)
+    // D400 transports color as YUYV and converts it to RGB8/BGR8/RGBA8/BGRA8 on host, so they use same bandwidth as YUYV.
+    inline uint32_t bytes_per_pixel( const rs2_format format )
+    {
+        switch( format ){
+            case RS2_FORMAT_Y8:
+            case RS2_FORMAT_RAW8:
+                return 1;
+            default:
+                return 2; // Z16, YUYV, UYVY, and RGB8/BGR8/RGBA8/BGRA8 (transported as YUYV)
+        }
+    }
+}
+
+class profile_planner
+{
+private:
+    planner::options option;
+
+public:
+    explicit profile_planner( const planner::options& option = planner::options() )
+        : option( option )
+    {
+    }
+
+    // Plan Profiles of Devices (Plans are in Order to Start)
+    std::vector<planner::plan> plan( const std::vector<rs2::device>& devices ) const
+    {
+        // Enumerate Profiles of Each Device
+        std::vector<planner::plan> plans;
+        for( const rs2::device& device : devices ){
+            planner::plan plan;
+            plan.device = device;
+            plan.serial_number = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_SERIAL_NUMBER );
+            plan.friendly_name = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_NAME );
+            plan.controller = controller( device );
+            plan.profiles = enumerate( device );
+            if( plan.profiles.empty() ){
+                throw std::runtime_error( "no profile of color and depth is found in " + plan.serial_number );
+            }
+            plans.push_back( plan );
+        }
+
+        // Step Down Device that Uses Most Bandwidth until Controller is within Budget
+        std::map<std::string, std::vector<planner::plan*>> controllers;
+        for( planner::plan& plan : plans ){
+            controllers[plan.controller].push_back( &plan );
+        }
+        for( std::pair<const std::string, std::vector<planner::plan*>>& controller : controllers ){
+            const double budget = this->budget( *controller.second.front() );
+            while( true ){
+                double total = 0.0;
+                planner::plan* largest = nullptr;
+                for( planner::plan* plan : controller.second ){
+                    if( !plan->feasible ){
+                        continue;
+                    }
+                    total += plan->get().bandwidth;
+                    if( !largest || plan->get().bandwidth > largest->get().bandwidth ){
+                        largest = plan;
+                    }
+                }
+                if( total <= budget || !largest ){
+                    break;
+                }
+
+                // Next Profile that Uses Less Bandwidth (Device is Disabled if There is No Such Profile)
+                size_t next = largest->selected + 1;
+                while( next < largest->profiles.size() && largest->profiles[next].bandwidth >= largest->get().bandwidth ){
+                    next++;
+                }
+                if( next < largest->profiles.size() ){
+                    largest->selected = next;
+                }
+                else{
+                    largest->feasible = false;
+                }
+            }
+        }
+
+        // Staggered Order (Round Robin across Controllers, Successive Starts Hit Different Controllers)
+        std::vector<planner::plan> ordered;
+        for( size_t round = 0; ordered.size() < plans.size(); round++ ){
+            for( std::pair<const std::string, std::vector<planner::plan*>>& controller : controllers ){
+                if( round < controller.second.size() ){
+                    ordered.push_back( *controller.second[round] );
+                }
+            }
+        }
+        return ordered;
+    }
+
+    // Describe Plan
+    static std::string describe( const planner::plan& plan )
+    {
+        std::ostringstream oss;
+        oss << plan.friendly_name << " (" << plan.serial_number << ") on " << plan.controller << " : ";
+        if( !plan.feasible ){
+            oss << "not started (over bandwidth)";
+            return oss.str();
+        }
+        const planner::profile& profile = plan.get();
+        oss << profile.width << "x" << profile.height << " " << profile.fps << " fps " << rs2_format_to_string( profile.color_format )
+            << ", " << profile.bandwidth / ( 1024.0 * 1024.0 ) << " MB/s";
+        return oss.str();
+    }
+
+private:
+    // Controller of Device
+    // Physical port is sysfs path on Linux (e.g. /sys/devices/pci0000:00/0000:00:14.0/usb2/2-1/...), controller is path before "/usb".
+    // Devices whose controller is unknown (e.g. Windows) are regarded as on same controller.
+    std::string controller( const rs2::device& device ) const
+    {
+        std::string usb_type = "3";
+        if( device.supports( rs2_camera_info::RS2_CAMERA_INFO_USB_TYPE_DESCRIPTOR ) ){
+            usb_type = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_USB_TYPE_DESCRIPTOR );
+        }
+
+        std::string port = "default";
+        if( device.supports( rs2_camera_info::RS2_CAMERA_INFO_PHYSICAL_PORT ) ){
+            const std::string physical_port = device.get_info( rs2_camera_info::RS2_CAMERA_INFO_PHYSICAL_PORT );
+            const size_t position = physical_port.find( "/usb" );
+            if( position != std::string::npos ){
+                port = physical_port.substr( 0, position );
+            }
+        }
+
+        // USB 2 and USB 3 are Separate Buses of Controller
+        return port + " (USB " + usb_type + ")";
+    }
+
+    // Budget of Controller
+    double budget( const planner::plan& plan ) const
+    {
+        const bool usb2 = plan.controller.find( "(USB 2" ) != std::string::npos;
+        return ( usb2 ? option.usb2_bandwidth : option.usb3_bandwidth ) * option.headroom;
+    }
+
+    // Enumerate Profiles that Color and Depth are Supported at Same Resolution and Frame Rate (in Order of Quality)
+    std::vector<planner::profile> enumerate( const rs2::device& device ) const
+    {
+        std::set<std::tuple<uint32_t, uint32_t, uint32_t>> depth_modes;
+        std::set<std::tuple<uint32_t, uint32_t, uint32_t, rs2_format>> color_modes;
+        for( const rs2::sensor& sensor : device.query_sensors() ){
+            for( const rs2::stream_profile& stream_profile : sensor.get_stream_profiles() ){
+                if( !stream_profile.is<rs2::video_stream_profile>() ){
+                    continue;
+                }
+
+                const rs2::video_stream_profile video_profile = stream_profile.as<rs2::video_stream_profile>();
+                const uint32_t width = static_cast<uint32_t>( video_profile.width() );
+                const uint32_t height = static_cast<uint32_t>( video_profile.height() );
+                const uint32_t fps = static_cast<uint32_t>( video_profile.fps() );
+                if( fps < option.min_fps || width > option.max_width ){
+                    continue;
+                }
+
+                if( video_profile.stream_type() == rs2_stream::RS2_STREAM_DEPTH && video_profile.format() == rs2_format::RS2_FORMAT_Z16 ){
+                    depth_modes.insert( std::make_tuple( width, height, fps ) );
+                }
+                else if( video_profile.stream_type() == rs2_stream::RS2_STREAM_COLOR ){
+                    color_modes.insert( std::make_tuple( width, height, fps, video_profile.format() ) );
+                }
+            }
+        }
+
+        std::vector<planner::profile> profiles;
+        for( const std::tuple<uint32_t, uint32_t, uint32_t>& depth_mode : depth_modes ){
+            for( const rs2_format format : option.color_formats ){
+                const uint32_t width = std::get<0>( depth_mode );
+                const uint32_t height = std::get<1>( depth_mode );
+                const uint32_t fps = std::get<2>( depth_mode );
+                if( !color_modes.count( std::make_tuple( width, height, fps, format ) ) ){
+                    continue;
+                }
+
+                const double pixels = static_cast<double>( width ) * height * fps;
+                profiles.push_back( { width, height, fps, format, pixels * ( planner::bytes_per_pixel( RS2_FORMAT_Z16 ) + planner::bytes_per_pixel( format ) ) } );
+            }
+        }
+
+        // Order of Quality (Pixels per Second, then Preference of Format)
+        std::stable_sort( profiles.begin(), profiles.end(), [this]( const planner::profile& a, const planner::profile& b ){
+            const double a_pixels = static_cast<double>( a.width ) * a.height * a.fps;
+            const double b_pixels = static_cast<double>( b.width ) * b.height * b.fps;
+            if( a_pixels != b_pixels ){
+                return a_pixels > b_pixels;
+            }
+            return preference( a.color_format ) < preference( b.color_format );
+        } );
+        return profiles;
+    }
+
+    size_t preference( const rs2_format format ) const
+    {
+        return std::find( option.color_formats.begin(), option.color_formats.end(), format ) - option.color_formats.begin();
+    }
+};
+
+#endif // __PROFILE_PLANNER__
\ No newline at end of file
@@ -1,9 +1,34 @@
 #include "realsense.h"
 
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <stdexcept>
+
 // Constructor
-RealSense::RealSense( const std::string serial_number, const std::string friendly_name )
+RealSense::RealSense( const std::string serial_number, const std::string friendly_name, const RealSenseSettings& settings )
     : serial_number( serial_number )
     , friendly_name( friendly_name )
+    , file_name( settings.file_name )
+#ifdef SYNTHETIC
+    , synthetic( serial_number )
+#endif
+    , color_width( settings.width )
+    , color_height( settings.height )
+    , color_fps( settings.fps )
+    , color_format( settings.color_format )
+    , depth_width( settings.width )
+    , depth_height( settings.height )
+    , depth_fps( settings.fps )
+    , retention( 1 )
+    , enable_pointcloud( settings.pointcloud )
+    , clock_offset( std::numeric_limits<double>::max() )
+    , poll( settings.poll )
+    , stall_timeout( std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double, std::milli>( settings.stall_periods * 1000.0 / std::max<uint32_t>( settings.fps, 1 ) ) ) )
+    , restart_timeout( std::chrono::milliseconds( settings.restart_timeout ) )
+    , startup_timeout( std::chrono::milliseconds( settings.startup_timeout ) )
+    , max_restarts( settings.max_restarts )
+    , arrival_offset( std::numeric_limits<double>::max() )
 {
     // Initialize
     initialize();
@@ -23,49 +48,293 @@ void RealSense::initialize()
 
     // Initialize Sensor
     initializeSensor();
+
+    // Create Window Name
+    color_window_name = "Color - " + friendly_name + " (" + serial_number + ")";
+    depth_window_name = "Depth - " + friendly_name + " (" + serial_number + ")";
 }
 
 // Initialize Sensor
 inline void RealSense::initializeSensor()
 {
-    // Set Device Config
-    rs2::config config;
+    // Set Device Config (Kept for Restart of Pipeline)
+    if( !file_name.empty() ){
+        // Play Recorded File (Repeat, Streams are as Recorded)
+        config.enable_device_from_file( file_name, true );
+        pipeline_profile = pipeline.start( config );
+        resetWatchdog();
+        return;
+    }
     config.enable_device( serial_number );
-    config.enable_stream( rs2_stream::RS2_STREAM_COLOR, color_width, color_height, rs2_format::RS2_FORMAT_BGR8, color_fps );
+    config.enable_stream( rs2_stream::RS2_STREAM_COLOR, color_width, color_height, color_format, color_fps );
     config.enable_stream( rs2_stream::RS2_STREAM_DEPTH, depth_width, depth_height, rs2_format::RS2_FORMAT_Z16, depth_fps );
 
+#ifdef SYNTHETIC
+    // Use Synthetic Device instead of Live Device (Serial Number is Same)
+    synthetic.add_to( context );
+    pipeline = rs2::pipeline( context );
+#endif
+
     // Start Pipeline
     pipeline_profile = pipeline.start( config );
+
+#ifdef SYNTHETIC
+    // Start Generating Frames of Synthetic Device
+    synthetic.start( pipeline_profile );
+#endif
+
+    // Reset Watchdog
+    resetWatchdog();
 }
 
 // Finalize
 void RealSense::finalize()
 {
-    // Close Windows
-    cv::destroyAllWindows();
+    // Wait Restart of Pipeline
+    if( restarting.valid() ){
+        try{
+            restarting.get();
+        }
+        catch( const std::exception& ){
+        }
+    }
+
+#ifdef SYNTHETIC
+    // Stop Generating Frames of Synthetic Device before Pipeline
+    synthetic.stop();
+#endif
 
-    // Stop Pipline
-    pipeline.stop();
+    // Stop Pipline (Pipeline may be Already Stopped by Failed Restart)
+    try{
+        pipeline.stop();
+    }
+    catch( const std::exception& ex ){
+        std::cout << ex.what() << std::endl;
+    }
+
+    // Stop Recording
+    stopRecording();
 }
 
 // Update Data
-void RealSense::update()
+bool RealSense::update()
 {
     // Update Frame
-    updateFrame();
+    if( !updateFrame() ){
+        return false;
+    }
 
     // Update Color
     updateColor();
 
     // Update Depth
     updateDepth();
+
+    // Update Recording
+    updateRecording();
+
+    // Release Frameset (Color and Depth Frames are Held until Retained on Draw)
+    frameset = rs2::frameset();
+
+    return true;
 }
 
 // Update Frame
-inline void RealSense::updateFrame()
+inline bool RealSense::updateFrame()
 {
     // Update Frame
-    frameset = pipeline.wait_for_frames();
+    if( poll ){
+        if( !pollFrame() ){
+            return false;
+        }
+    }
+    else{
+        frameset = pipeline.wait_for_frames();
+    }
+
+    // Update Statistics
+    updateStatistics();
+
+    return true;
+}
+
+// Poll Frame
+inline bool RealSense::pollFrame()
+{
+    // Skip while Pipeline is Restarting (Other Cameras are not Blocked)
+    if( restarting.valid() ){
+        if( restarting.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready ){
+            return false;
+        }
+
+        try{
+            restarting.get();
+            streaming = true;
+            resetWatchdog();
+        }
+        catch( const std::exception& ex ){
+            // Restart Failed (e.g. Device Busy), Stall is Kept and Watchdog Retries after Timeout until Max Restarts
+            std::cout << "Watchdog (" << serial_number << "): " << ex.what() << std::endl;
+            streaming = false;
+            restart_time = std::chrono::steady_clock::now();
+        }
+    }
+
+    // Skip Polling while Pipeline is Stopped by Failed Restart
+    if( !streaming ){
+        updateWatchdog();
+        return false;
+    }
+
+    // Poll Frame without Blocking
+    rs2::frameset polled;
+    const bool arrived = pipeline.poll_for_frames( &polled );
+    if( arrived ){
+        frameset = polled;
+
+        // Update Arrival of Each Stream
+        // Arrival is time of arrival of frame on host (not time of poll), so gap of polling is not regarded as stall.
+        // Time of arrival is host clock (milliseconds since epoch), it is converted to steady clock by elapsed time. (Current time if metadata is not supported or recorded file)
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const double host_now = session::now();
+        for( size_t i = 0; i < frameset.size(); i++ ){
+            const rs2::frame frame = frameset[i];
+            std::chrono::steady_clock::time_point arrival = now;
+            if( file_name.empty() && frame.supports_frame_metadata( rs2_frame_metadata_value::RS2_FRAME_METADATA_TIME_OF_ARRIVAL ) ){
+                const double elapsed = host_now - static_cast<double>( frame.get_frame_metadata( rs2_frame_metadata_value::RS2_FRAME_METADATA_TIME_OF_ARRIVAL ) );
+                arrival = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double, std::milli>( std::max( elapsed, 0.0 ) ) );
+            }
+
+            WatchdogStream& stream = watchdog_streams[frame.get_profile().stream_type()];
+            stream.last = std::max( stream.last, arrival );
+            stream.arrived = true;
+        }
+    }
+
+    // Update Watchdog
+    updateWatchdog();
+
+    // Frameset of Polled Frames may Lack Stream
+    return arrived && frameset.get_color_frame() && frameset.get_depth_frame();
+}
+
+// Reset Watchdog
+inline void RealSense::resetWatchdog()
+{
+    // Watch Streams of Pipeline from Start (First Frame has Startup Timeout)
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    watchdog_streams.clear();
+    for( const rs2::stream_profile& stream_profile : pipeline_profile.get_streams() ){
+        WatchdogStream& stream = watchdog_streams[stream_profile.stream_type()];
+        stream.last = now;
+        stream.arrived = false;
+    }
+}
+
+// Update Watchdog
+inline void RealSense::updateWatchdog()
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if( !stalled ){
+        // Detect Stall (No Frame of Stream for Frame Periods)
+        for( const std::pair<const rs2_stream, WatchdogStream>& stream : watchdog_streams ){
+            const std::chrono::steady_clock::duration timeout = stream.second.arrived ? stall_timeout : startup_timeout;
+            if( now - stream.second.last <= timeout ){
+                continue;
+            }
+
+            stalled = true;
+            stall_time = restart_time = now;
+            stall_last = stream.second.last;
+            restarts = 0;
+
+            // Record Stall Event
+            StallEvent event;
+            event.time = session::now();
+            event.stream = rs2_stream_to_string( stream.first );
+            event.detected = std::chrono::duration<double, std::milli>( now - stall_last ).count();
+            stall_events.push_back( event );
+            std::cout << "Watchdog (" << serial_number << "): " << event.stream << " stalled for " << event.detected << " ms" << std::endl;
+            return;
+        }
+        return;
+    }
+
+    // Recovered when All Streams Arrived after Stall is Detected
+    bool recovered = true;
+    for( const std::pair<const rs2_stream, WatchdogStream>& stream : watchdog_streams ){
+        recovered = recovered && stream.second.arrived && stream.second.last > stall_time;
+    }
+    if( recovered ){
+        stalled = false;
+        StallEvent& event = stall_events.back();
+        event.recovered = std::chrono::duration<double, std::milli>( now - stall_last ).count();
+        event.restarts = restarts;
+        std::cout << "Watchdog (" << serial_number << "): recovered in " << event.recovered << " ms (" << restarts << " restarts)" << std::endl;
+        return;
+    }
+
+    // Restart Pipeline while Stall Persists (Next Restart Waits Startup of Previous Restart)
+    const std::chrono::steady_clock::duration timeout = restarts ? startup_timeout : restart_timeout;
+    if( now - restart_time < timeout ){
+        return;
+    }
+    if( restarts >= max_restarts ){
+        stalled = false;
+        throw std::runtime_error( "stalled after " + std::to_string( restarts ) + " restarts of pipeline (" + serial_number + ")" );
+    }
+    restartSensor();
+}
+
+// Restart Pipeline
+inline void RealSense::restartSensor()
+{
+    restarts++;
+    restart_time = std::chrono::steady_clock::now();
+    std::cout << "Watchdog (" << serial_number << "): restarting pipeline (" << restarts << "/" << max_restarts << ")" << std::endl;
+
+    // Restart on Another Thread (Stop and Start of Pipeline Take Time)
+    restarting = std::async( std::launch::async, [this](){
+#ifdef SYNTHETIC
+        // Stop Generating Frames of Synthetic Device before Pipeline
+        synthetic.stop();
+#endif
+
+        try{
+            pipeline.stop();
+        }
+        catch( const std::exception& ){
+            // Pipeline is Already Stopped by Failed Restart
+        }
+        pipeline_profile = pipeline.start( config );
+
+#ifdef SYNTHETIC
+        // Start Generating Frames of Synthetic Device
+        synthetic.start( pipeline_profile );
+#endif
+    } );
+}
+
+// Update Statistics
+inline void RealSense::updateStatistics()
+{
+    const rs2::frame frame = frameset.get_depth_frame() ? frameset.get_depth_frame() : frameset.get_color_frame();
+    frames++;
+    if( !frame || !frame.supports_frame_metadata( rs2_frame_metadata_value::RS2_FRAME_METADATA_TIME_OF_ARRIVAL ) ){
+        return;
+    }
+
+    // Latency from Time of Arrival to Update
+    // Time of arrival of recorded file is of recording, so it is rebased by first frame (latency is relative to first frame).
+    const double now = session::now();
+    double arrival = static_cast<double>( frame.get_frame_metadata( rs2_frame_metadata_value::RS2_FRAME_METADATA_TIME_OF_ARRIVAL ) );
+    if( !file_name.empty() ){
+        if( arrival_offset == std::numeric_limits<double>::max() ){
+            arrival_offset = now - arrival;
+        }
+        arrival += arrival_offset;
+    }
+    latencies.push_back( now - arrival );
 }
 
 // Update Color
@@ -90,6 +359,38 @@ inline void RealSense::updateDepth()
     depth_height = depth_frame.as<rs2::video_frame>().get_height();
 }
 
+// Update Recording
+inline void RealSense::updateRecording()
+{
+    if( !recorder ){
+        return;
+    }
+
+    // Push Frames to Writer Thread
+    recorder->push( color_frame );
+    recorder->push( depth_frame );
+
+    // Update Clock Offset
+    updateClockOffset( color_frame );
+    updateClockOffset( depth_frame );
+}
+
+// Update Clock Offset
+inline void RealSense::updateClockOffset( const rs2::frame& frame )
+{
+    if( !frame ){
+        return;
+    }
+
+    // Time of Arrival is Host Clock when Frame Arrived (Current Time if Metadata is not Supported)
+    const double arrival = frame.supports_frame_metadata( rs2_frame_metadata_value::RS2_FRAME_METADATA_TIME_OF_ARRIVAL )
+                         ? static_cast<double>( frame.get_frame_metadata( rs2_frame_metadata_value::RS2_FRAME_METADATA_TIME_OF_ARRIVAL ) )
+                         : session::now();
+
+    // Minimum Offset is of Frame with Least Latency
+    clock_offset = std::min( clock_offset, arrival - frame.get_timestamp() );
+}
+
 // Draw Data
 void RealSense::draw()
 {
@@ -103,15 +404,51 @@ void RealSense::draw()
 // Draw Color
 inline void RealSense::drawColor()
 {
-    // Create cv::Mat form Color Frame
-    color_mat = cv::Mat( color_height, color_width, CV_8UC3, const_cast<void*>( color_frame.get_data() ) );
+    if( !color_frame ){
+        return;
+    }
+    const bool yuyv = color_frame.get_profile().format() == rs2_format::RS2_FORMAT_YUYV;
+
+    // Release Previous Frame before Retaining New Frame (cv::Mat that Wraps Retained Frame is Released First)
+    if( !yuyv ){
+        color_mat.release();
+    }
+    color_retained = retained_frame();
+
+    // Retain Color Frame and Release SDK Frame (Retained Frame Keeps SDK Frame within Budget, or Copy in Slab)
+    color_retained = retention.retain( color_frame );
+    color_frame = rs2::frame();
+
+    // Create cv::Mat form Retained Color Frame
+    if( yuyv ){
+        // Convert YUYV to BGR (YUYV is Less Bandwidth on USB)
+        if( color_retained ){
+            cv::cvtColor( color_retained.mat( CV_8UC2 ), color_mat, cv::COLOR_YUV2BGR_YUYV );
+        }
+        return;
+    }
+    color_mat = color_retained.mat( CV_8UC3 );
 }
 
 // Draw Depth
 inline void RealSense::drawDepth()
 {
-    // Create cv::Mat form Depth Frame
-    depth_mat = cv::Mat( depth_height, depth_width, CV_16SC1, const_cast<void*>( depth_frame.get_data() ) );
+    if( !depth_frame ){
+        return;
+    }
+
+    // Release Previous Frame before Retaining New Frame (cv::Mat that Wraps Retained Frame is Released First)
+    depth_mat.release();
+    depth_retained = retained_frame();
+
+    // Retain Depth Frame and Release SDK Frame (Depth Frame is Kept until Point Cloud is Calculated if Enabled)
+    depth_retained = retention.retain( depth_frame );
+    if( !enable_pointcloud ){
+        depth_frame = rs2::frame();
+    }
+
+    // Create cv::Mat form Retained Depth Frame
+    depth_mat = depth_retained.mat( CV_16SC1 );
 }
 
 // Show Data
@@ -132,7 +469,7 @@ inline void RealSense::showColor()
     }
 
     // Show Color Image
-    cv::imshow( "Color - " + friendly_name + " (" + serial_number + ")", color_mat );
+    cv::imshow( color_window_name, color_mat );
 }
 
 // Show Depth
@@ -151,5 +488,127 @@ inline void RealSense::showDepth()
     //cv::applyColorMap( scale_mat, scale_mat, cv::COLORMAP_BONE );
 
     // Show Depth Image
-    cv::imshow( "Depth - " + friendly_name + " (" + serial_number + " )", scale_mat );
+    cv::imshow( depth_window_name, scale_mat );
+}
+
+// Calculate Point Cloud
+rs2::points RealSense::calculatePointCloud()
+{
+    if( !depth_frame ){
+        return rs2::points();
+    }
+
+    // Calculate Point Cloud and Release SDK Frame
+    points = pointcloud.calculate( depth_frame );
+    depth_frame = rs2::frame();
+    return points;
+}
+
+// Retrieve Serial Number
+const std::string& RealSense::getSerialNumber() const
+{
+    return serial_number;
+}
+
+// Report Frame Retention
+std::string RealSense::reportRetention() const
+{
+    return retention.report();
+}
+
+// Start Recording to Frame File
+void RealSense::startRecording( const std::string& file_name )
+{
+    disk::options option;
+    option.file_name = file_name;
+    recorder.reset( new disk_recorder( option ) );
+    clock_offset = std::numeric_limits<double>::max();
+}
+
+// Stop Recording (Write Queued Frames)
+void RealSense::stopRecording()
+{
+    recorder.reset();
+}
+
+// Retrieve Clock Offset from Timestamp to Host Clock
+double RealSense::getClockOffset() const
+{
+    // Offset is Unknown until First Frame is Recorded
+    return ( clock_offset == std::numeric_limits<double>::max() ) ? 0.0 : clock_offset;
+}
+
+// Reset Statistics
+void RealSense::resetStatistics()
+{
+    frames = 0;
+    latencies.clear();
+}
+
+// Retrieve Number of Framesets since Reset
+uint64_t RealSense::getFrames() const
+{
+    return frames;
+}
+
+// Retrieve Latencies since Reset (milliseconds)
+const std::vector<double>& RealSense::getLatencies() const
+{
+    return latencies;
+}
+
+// Retrieve Stall Events Detected by Watchdog
+const std::vector<StallEvent>& RealSense::getStallEvents() const
+{
+    return stall_events;
+}
+
+// Compose Data into Mosaic Tiles
+void RealSense::compose( cv::Mat& color_tile, cv::Mat& depth_tile )
+{
+    // Compose Color
+    composeColor( color_tile );
+
+    // Compose Depth
+    composeDepth( depth_tile );
+}
+
+// Compose Color
+inline void RealSense::composeColor( cv::Mat& tile )
+{
+    if( color_mat.empty() || tile.empty() ){
+        return;
+    }
+
+    // Write Downscaled Color Directly into Tile (Nearest Neighbor)
+    const int32_t tile_width = tile.cols;
+    const int32_t tile_height = tile.rows;
+    for( int32_t y = 0; y < tile_height; y++ ){
+        const cv::Vec3b* src = color_mat.ptr<cv::Vec3b>( y * color_mat.rows / tile_height );
+        cv::Vec3b* dst = tile.ptr<cv::Vec3b>( y );
+        for( int32_t x = 0; x < tile_width; x++ ){
+            dst[x] = src[x * color_mat.cols / tile_width];
+        }
+    }
+}
+
+// Compose Depth
+inline void RealSense::composeDepth( cv::Mat& tile )
+{
+    if( depth_mat.empty() || tile.empty() ){
+        return;
+    }
+
+    // Write Downscaled and Scaled Depth Directly into Tile (Nearest Neighbor)
+    const int32_t tile_width = tile.cols;
+    const int32_t tile_height = tile.rows;
+    for( int32_t y = 0; y < tile_height; y++ ){
+        const uint16_t* src = depth_mat.ptr<uint16_t>( y * depth_mat.rows / tile_height );
+        cv::Vec3b* dst = tile.ptr<cv::Vec3b>( y );
+        for( int32_t x = 0; x < tile_width; x++ ){
+            const uint32_t depth = std::min<uint32_t>( src[x * depth_mat.cols / tile_width], 10000 );
+            const uint8_t scale = static_cast<uint8_t>( 255 - depth * 255 / 10000 ); // 0-10000 -> 255(white)-0(black)
+            dst[x] = cv::Vec3b( scale, scale, scale );
+        }
+    }
 }
\ No newline at end of file
@@ -4,17 +4,72 @@
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
 
+#ifdef SYNTHETIC
+#include "synthetic_device.h"
+#endif
+
+#include "frame_retention.h"
+#include "disk_recorder.h"
+#include "session.h"
+
 #include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <future>
+
+// Settings of RealSense
+struct RealSenseSettings
+{
+    uint32_t width = 640; // color and depth
+    uint32_t height = 480;
+    uint32_t fps = 30;
+    rs2_format color_format = RS2_FORMAT_BGR8; // BGR8 or YUYV (converted to BGR on draw)
+    std::string file_name; // play recorded file (.bag) instead of device (empty is device)
+
+    // Poll Mode (Non-Blocking poll_for_frames(), Stall of Stream is Detected by Watchdog and Pipeline is Restarted)
+    bool poll = false;
+    double stall_periods = 2.0; // frame periods without frame that is regarded as stall
+    uint32_t restart_timeout = 500; // milliseconds from stall to restart of pipeline (stall that recovers within this is only recorded)
+    uint32_t startup_timeout = 5000; // milliseconds until first frame after (re)start of pipeline
+    uint32_t max_restarts = 3; // consecutive restarts before failure is thrown
+
+    // Point Cloud (Depth Frame of SDK is Kept until calculatePointCloud(), otherwise it is Released on Draw)
+    bool pointcloud = true;
+};
+
+// Stall Event of RealSense (Detected by Watchdog in Poll Mode)
+struct StallEvent
+{
+    double time = 0.0; // milliseconds since epoch (host clock) when stall is detected
+    std::string stream; // stream that stalled first
+    double detected = 0.0; // milliseconds from last frame to detection
+    double recovered = 0.0; // milliseconds from last frame to recovery (0.0 is not recovered)
+    uint32_t restarts = 0; // restarts of pipeline until recovered
+};
 
 class RealSense
 {
 private:
     // RealSense
     rs2::pipeline pipeline;
+    rs2::config config;
     rs2::pipeline_profile pipeline_profile;
     rs2::frameset frameset;
     std::string serial_number;
     std::string friendly_name;
+    std::string file_name;
+
+#ifdef SYNTHETIC
+    // Synthetic Device
+    rs2::context context;
+    synthetic_device synthetic;
+#endif
+
+    // Window Name
+    std::string color_window_name;
+    std::string depth_window_name;
 
     // Color Buffer
     rs2::frame color_frame;
@@ -22,6 +77,7 @@ private:
     uint32_t color_width = 640;
     uint32_t color_height = 480;
     uint32_t color_fps = 30;
+    rs2_format color_format = RS2_FORMAT_BGR8;
 
     // Depth Buffer
     rs2::frame depth_frame;
@@ -30,15 +86,55 @@ private:
     uint32_t depth_height = 480;
     uint32_t depth_fps = 30;
 
+    // Frame Retention (One SDK Frame is Kept Zero-Copy, Other Frame of Update is Copied into Slab)
+    frame_retention retention;
+    retained_frame color_retained;
+    retained_frame depth_retained;
+
+    // Point Cloud Buffer
+    rs2::pointcloud pointcloud;
+    rs2::points points;
+    bool enable_pointcloud = true;
+
+    // Recording (Own Frame File and Writer Thread per Device)
+    std::unique_ptr<disk_recorder> recorder;
+    double clock_offset; // milliseconds (host clock = timestamp + offset)
+
+    // Watchdog (Poll Mode)
+    struct WatchdogStream
+    {
+        std::chrono::steady_clock::time_point last; // arrival of last frame (or start of pipeline)
+        bool arrived = false; // first frame arrived after start of pipeline
+    };
+    bool poll = false;
+    std::chrono::steady_clock::duration stall_timeout;
+    std::chrono::steady_clock::duration restart_timeout;
+    std::chrono::steady_clock::duration startup_timeout;
+    uint32_t max_restarts = 3;
+    std::map<rs2_stream, WatchdogStream> watchdog_streams;
+    bool stalled = false;
+    std::chrono::steady_clock::time_point stall_time; // detection of current stall
+    std::chrono::steady_clock::time_point stall_last; // last frame before current stall
+    std::chrono::steady_clock::time_point restart_time;
+    uint32_t restarts = 0; // restarts of current stall
+    std::future<void> restarting;
+    bool streaming = true; // pipeline is running (false after failed restart)
+    std::vector<StallEvent> stall_events;
+
+    // Statistics (Frames and Latency from Arrival to Update)
+    uint64_t frames = 0;
+    std::vector<double> latencies; // milliseconds
+    double arrival_offset; // milliseconds (rebase time of arrival of recorded file to current time)
+
 public:
     // Constructor
-    RealSense( const std::string serial_number, const std::string friendly_name = "" );
+    RealSense( const std::string serial_number, const std::string friendly_name = "", const RealSenseSettings& settings = RealSenseSettings() );
 
     // Destructor
     ~RealSense();
 
-    // Update Data
-    void update();
+    // Update Data (Return false if No New Frames in Poll Mode)
+    bool update();
 
     // Draw Data
     void draw();
@@ -46,6 +142,39 @@ public:
     // Show Data
     void show();
 
+    // Compose Data into Mosaic Tiles
+    void compose( cv::Mat& color_tile, cv::Mat& depth_tile );
+
+    // Calculate Point Cloud
+    rs2::points calculatePointCloud();
+
+    // Retrieve Serial Number
+    const std::string& getSerialNumber() const;
+
+    // Report Frame Retention
+    std::string reportRetention() const;
+
+    // Start Recording to Frame File
+    void startRecording( const std::string& file_name );
+
+    // Stop Recording (Write Queued Frames)
+    void stopRecording();
+
+    // Retrieve Clock Offset from Timestamp to Host Clock
+    double getClockOffset() const;
+
+    // Reset Statistics
+    void resetStatistics();
+
+    // Retrieve Number of Framesets since Reset
+    uint64_t getFrames() const;
+
+    // Retrieve Latencies since Reset (milliseconds)
+    const std::vector<double>& getLatencies() const;
+
+    // Retrieve Stall Events Detected by Watchdog
+    const std::vector<StallEvent>& getStallEvents() const;
+
 private:
     // Initialize
     void initialize();
@@ -57,7 +186,22 @@ private:
     void finalize();
 
     // Update Frame
-    inline void updateFrame();
+    inline bool updateFrame();
+
+    // Poll Frame
+    inline bool pollFrame();
+
+    // Reset Watchdog (Start of Pipeline)
+    inline void resetWatchdog();
+
+    // Update Watchdog
+    inline void updateWatchdog();
+
+    // Restart Pipeline (Another Thread)
+    inline void restartSensor();
+
+    // Update Statistics
+    inline void updateStatistics();
 
     // Update Color
     inline void updateColor();
@@ -65,6 +209,12 @@ private:
     // Update Depth
     inline void updateDepth();
 
+    // Update Recording
+    inline void updateRecording();
+
+    // Update Clock Offset
+    inline void updateClockOffset( const rs2::frame& frame );
+
     // Draw Color
     inline void drawColor();
 
@@ -76,6 +226,12 @@ private:
 
     // Show Depth
     inline void showDepth();
+
+    // Compose Color
+    inline void composeColor( cv::Mat& tile );
+
+    // Compose Depth
+    inline void composeDepth( cv::Mat& tile );
 };
 
 #endif // __REALSENSE__
\ No newline at end of file
@@ -0,0 +1,281 @@
+// This is minimum implementation of multi-device recording session.
+// Each device records to its own frame file on its own writer thread (disk_recorder.h), and session manifest (.csv) has shared session start time and clock offset of each device.
+// Clock offset maps timestamp of device to host clock (milliseconds), it is minimum of (time of arrival - timestamp) that excludes transport latency as much as possible.
+// Session player reads frame files of all devices with read-ahead (frame_reader.h), and delivers framesets of devices that are aligned on host clock.
+
+#ifndef __SESSION__
+#define __SESSION__
+
+#include "frame_reader.h"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <cstdint>
+
+namespace session
+{
+    // Device of Session
+    struct device
+    {
+        std::string serial_number;
+        std::string file_name;
+        double offset; // milliseconds (host clock = timestamp + offset)
+    };
+
+    // Manifest of Session
+    struct manifest
+    {
+        int64_t start = 0; // milliseconds since epoch (host clock)
+        std::vector<device> devices;
+    };
+
+    // Options of Playback
+    struct options
+    {
+        double tolerance = 1000.0 / 30.0 / 2.0; // milliseconds (frames within tolerance are aligned)
+        bool real_time = true; // pace by host clock of recording (otherwise as fast as possible)
+        prefetch::options prefetch;
+    };
+
+    // Aligned Frames of Device
+    struct frameset
+    {
+        double time = 0.0; // milliseconds from session start
+        prefetch::frame color;
+        prefetch::frame depth;
+    };
+
+    // Current Host Clock (milliseconds since epoch)
+    inline double now()
+    {
+        return std::chrono::duration<double, std::milli>( std::chrono::system_clock::now().time_since_epoch() ).count();
+    }
+
+    // Write Manifest
+    // session_start,<milliseconds>
+    // serial_number,file_name,offset
+    // <serial number>,<file name>,<offset> per device
+    inline void write( const std::string& file_name, const manifest& manifest )
+    {
+        std::ofstream ofs( file_name );
+        if( !ofs.is_open() ){
+            throw std::runtime_error( "failed to open " + file_name );
+        }
+
+        ofs << "session_start," << manifest.start << "\n";
+        ofs << "serial_number,file_name,offset\n";
+        ofs << std::fixed << std::setprecision( 3 );
+        for( const device& device : manifest.devices ){
+            ofs << device.serial_number << "," << device.file_name << "," << device.offset << "\n";
+        }
+    }
+
+    // Read Manifest
+    inline manifest read( const std::string& file_name )
+    {
+        std::ifstream ifs( file_name );
+        if( !ifs.is_open() ){
+            throw std::runtime_error( "failed to open " + file_name );
+        }
+
+        manifest manifest;
+        std::string line;
+        while( std::getline( ifs, line ) ){
+            std::vector<std::string> fields;
+            std::stringstream stream( line );
+            std::string field;
+            while( std::getline( stream, field, ',' ) ){
+                fields.push_back( field );
+            }
+
+            if( fields.size() == 2 && fields[0] == "session_start" ){
+                manifest.start = std::stoll( fields[1] );
+            }
+            else if( fields.size() == 3 && fields[0] != "serial_number" ){
+                manifest.devices.push_back( { fields[0], fields[1], std::stod( fields[2] ) } );
+            }
+        }
+
+        if( manifest.devices.empty() ){
+            throw std::runtime_error( "no device in " + file_name );
+        }
+        return manifest;
+    }
+}
+
+class session_player
+{
+private:
+    // Device of Playback
+    struct device
+    {
+        session::device info;
+        std::unique_ptr<frame_reader> reader;
+        prefetch::frame pending;
+        bool has_pending = false;
+        session::frameset head;
+        bool has_head = false;
+    };
+
+    session::options option;
+    session::manifest manifest;
+    std::vector<device> devices;
+
+    // Pacing
+    bool started = false;
+    double first_time = 0.0;
+    std::chrono::steady_clock::time_point start;
+
+    // Statistics
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+
+public:
+    explicit session_player( const std::string& file_name, const session::options& option = session::options() )
+        : option( option )
+        , manifest( session::read( file_name ) )
+        , devices( manifest.devices.size() )
+    {
+        for( size_t i = 0; i < devices.size(); i++ ){
+            devices[i].info = manifest.devices[i];
+            devices[i].reader.reset( new frame_reader( devices[i].info.file_name, option.prefetch ) );
+        }
+    }
+
+    session_player( const session_player& ) = delete;
+    session_player& operator=( const session_player& ) = delete;
+
+    // Next Aligned Framesets (One per Device in Order of Manifest, Return false at End of Any File)
+    bool next( std::vector<session::frameset>& framesets )
+    {
+        while( true ){
+            // Fill Head of Each Device
+            for( device& device : devices ){
+                if( !device.has_head && !read( device ) ){
+                    return false;
+                }
+            }
+
+            // Drop Heads that are Older than Latest Head beyond Tolerance
+            double latest = devices.front().head.time;
+            for( const device& device : devices ){
+                latest = std::max( latest, device.head.time );
+            }
+
+            bool aligned = true;
+            for( device& device : devices ){
+                if( device.head.time < latest - option.tolerance ){
+                    device.has_head = false;
+                    dropped++;
+                    aligned = false;
+                }
+            }
+            if( !aligned ){
+                continue;
+            }
+
+            // Deliver Heads
+            framesets.resize( devices.size() );
+            for( size_t i = 0; i < devices.size(); i++ ){
+                framesets[i] = std::move( devices[i].head );
+                devices[i].has_head = false;
+            }
+            delivered++;
+
+            // Pace by Host Clock of Recording
+            pace( latest );
+            return true;
+        }
+    }
+
+    size_t size() const
+    {
+        return devices.size();
+    }
+
+    const session::manifest& get_manifest() const
+    {
+        return manifest;
+    }
+
+    uint64_t delivered_framesets() const
+    {
+        return delivered;
+    }
+
+    uint64_t dropped_framesets() const
+    {
+        return dropped;
+    }
+
+private:
+    // Read Frameset of Device (Frames of Different Streams within Tolerance)
+    bool read( device& device )
+    {
+        session::frameset& frameset = device.head;
+        frameset = session::frameset();
+        bool has_frame = false;
+        double first = 0.0;
+        while( true ){
+            prefetch::frame frame;
+            if( device.has_pending ){
+                frame = std::move( device.pending );
+                device.has_pending = false;
+            }
+            else if( !device.reader->next( frame ) ){
+                break;
+            }
+
+            if( frame.header.stream != rs2_stream::RS2_STREAM_DEPTH && frame.header.stream != rs2_stream::RS2_STREAM_COLOR ){
+                continue;
+            }
+
+            // Frame of Next Frameset (Stream Repeats or Out of Tolerance)
+            const double time = frame.header.timestamp + device.info.offset - manifest.start;
+            prefetch::frame& slot = ( frame.header.stream == rs2_stream::RS2_STREAM_DEPTH ) ? frameset.depth : frameset.color;
+            if( has_frame && ( !slot.image.empty() || std::abs( time - first ) > option.tolerance ) ){
+                device.pending = std::move( frame );
+                device.has_pending = true;
+                break;
+            }
+
+            if( !has_frame ){
+                first = frameset.time = time;
+                has_frame = true;
+            }
+            frameset.time = std::max( frameset.time, time );
+            slot = std::move( frame );
+        }
+
+        device.has_head = has_frame;
+        return has_frame;
+    }
+
+    // Wait until Time of Frameset (Real-Time Playback)
+    void pace( const double time )
+    {
+        if( !option.real_time ){
+            return;
+        }
+
+        if( !started ){
+            first_time = time;
+            start = std::chrono::steady_clock::now();
+            started = true;
+        }
+
+        const std::chrono::duration<double, std::milli> elapsed( time - first_time );
+        std::this_thread::sleep_until( start + std::chrono::duration_cast<std::chrono::steady_clock::duration>( elapsed ) );
+    }
+};
+
+#endif // __SESSION__
\ No newline at end of file
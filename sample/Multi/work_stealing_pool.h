@@ -0,0 +1,279 @@
+// This is minimum implementation of work-stealing thread pool with strands.
+// Each worker has its own deque of jobs, worker pops from front of its own deque and idle worker steals from back of other deques.
+// Tasks are submitted to strand (e.g. one strand per camera), tasks of same strand run one at a time in submitted order, tasks of different strands run in parallel.
+// Strand is drained by one job at a time, and job that has remaining tasks is pushed back to deque, so busy strand can move to idle worker by stealing.
+
+#ifndef __WORK_STEALING_POOL__
+#define __WORK_STEALING_POOL__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cstdint>
+
+class work_stealing_pool
+{
+private:
+    // Strand (Serial Queue of Tasks)
+    struct strand
+    {
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::deque<std::function<void()>> tasks;
+        bool scheduled = false; // job to drain strand is in deque or running
+    };
+
+    // Worker (Deque of Jobs, Job is Index of Strand)
+    struct worker
+    {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    std::vector<std::unique_ptr<strand>> strands;
+    std::vector<std::unique_ptr<worker>> workers;
+    std::vector<std::thread> threads;
+
+    // Sleep of Idle Workers
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t pending = 0; // jobs in deques that are not claimed by worker
+    bool stopping = false;
+
+    // Exception of Task (Rethrown by wait())
+    std::exception_ptr exception;
+
+    // Statistics
+    std::atomic<uint64_t> executed;
+    std::atomic<uint64_t> stolen;
+    std::atomic<uint32_t> next_worker;
+
+    // Index of Worker of Current Thread (-1 is not Worker of This Pool)
+    static int32_t& current_index()
+    {
+        static thread_local int32_t index = -1;
+        return index;
+    }
+    static const work_stealing_pool*& current_pool()
+    {
+        static thread_local const work_stealing_pool* pool = nullptr;
+        return pool;
+    }
+
+public:
+    explicit work_stealing_pool( const uint32_t num_threads = 0 )
+        : executed( 0 )
+        , stolen( 0 )
+        , next_worker( 0 )
+    {
+        const uint32_t count = num_threads ? num_threads : std::max( std::thread::hardware_concurrency(), 1u );
+        for( uint32_t i = 0; i < count; i++ ){
+            workers.emplace_back( new worker() );
+        }
+        for( uint32_t i = 0; i < count; i++ ){
+            threads.emplace_back( &work_stealing_pool::run, this, i );
+        }
+    }
+
+    ~work_stealing_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            stopping = true;
+        }
+        condition.notify_all();
+        for( std::thread& thread : threads ){
+            thread.join();
+        }
+    }
+
+    work_stealing_pool( const work_stealing_pool& ) = delete;
+    work_stealing_pool& operator=( const work_stealing_pool& ) = delete;
+
+    // Create Strand (Call before Submitting Tasks, Returns Index of Strand)
+    size_t create_strand()
+    {
+        strands.emplace_back( new strand() );
+        return strands.size() - 1;
+    }
+
+    // Submit Task to Strand
+    void submit( const size_t index, std::function<void()> task )
+    {
+        strand& strand = *strands[index];
+        {
+            std::lock_guard<std::mutex> lock( strand.mutex );
+            strand.tasks.push_back( std::move( task ) );
+            if( strand.scheduled ){
+                return;
+            }
+            strand.scheduled = true;
+        }
+        schedule( index );
+    }
+
+    // Check Strand has No Task
+    bool is_idle( const size_t index )
+    {
+        strand& strand = *strands[index];
+        std::lock_guard<std::mutex> lock( strand.mutex );
+        return !strand.scheduled;
+    }
+
+    // Wait until Strand has No Task (Rethrow Exception of Task)
+    void wait( const size_t index )
+    {
+        strand& strand = *strands[index];
+        {
+            std::unique_lock<std::mutex> lock( strand.mutex );
+            strand.idle.wait( lock, [&]{ return !strand.scheduled; } );
+        }
+        rethrow();
+    }
+
+    // Wait until All Strands have No Task
+    void wait_all()
+    {
+        for( size_t index = 0; index < strands.size(); index++ ){
+            wait( index );
+        }
+    }
+
+    size_t size() const
+    {
+        return threads.size();
+    }
+
+    uint64_t executed_tasks() const
+    {
+        return executed;
+    }
+
+    uint64_t stolen_tasks() const
+    {
+        return stolen;
+    }
+
+private:
+    // Push Job to Deque (Own Deque if Called from Worker, otherwise Round Robin)
+    void schedule( const size_t index )
+    {
+        const int32_t current = ( current_pool() == this ) ? current_index() : -1;
+        const size_t target = ( current >= 0 ) ? static_cast<size_t>( current ) : next_worker++ % workers.size();
+        {
+            std::lock_guard<std::mutex> lock( workers[target]->mutex );
+            workers[target]->jobs.push_back( index );
+        }
+
+        std::lock_guard<std::mutex> lock( mutex );
+        pending++;
+        condition.notify_one();
+    }
+
+    // Take Job (Front of Own Deque, or Back of Other Deque)
+    bool take( const size_t self, size_t& index )
+    {
+        for( size_t i = 0; i < workers.size(); i++ ){
+            worker& worker = *workers[( self + i ) % workers.size()];
+            std::lock_guard<std::mutex> lock( worker.mutex );
+            if( worker.jobs.empty() ){
+                continue;
+            }
+
+            if( i == 0 ){
+                index = worker.jobs.front();
+                worker.jobs.pop_front();
+            }
+            else{
+                index = worker.jobs.back();
+                worker.jobs.pop_back();
+                stolen++;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Worker Thread
+    void run( const size_t self )
+    {
+        current_index() = static_cast<int32_t>( self );
+        current_pool() = this;
+
+        while( true ){
+            // Sleep while No Job, and Claim One Job
+            {
+                std::unique_lock<std::mutex> lock( mutex );
+                condition.wait( lock, [&]{ return stopping || pending > 0; } );
+                if( stopping ){
+                    return;
+                }
+                pending--;
+            }
+
+            // Job is Pushed to Deque before Counted, so Claimed Job is Always Found
+            size_t index;
+            while( !take( self, index ) ){
+                std::this_thread::yield();
+            }
+
+            drain( index );
+        }
+    }
+
+    // Run Next Task of Strand, and Push Job Back if Strand has More Tasks
+    void drain( const size_t index )
+    {
+        strand& strand = *strands[index];
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock( strand.mutex );
+            task = std::move( strand.tasks.front() );
+            strand.tasks.pop_front();
+        }
+
+        try{
+            task();
+        }
+        catch( ... ){
+            std::lock_guard<std::mutex> lock( mutex );
+            if( !exception ){
+                exception = std::current_exception();
+            }
+        }
+        executed++;
+
+        {
+            std::lock_guard<std::mutex> lock( strand.mutex );
+            if( strand.tasks.empty() ){
+                strand.scheduled = false;
+                strand.idle.notify_all();
+                return;
+            }
+        }
+
+        // Push to Back of Own Deque (Other Strands in Deque Run First, Idle Worker can Steal This)
+        schedule( index );
+    }
+
+    void rethrow()
+    {
+        std::exception_ptr exception;
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            std::swap( exception, this->exception );
+        }
+        if( exception ){
+            std::rethrow_exception( exception );
+        }
+    }
+};
+
+#endif // __WORK_STEALING_POOL__
\ No newline at end of file
@@ -0,0 +1,440 @@
+// This is minimum implementation of linear octree for point cloud.
+// Points are quantized in bounding box and sorted by morton code (parallel radix sort), so that each octree node is contiguous range of sorted points.
+// Nodes are not stored explicitly. Children of node are found by binary search of morton code range.
+
+#ifndef __LINEAR_OCTREE__
+#define __LINEAR_OCTREE__
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+class linear_octree
+{
+private:
+    static constexpr int32_t max_level = 21;
+    static constexpr uint64_t invalid_code = ~0ull;
+
+    // Bounding Box
+    cv::Vec3f origin;
+    float cell_size = 0.0f;
+
+    // Points Sorted by Morton Code
+    std::vector<uint64_t> codes;
+    std::vector<int32_t> indices;
+    std::vector<cv::Vec3f> points;
+    size_t size = 0;
+
+    // Radix Sort Buffer
+    std::vector<uint64_t> temporary_codes;
+    std::vector<int32_t> temporary_indices;
+    std::vector<size_t> histograms;
+
+    // Node of Octree (Morton Prefix, Level and Range of Sorted Points)
+    struct node
+    {
+        uint64_t prefix;
+        int32_t level;
+        size_t begin;
+        size_t end;
+    };
+
+    size_t leaf_size;
+
+public:
+    linear_octree( size_t leaf_size = 16 )
+        : leaf_size( leaf_size )
+    {
+    }
+
+    // Build octree from organized or unorganized point cloud (CV_32FC3)
+    // Invalid points (NaN or zero depth) are ignored. Indices of query results refer to the given point cloud.
+    void build( const cv::Mat& vertices )
+    {
+        CV_Assert( vertices.type() == CV_32FC3 && vertices.isContinuous() );
+
+        const int32_t num_points = static_cast<int32_t>( vertices.total() );
+        const cv::Vec3f* vertex = vertices.ptr<cv::Vec3f>();
+
+        // Calculate Bounding Box
+        cv::Vec3f box_min = cv::Vec3f::all( std::numeric_limits<float>::max() );
+        cv::Vec3f box_max = cv::Vec3f::all( std::numeric_limits<float>::lowest() );
+        #pragma omp parallel
+        {
+            cv::Vec3f thread_min = cv::Vec3f::all( std::numeric_limits<float>::max() );
+            cv::Vec3f thread_max = cv::Vec3f::all( std::numeric_limits<float>::lowest() );
+
+            #pragma omp for
+            for( int32_t index = 0; index < num_points; index++ ){
+                const cv::Vec3f& point = vertex[index];
+                if( !valid( point ) ){
+                    continue;
+                }
+                for( int32_t axis = 0; axis < 3; axis++ ){
+                    thread_min[axis] = std::min( thread_min[axis], point[axis] );
+                    thread_max[axis] = std::max( thread_max[axis], point[axis] );
+                }
+            }
+
+            #pragma omp critical
+            for( int32_t axis = 0; axis < 3; axis++ ){
+                box_min[axis] = std::min( box_min[axis], thread_min[axis] );
+                box_max[axis] = std::max( box_max[axis], thread_max[axis] );
+            }
+        }
+
+        const float extent = std::max( { box_max[0] - box_min[0], box_max[1] - box_min[1], box_max[2] - box_min[2], std::numeric_limits<float>::epsilon() } );
+        origin = box_min;
+        cell_size = extent * 1.0001f / static_cast<float>( 1 << max_level );
+
+        // Calculate Morton Code of Points
+        codes.resize( num_points );
+        indices.resize( num_points );
+        const float inverse_cell_size = 1.0f / cell_size;
+        #pragma omp parallel for
+        for( int32_t index = 0; index < num_points; index++ ){
+            const cv::Vec3f& point = vertex[index];
+            indices[index] = index;
+            if( !valid( point ) ){
+                codes[index] = invalid_code;
+                continue;
+            }
+            codes[index] = encode( static_cast<uint32_t>( ( point[0] - origin[0] ) * inverse_cell_size ),
+                                   static_cast<uint32_t>( ( point[1] - origin[1] ) * inverse_cell_size ),
+                                   static_cast<uint32_t>( ( point[2] - origin[2] ) * inverse_cell_size ) );
+        }
+
+        // Sort Points by Morton Code (Invalid Points go to End)
+        sort();
+        size = std::lower_bound( codes.begin(), codes.end(), invalid_code ) - codes.begin();
+
+        // Gather Points in Morton Order for Cache Friendly Query
+        points.resize( size );
+        #pragma omp parallel for
+        for( int32_t i = 0; i < static_cast<int32_t>( size ); i++ ){
+            points[i] = vertex[indices[i]];
+        }
+    }
+
+    // Retrieve number of indexed points
+    size_t indexed() const
+    {
+        return size;
+    }
+
+    // Radius Search
+    void radius_search( const cv::Vec3f& center, const float radius, std::vector<int32_t>& result ) const
+    {
+        result.clear();
+        const float squared_radius = radius * radius;
+        traverse( [&]( const cv::Vec3f& box_min, const cv::Vec3f& box_max ){
+                      return squared_min_distance( box_min, box_max, center ) <= squared_radius;
+                  },
+                  [&]( const cv::Vec3f& box_min, const cv::Vec3f& box_max ){
+                      return squared_max_distance( box_min, box_max, center ) <= squared_radius;
+                  },
+                  [&]( const cv::Vec3f& point ){
+                      return squared_distance( point, center ) <= squared_radius;
+                  },
+                  result );
+    }
+
+    // Box Search
+    void box_search( const cv::Vec3f& min, const cv::Vec3f& max, std::vector<int32_t>& result ) const
+    {
+        result.clear();
+        traverse( [&]( const cv::Vec3f& box_min, const cv::Vec3f& box_max ){
+                      return box_min[0] <= max[0] && min[0] <= box_max[0]
+                          && box_min[1] <= max[1] && min[1] <= box_max[1]
+                          && box_min[2] <= max[2] && min[2] <= box_max[2];
+                  },
+                  [&]( const cv::Vec3f& box_min, const cv::Vec3f& box_max ){
+                      return min[0] <= box_min[0] && box_max[0] <= max[0]
+                          && min[1] <= box_min[1] && box_max[1] <= max[1]
+                          && min[2] <= box_min[2] && box_max[2] <= max[2];
+                  },
+                  [&]( const cv::Vec3f& point ){
+                      return min[0] <= point[0] && point[0] <= max[0]
+                          && min[1] <= point[1] && point[1] <= max[1]
+                          && min[2] <= point[2] && point[2] <= max[2];
+                  },
+                  result );
+    }
+
+    // K Nearest Neighbor Search (Result is Sorted by Distance)
+    void knn_search( const cv::Vec3f& center, const size_t k, std::vector<int32_t>& result ) const
+    {
+        result.clear();
+        if( !size || !k ){
+            return;
+        }
+
+        // Best First Search of Nodes
+        typedef std::pair<float, node> candidate;
+        auto node_compare = []( const candidate& a, const candidate& b ){ return a.first > b.first; };
+        std::priority_queue<candidate, std::vector<candidate>, decltype( node_compare )> nodes( node_compare );
+        std::priority_queue<std::pair<float, int32_t>> neighbors;
+
+        nodes.push( candidate( 0.0f, node{ 0, 0, 0, size } ) );
+        while( !nodes.empty() ){
+            const candidate current = nodes.top();
+            nodes.pop();
+            if( neighbors.size() == k && neighbors.top().first <= current.first ){
+                break;
+            }
+
+            const node& n = current.second;
+            if( n.end - n.begin <= leaf_size || n.level == max_level ){
+                for( size_t i = n.begin; i < n.end; i++ ){
+                    const float distance = squared_distance( points[i], center );
+                    if( neighbors.size() < k ){
+                        neighbors.push( std::make_pair( distance, indices[i] ) );
+                    }
+                    else if( distance < neighbors.top().first ){
+                        neighbors.pop();
+                        neighbors.push( std::make_pair( distance, indices[i] ) );
+                    }
+                }
+                continue;
+            }
+
+            split( n, [&]( const node& child ){
+                cv::Vec3f box_min, box_max;
+                bounds( child, box_min, box_max );
+                nodes.push( candidate( squared_min_distance( box_min, box_max, center ), child ) );
+            } );
+        }
+
+        result.resize( neighbors.size() );
+        for( size_t i = neighbors.size(); i > 0; i-- ){
+            result[i - 1] = neighbors.top().second;
+            neighbors.pop();
+        }
+    }
+
+private:
+    static bool valid( const cv::Vec3f& point )
+    {
+        return !std::isnan( point[2] ) && point[2] != 0.0f;
+    }
+
+    // Spread 21bit to Every 3rd Bit
+    static uint64_t spread( uint64_t value )
+    {
+        value &= 0x1fffff;
+        value = ( value | value << 32 ) & 0x1f00000000ffffull;
+        value = ( value | value << 16 ) & 0x1f0000ff0000ffull;
+        value = ( value | value << 8 ) & 0x100f00f00f00f00full;
+        value = ( value | value << 4 ) & 0x10c30c30c30c30c3ull;
+        value = ( value | value << 2 ) & 0x1249249249249249ull;
+        return value;
+    }
+
+    // Compact Every 3rd Bit to 21bit
+    static uint32_t compact( uint64_t value )
+    {
+        value &= 0x1249249249249249ull;
+        value = ( value ^ ( value >> 2 ) ) & 0x10c30c30c30c30c3ull;
+        value = ( value ^ ( value >> 4 ) ) & 0x100f00f00f00f00full;
+        value = ( value ^ ( value >> 8 ) ) & 0x1f0000ff0000ffull;
+        value = ( value ^ ( value >> 16 ) ) & 0x1f00000000ffffull;
+        value = ( value ^ ( value >> 32 ) ) & 0x1fffff;
+        return static_cast<uint32_t>( value );
+    }
+
+    static uint64_t encode( uint32_t x, uint32_t y, uint32_t z )
+    {
+        return ( spread( x ) << 2 ) | ( spread( y ) << 1 ) | spread( z );
+    }
+
+    // Parallel LSD Radix Sort of Morton Code and Index (11bit Digit, 6 Passes)
+    void sort()
+    {
+        constexpr int32_t radix_bits = 11;
+        constexpr size_t radix = 1 << radix_bits;
+        const size_t num_points = codes.size();
+        temporary_codes.resize( num_points );
+        temporary_indices.resize( num_points );
+
+        #ifdef _OPENMP
+        histograms.assign( omp_get_max_threads() * radix, 0 );
+        #else
+        histograms.assign( radix, 0 );
+        #endif
+
+        uint64_t* source_codes = codes.data();
+        int32_t* source_indices = indices.data();
+        uint64_t* destination_codes = temporary_codes.data();
+        int32_t* destination_indices = temporary_indices.data();
+        bool skip = false;
+
+        #pragma omp parallel
+        {
+            #ifdef _OPENMP
+            const size_t thread = omp_get_thread_num();
+            const size_t num_threads = omp_get_num_threads();
+            #else
+            const size_t thread = 0;
+            const size_t num_threads = 1;
+            #endif
+            const size_t begin = num_points * thread / num_threads;
+            const size_t end = num_points * ( thread + 1 ) / num_threads;
+            size_t* histogram = &histograms[thread * radix];
+
+            for( int32_t shift = 0; shift < 64; shift += radix_bits ){
+                // Count Digits in Chunk of Thread
+                std::fill( histogram, histogram + radix, 0 );
+                for( size_t i = begin; i < end; i++ ){
+                    histogram[( source_codes[i] >> shift ) & ( radix - 1 )]++;
+                }
+
+                #pragma omp barrier
+                #pragma omp single
+                {
+                    // Calculate Scatter Offsets (Digit Major, Thread Minor for Stable Sort)
+                    // Pass is skipped when all points have same digit.
+                    size_t offset = 0;
+                    skip = false;
+                    for( size_t digit = 0; digit < radix; digit++ ){
+                        size_t digit_count = 0;
+                        for( size_t t = 0; t < num_threads; t++ ){
+                            const size_t count = histograms[t * radix + digit];
+                            histograms[t * radix + digit] = offset;
+                            offset += count;
+                            digit_count += count;
+                        }
+                        skip |= ( digit_count == num_points );
+                    }
+                }
+
+                if( skip ){
+                    continue;
+                }
+
+                // Scatter Chunk of Thread
+                for( size_t i = begin; i < end; i++ ){
+                    const size_t position = histogram[( source_codes[i] >> shift ) & ( radix - 1 )]++;
+                    destination_codes[position] = source_codes[i];
+                    destination_indices[position] = source_indices[i];
+                }
+
+                #pragma omp barrier
+                #pragma omp single
+                {
+                    std::swap( source_codes, destination_codes );
+                    std::swap( source_indices, destination_indices );
+                }
+            }
+        }
+
+        // Sorted Result is in Temporary Buffer when Odd Number of Passes are Executed
+        if( source_codes != codes.data() ){
+            codes.swap( temporary_codes );
+            indices.swap( temporary_indices );
+        }
+    }
+
+    // Calculate Bounding Box of Node
+    void bounds( const node& n, cv::Vec3f& box_min, cv::Vec3f& box_max ) const
+    {
+        const int32_t shift = max_level - n.level;
+        const uint64_t code = n.prefix << ( 3 * shift );
+        const float length = static_cast<float>( 1u << shift ) * cell_size;
+        box_min = cv::Vec3f( origin[0] + compact( code >> 2 ) * cell_size,
+                             origin[1] + compact( code >> 1 ) * cell_size,
+                             origin[2] + compact( code ) * cell_size );
+        box_max = box_min + cv::Vec3f( length, length, length );
+    }
+
+    // Split Node into Non-Empty Children
+    template<typename Function>
+    void split( const node& n, Function function ) const
+    {
+        const int32_t child_level = n.level + 1;
+        const int32_t shift = 3 * ( max_level - child_level );
+        size_t begin = n.begin;
+        for( uint64_t child = 0; child < 8; child++ ){
+            const uint64_t child_prefix = ( n.prefix << 3 ) | child;
+            const uint64_t last_code = ( ( child_prefix + 1 ) << shift ) - 1;
+            const size_t end = std::upper_bound( codes.begin() + begin, codes.begin() + n.end, last_code ) - codes.begin();
+            if( begin < end ){
+                function( node{ child_prefix, child_level, begin, end } );
+            }
+            begin = end;
+        }
+    }
+
+    // Depth First Traversal with Node Predicates (Overlap, Contain) and Point Predicate
+    template<typename Overlap, typename Contain, typename Test>
+    void traverse( Overlap overlap, Contain contain, Test test, std::vector<int32_t>& result ) const
+    {
+        if( !size ){
+            return;
+        }
+
+        std::vector<node> stack;
+        stack.push_back( node{ 0, 0, 0, size } );
+        while( !stack.empty() ){
+            const node n = stack.back();
+            stack.pop_back();
+
+            cv::Vec3f box_min, box_max;
+            bounds( n, box_min, box_max );
+            if( !overlap( box_min, box_max ) ){
+                continue;
+            }
+
+            if( contain( box_min, box_max ) ){
+                result.insert( result.end(), indices.begin() + n.begin, indices.begin() + n.end );
+                continue;
+            }
+
+            if( n.end - n.begin <= leaf_size || n.level == max_level ){
+                for( size_t i = n.begin; i < n.end; i++ ){
+                    if( test( points[i] ) ){
+                        result.push_back( indices[i] );
+                    }
+                }
+                continue;
+            }
+
+            split( n, [&]( const node& child ){ stack.push_back( child ); } );
+        }
+    }
+
+    static float squared_distance( const cv::Vec3f& a, const cv::Vec3f& b )
+    {
+        const float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    static float squared_min_distance( const cv::Vec3f& box_min, const cv::Vec3f& box_max, const cv::Vec3f& point )
+    {
+        float distance = 0.0f;
+        for( int32_t axis = 0; axis < 3; axis++ ){
+            const float d = std::max( { box_min[axis] - point[axis], 0.0f, point[axis] - box_max[axis] } );
+            distance += d * d;
+        }
+        return distance;
+    }
+
+    static float squared_max_distance( const cv::Vec3f& box_min, const cv::Vec3f& box_max, const cv::Vec3f& point )
+    {
+        float distance = 0.0f;
+        for( int32_t axis = 0; axis < 3; axis++ ){
+            const float d = std::max( std::abs( point[axis] - box_min[axis] ), std::abs( point[axis] - box_max[axis] ) );
+            distance += d * d;
+        }
+        return distance;
+    }
+};
+
+#endif // __LINEAR_OCTREE__
@@ -2,6 +2,9 @@
 
 #include <vector>
 #include <sstream>
+#include <iostream>
+#include <functional>
+#include <algorithm>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -52,6 +55,9 @@ void RealSense::initialize()
 
     // Initialize Point Cloud
     initializePointCloud();
+
+    // Initialize Downsampling
+    voxel_grid_filter.set_leaf_size( voxel_leaf_size );
 }
 
 // Initialize Sensor
@@ -62,8 +68,20 @@ inline void RealSense::initializeSensor()
     config.enable_stream( rs2_stream::RS2_STREAM_COLOR, color_width, color_height, rs2_format::RS2_FORMAT_BGR8, color_fps );
     config.enable_stream( rs2_stream::RS2_STREAM_DEPTH, depth_width, depth_height, rs2_format::RS2_FORMAT_Z16, depth_fps );
 
+#ifdef SYNTHETIC
+    // Use Synthetic Device instead of Live Device
+    synthetic.add_to( context );
+    pipeline = rs2::pipeline( context );
+    config.enable_device( synthetic.serial() );
+#endif
+
     // Start Pipeline
     pipeline_profile = pipeline.start( config );
+
+#ifdef SYNTHETIC
+    // Start Generating Frames of Synthetic Device
+    synthetic.start( pipeline_profile );
+#endif
 }
 
 // Initialize Point Cloud
@@ -93,9 +111,9 @@ void RealSense::keyboardCallback( const cv::viz::KeyboardEvent& event, void* coo
     }
     // Save Point Cloud to File when Pressed 's' key
     else if( event.code == 's' && event.action == cv::viz::KeyboardEvent::Action::KEY_DOWN ){
-        // Retrieve Point Cloud and Color
-        cv::Mat cloud = static_cast<RealSense*>( cookie )->vertices_mat;
-        cv::Mat color = static_cast<RealSense*>( cookie )->texture_mat;
+        // Retrieve Point Cloud and Color (Downsampled)
+        cv::Mat cloud = static_cast<RealSense*>( cookie )->downsampled_vertices_mat;
+        cv::Mat color = static_cast<RealSense*>( cookie )->downsampled_texture_mat;
 
         // Generate File Name
         static uint8_t i = 0;
@@ -106,6 +124,10 @@ void RealSense::keyboardCallback( const cv::viz::KeyboardEvent& event, void* coo
         // Write Point Cloud to File
         cv::viz::writeCloud( file, cloud, color, cv::noArray(), false );
     }
+    // Benchmark Spatial Index when Pressed 'b' key
+    else if( event.code == 'b' && event.action == cv::viz::KeyboardEvent::Action::KEY_DOWN ){
+        static_cast<RealSense*>( cookie )->benchmarkSpatialIndex();
+    }
 };
 
 // Finalize
@@ -114,6 +136,11 @@ void RealSense::finalize()
     // Close Windows
     cv::destroyAllWindows();
 
+#ifdef SYNTHETIC
+    // Stop Generating Frames of Synthetic Device before Pipeline
+    synthetic.stop();
+#endif
+
     // Stop Pipline
     pipeline.stop();
 }
@@ -184,6 +211,9 @@ void RealSense::draw()
 
     // Draw Point Cloud
     drawPointCloud();
+
+    // Downsample Point Cloud
+    downsamplePointCloud();
 }
 
 // Draw Color
@@ -231,6 +261,120 @@ inline void RealSense::drawPointCloud()
     }
 }
 
+// Downsample Point Cloud
+inline void RealSense::downsamplePointCloud()
+{
+    if( vertices_mat.empty() || texture_mat.empty() ){
+        return;
+    }
+
+    // Pass Through Point Cloud when Downsampling is Disabled
+    if( voxel_leaf_size <= 0.0f ){
+        downsampled_vertices_mat = vertices_mat;
+        downsampled_texture_mat = texture_mat;
+        return;
+    }
+
+    // Apply Voxel Grid Filter
+    voxel_grid_filter.filter( vertices_mat, texture_mat, downsampled_vertices_mat, downsampled_texture_mat );
+}
+
+// Build Spatial Index
+inline void RealSense::buildSpatialIndex()
+{
+    if( !enable_spatial_index || vertices_mat.empty() ){
+        return;
+    }
+
+    // Build Linear Octree over Point Cloud of This Frame
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    octree.build( vertices_mat );
+    build_time = std::chrono::steady_clock::now() - start;
+}
+
+// Benchmark Spatial Index
+void RealSense::benchmarkSpatialIndex()
+{
+    if( !enable_spatial_index ){
+        return;
+    }
+
+    // Build Spatial Index over Point Cloud of Current Frame (On Demand, not Every Frame)
+    buildSpatialIndex();
+    if( !octree.indexed() ){
+        return;
+    }
+
+    // Pick Query Points from Valid Points
+    std::vector<cv::Vec3f> queries;
+    const cv::Vec3f* vertices = vertices_mat.ptr<cv::Vec3f>();
+    const int32_t num_points = static_cast<int32_t>( vertices_mat.total() );
+    for( int32_t index = 0; index < num_points && queries.size() < 100; index += 997 ){
+        if( !std::isnan( vertices[index][2] ) ){
+            queries.push_back( vertices[index] );
+        }
+    }
+    if( queries.empty() ){
+        return;
+    }
+
+    constexpr float radius = 0.05f; // [m]
+    constexpr size_t k = 10;
+    const cv::Vec3f half_size( radius, radius, radius );
+
+    // Measure Query Throughput [queries/s]
+    typedef std::chrono::steady_clock clock;
+    const auto throughput = [&]( const std::function<void( const cv::Vec3f& )>& query ) -> double {
+        const clock::time_point start = clock::now();
+        for( const cv::Vec3f& point : queries ){
+            query( point );
+        }
+        return queries.size() / std::chrono::duration<double>( clock::now() - start ).count();
+    };
+
+    std::vector<int32_t> result;
+    const double octree_radius = throughput( [&]( const cv::Vec3f& center ){ octree.radius_search( center, radius, result ); } );
+    const double octree_knn = throughput( [&]( const cv::Vec3f& center ){ octree.knn_search( center, k, result ); } );
+    const double octree_box = throughput( [&]( const cv::Vec3f& center ){ octree.box_search( center - half_size, center + half_size, result ); } );
+
+    // Brute Force Search
+    const double brute_radius = throughput( [&]( const cv::Vec3f& center ){
+        result.clear();
+        for( int32_t index = 0; index < num_points; index++ ){
+            const cv::Vec3f difference = vertices[index] - center;
+            if( difference.dot( difference ) <= radius * radius ){
+                result.push_back( index );
+            }
+        }
+    } );
+    const double brute_knn = throughput( [&]( const cv::Vec3f& center ){
+        std::vector<std::pair<float, int32_t>> distances;
+        distances.reserve( num_points );
+        for( int32_t index = 0; index < num_points; index++ ){
+            if( !std::isnan( vertices[index][2] ) ){
+                const cv::Vec3f difference = vertices[index] - center;
+                distances.push_back( std::make_pair( difference.dot( difference ), index ) );
+            }
+        }
+        const size_t n = std::min( k, distances.size() );
+        std::partial_sort( distances.begin(), distances.begin() + n, distances.end() );
+    } );
+    const double brute_box = throughput( [&]( const cv::Vec3f& center ){
+        result.clear();
+        for( int32_t index = 0; index < num_points; index++ ){
+            const cv::Vec3f difference = vertices[index] - center;
+            if( std::abs( difference[0] ) <= radius && std::abs( difference[1] ) <= radius && std::abs( difference[2] ) <= radius ){
+                result.push_back( index );
+            }
+        }
+    } );
+
+    std::cout << "Spatial Index: " << octree.indexed() << " points, build " << std::chrono::duration<double, std::milli>( build_time ).count() << " ms" << std::endl;
+    std::cout << "  radius (" << radius << " m) : " << octree_radius << " queries/s (brute force " << brute_radius << " queries/s)" << std::endl;
+    std::cout << "  knn (k=" << k << ")       : " << octree_knn << " queries/s (brute force " << brute_knn << " queries/s)" << std::endl;
+    std::cout << "  box (" << radius * 2.0f << " m) : " << octree_box << " queries/s (brute force " << brute_box << " queries/s)" << std::endl;
+}
+
 // Show Data
 void RealSense::show()
 {
@@ -241,16 +385,16 @@ void RealSense::show()
 // Show Point Cloud
 inline void RealSense::showPointCloud()
 {
-    if( vertices_mat.empty() ){
+    if( downsampled_vertices_mat.empty() ){
         return;
     }
 
-    if( texture_mat.empty() ){
+    if( downsampled_texture_mat.empty() ){
         return;
     }
 
     // Create Point Cloud
-    cv::viz::WCloud cloud( vertices_mat, texture_mat );
+    cv::viz::WCloud cloud( downsampled_vertices_mat, downsampled_texture_mat );
 
     // Show Point Cloud
     viewer.showWidget( "Cloud", cloud );
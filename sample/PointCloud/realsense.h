@@ -5,9 +5,24 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/viz.hpp>
 
+#ifdef SYNTHETIC
+#include "synthetic_device.h"
+#endif
+
+#include "voxel_grid.h"
+#include "linear_octree.h"
+
+#include <chrono>
+
 class RealSense
 {
 private:
+#ifdef SYNTHETIC
+    // Synthetic Device
+    rs2::context context;
+    synthetic_device synthetic;
+#endif
+
     // RealSense
     rs2::pipeline pipeline;
     rs2::pipeline_profile pipeline_profile;
@@ -34,6 +49,17 @@ private:
     cv::Mat vertices_mat;
     cv::Mat texture_mat;
 
+    // Downsampling Buffer
+    voxel_grid voxel_grid_filter;
+    float voxel_leaf_size = 0.01f; // [m] (0.0 is disable downsampling)
+    cv::Mat downsampled_vertices_mat;
+    cv::Mat downsampled_texture_mat;
+
+    // Spatial Index
+    linear_octree octree;
+    bool enable_spatial_index = true; // built on demand when pressed 'b' key
+    std::chrono::steady_clock::duration build_time;
+
 public:
     // Constructor
     RealSense();
@@ -89,6 +115,15 @@ private:
     // Draw Point Cloud
     inline void drawPointCloud();
 
+    // Downsample Point Cloud
+    inline void downsamplePointCloud();
+
+    // Build Spatial Index
+    inline void buildSpatialIndex();
+
+    // Benchmark Spatial Index
+    void benchmarkSpatialIndex();
+
     // Show Data
     void show();
 
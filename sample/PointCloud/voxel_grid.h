@@ -0,0 +1,154 @@
+// This is minimum implementation of voxel grid downsampling filter.
+// Points are quantized to voxels of leaf size, and each voxel is replaced by centroid and average color of its points.
+// Voxels are accumulated in hash tables partitioned by voxel key, so that each thread owns disjoint voxels without locking.
+
+#ifndef __VOXEL_GRID__
+#define __VOXEL_GRID__
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+class voxel_grid
+{
+private:
+    struct voxel
+    {
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+        uint32_t b = 0, g = 0, r = 0;
+        uint32_t count = 0;
+    };
+
+    float leaf_size;
+    std::vector<uint64_t> keys;
+    std::vector<std::unordered_map<uint64_t, voxel>> voxels;
+    std::vector<size_t> offsets;
+
+    static constexpr uint64_t invalid_key = ~0ull;
+
+public:
+    voxel_grid( float leaf_size = 0.01f )
+        : leaf_size( leaf_size )
+    {
+    }
+
+    void set_leaf_size( float size )
+    {
+        leaf_size = size;
+    }
+
+    float get_leaf_size() const
+    {
+        return leaf_size;
+    }
+
+    // Downsample organized or unorganized point cloud (CV_32FC3) and its texture (CV_8UC3)
+    // Filtered point cloud and texture are 1xN matrices.
+    void filter( const cv::Mat& vertices, const cv::Mat& texture, cv::Mat& filtered_vertices, cv::Mat& filtered_texture )
+    {
+        CV_Assert( vertices.type() == CV_32FC3 && vertices.isContinuous() );
+        CV_Assert( texture.type() == CV_8UC3 && texture.isContinuous() && texture.total() == vertices.total() );
+        CV_Assert( leaf_size > 0.0f );
+
+        const int32_t num_points = static_cast<int32_t>( vertices.total() );
+        const cv::Vec3f* points = vertices.ptr<cv::Vec3f>();
+        const cv::Vec3b* colors = texture.ptr<cv::Vec3b>();
+        const float inverse_leaf_size = 1.0f / leaf_size;
+
+        // Quantize Points to Voxel Keys
+        keys.resize( num_points );
+        #pragma omp parallel for
+        for( int32_t index = 0; index < num_points; index++ ){
+            const cv::Vec3f& point = points[index];
+            if( std::isnan( point[2] ) || point[2] == 0.0f ){
+                keys[index] = invalid_key;
+                continue;
+            }
+
+            keys[index] = key( static_cast<int32_t>( std::floor( point[0] * inverse_leaf_size ) ),
+                               static_cast<int32_t>( std::floor( point[1] * inverse_leaf_size ) ),
+                               static_cast<int32_t>( std::floor( point[2] * inverse_leaf_size ) ) );
+        }
+
+        // Prepare Hash Table per Partition
+        #ifdef _OPENMP
+        const int32_t num_partitions = omp_get_max_threads();
+        #else
+        const int32_t num_partitions = 1;
+        #endif
+        voxels.resize( num_partitions );
+        offsets.assign( num_partitions + 1, 0 );
+
+        // Accumulate Points into Voxels of Each Partition
+        #pragma omp parallel for schedule( static, 1 )
+        for( int32_t part = 0; part < num_partitions; part++ ){
+            std::unordered_map<uint64_t, voxel>& table = voxels[part];
+            table.clear();
+            for( int32_t index = 0; index < num_points; index++ ){
+                const uint64_t voxel_key = keys[index];
+                if( voxel_key == invalid_key || partition( voxel_key, num_partitions ) != part ){
+                    continue;
+                }
+
+                voxel& v = table[voxel_key];
+                const cv::Vec3f& point = points[index];
+                const cv::Vec3b& color = colors[index];
+                v.x += point[0]; v.y += point[1]; v.z += point[2];
+                v.b += color[0]; v.g += color[1]; v.r += color[2];
+                v.count++;
+            }
+            offsets[part + 1] = table.size();
+        }
+
+        // Allocate Output Buffer
+        for( int32_t part = 0; part < num_partitions; part++ ){
+            offsets[part + 1] += offsets[part];
+        }
+        filtered_vertices.create( 1, static_cast<int32_t>( offsets[num_partitions] ), CV_32FC3 );
+        filtered_texture.create( 1, static_cast<int32_t>( offsets[num_partitions] ), CV_8UC3 );
+        if( offsets[num_partitions] == 0 ){
+            return;
+        }
+
+        // Write Centroid and Average Color of Voxels
+        #pragma omp parallel for schedule( static, 1 )
+        for( int32_t part = 0; part < num_partitions; part++ ){
+            cv::Vec3f* filtered_points = filtered_vertices.ptr<cv::Vec3f>() + offsets[part];
+            cv::Vec3b* filtered_colors = filtered_texture.ptr<cv::Vec3b>() + offsets[part];
+            for( const std::pair<const uint64_t, voxel>& pair : voxels[part] ){
+                const voxel& v = pair.second;
+                const float inverse_count = 1.0f / static_cast<float>( v.count );
+                *filtered_points++ = cv::Vec3f( v.x * inverse_count, v.y * inverse_count, v.z * inverse_count );
+                *filtered_colors++ = cv::Vec3b( static_cast<uint8_t>( v.b / v.count ), static_cast<uint8_t>( v.g / v.count ), static_cast<uint8_t>( v.r / v.count ) );
+            }
+        }
+    }
+
+private:
+    // Pack Voxel Index into 64bit Key (21bit per Axis)
+    static uint64_t key( int32_t x, int32_t y, int32_t z )
+    {
+        constexpr int32_t offset = 1 << 20;
+        constexpr uint64_t mask = ( 1ull << 21 ) - 1;
+        return ( ( static_cast<uint64_t>( x + offset ) & mask ) << 42 )
+             | ( ( static_cast<uint64_t>( y + offset ) & mask ) << 21 )
+             | ( ( static_cast<uint64_t>( z + offset ) & mask ) );
+    }
+
+    // Assign Voxel Key to Thread
+    static int32_t partition( uint64_t voxel_key, int32_t num_threads )
+    {
+        voxel_key ^= voxel_key >> 33;
+        voxel_key *= 0xff51afd7ed558ccdull;
+        voxel_key ^= voxel_key >> 33;
+        return static_cast<int32_t>( voxel_key % static_cast<uint64_t>( num_threads ) );
+    }
+};
+
+#endif // __VOXEL_GRID__
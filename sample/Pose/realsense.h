@@ -5,11 +5,21 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/viz.hpp>
 
+#ifdef SYNTHETIC
+#include "synthetic_device.h"
+#endif
+
 #include "circular_buffer.h"
 
 class RealSense
 {
 private:
+#ifdef SYNTHETIC
+    // Synthetic Device
+    rs2::context context;
+    synthetic_device synthetic;
+#endif
+
     // RealSense
     rs2::pipeline pipeline;
     rs2::pipeline_profile pipeline_profile;
@@ -0,0 +1,246 @@
+#include "realsense.h"
+
+#include <csignal>
+
+// Stop Requested by Signal (SIGINT, SIGTERM)
+// Main loop has no other exit without preview, so destructor (shm_unlink) runs by signal.
+static volatile std::sig_atomic_t stop_requested = 0;
+static void requestStop( int )
+{
+    stop_requested = 1;
+}
+
+// Constructor
+RealSense::RealSense()
+{
+    // Initialize
+    initialize();
+}
+
+// Destructor
+RealSense::~RealSense()
+{
+    // Finalize
+    finalize();
+}
+
+// Processing
+void RealSense::run()
+{
+    // Main Loop (Until Stop is Requested by Signal or Key)
+    while( !stop_requested ){
+        // Update Data
+        update();
+
+        // Publish Data
+        publish();
+
+        if( !enable_preview ){
+            continue;
+        }
+
+        // Draw Data
+        draw();
+
+        // Show Data
+        show();
+
+        // Key Check
+        const int32_t key = cv::waitKey( 1 );
+        if( key == 'q' ){
+            break;
+        }
+    }
+}
+
+// Initialize
+void RealSense::initialize()
+{
+    cv::setUseOptimized( true );
+
+    // Stop Main Loop by Signal
+    std::signal( SIGINT, requestStop );
+    std::signal( SIGTERM, requestStop );
+
+    // Initialize Sensor
+    initializeSensor();
+
+    // Initialize Publisher
+    initializePublisher();
+}
+
+// Initialize Sensor
+inline void RealSense::initializeSensor()
+{
+    // Set Device Config
+    rs2::config config;
+    config.enable_stream( rs2_stream::RS2_STREAM_COLOR, color_width, color_height, rs2_format::RS2_FORMAT_BGR8, color_fps );
+    config.enable_stream( rs2_stream::RS2_STREAM_DEPTH, depth_width, depth_height, rs2_format::RS2_FORMAT_Z16, depth_fps );
+
+#ifdef SYNTHETIC
+    // Use Synthetic Device instead of Live Device
+    synthetic.add_to( context );
+    pipeline = rs2::pipeline( context );
+    config.enable_device( synthetic.serial() );
+#endif
+
+    // Start Pipeline
+    pipeline_profile = pipeline.start( config );
+
+#ifdef SYNTHETIC
+    // Start Generating Frames of Synthetic Device
+    synthetic.start( pipeline_profile );
+#endif
+}
+
+// Initialize Publisher
+inline void RealSense::initializePublisher()
+{
+    // Create Shared Memory Frame Ring for Each Stream
+    // Slot size is decided from resolution of stream. (BGR8 is 3 bytes, Z16 is 2 bytes per pixel)
+    color_writer.reset( new shared_frame_writer( color_shared_name, color_width * color_height * 3, num_slots ) );
+    depth_writer.reset( new shared_frame_writer( depth_shared_name, depth_width * depth_height * 2, num_slots ) );
+}
+
+// Finalize
+void RealSense::finalize()
+{
+    // Close Windows
+    cv::destroyAllWindows();
+
+#ifdef SYNTHETIC
+    // Stop Generating Frames of Synthetic Device before Pipeline
+    synthetic.stop();
+#endif
+
+    // Stop Pipline
+    pipeline.stop();
+
+    // Remove Shared Memory
+    color_writer.reset();
+    depth_writer.reset();
+}
+
+// Update Data
+void RealSense::update()
+{
+    // Update Frame
+    updateFrame();
+
+    // Update Color
+    updateColor();
+
+    // Update Depth
+    updateDepth();
+}
+
+// Update Frame
+inline void RealSense::updateFrame()
+{
+    // Update Frame
+    frameset = pipeline.wait_for_frames();
+}
+
+// Update Color
+inline void RealSense::updateColor()
+{
+    // Retrieve Color Flame
+    color_frame = frameset.get_color_frame();
+
+    // Retrive Frame Size
+    color_width = color_frame.as<rs2::video_frame>().get_width();
+    color_height = color_frame.as<rs2::video_frame>().get_height();
+}
+
+// Update Depth
+inline void RealSense::updateDepth()
+{
+    // Retrieve Depth Flame
+    depth_frame = frameset.get_depth_frame();
+
+    // Retrive Frame Size
+    depth_width = depth_frame.as<rs2::video_frame>().get_width();
+    depth_height = depth_frame.as<rs2::video_frame>().get_height();
+}
+
+// Publish Data
+void RealSense::publish()
+{
+    // Publish Color
+    publishFrame( *color_writer, color_frame );
+
+    // Publish Depth
+    publishFrame( *depth_writer, depth_frame );
+}
+
+// Publish Frame
+inline void RealSense::publishFrame( shared_frame_writer& writer, const rs2::frame& frame )
+{
+    if( !frame ){
+        return;
+    }
+
+    // Write Frame into Shared Memory Frame Ring (Once, Regardless of Number of Consumers)
+    const rs2::video_frame video_frame = frame.as<rs2::video_frame>();
+    writer.write( video_frame.get_data(), video_frame.get_width(), video_frame.get_height(), video_frame.get_bytes_per_pixel(), video_frame.get_stride_in_bytes(), video_frame.get_frame_number(), video_frame.get_timestamp() );
+}
+
+// Draw Data
+void RealSense::draw()
+{
+    // Draw Color
+    drawColor();
+
+    // Draw Depth
+    drawDepth();
+}
+
+// Draw Color
+inline void RealSense::drawColor()
+{
+    // Create cv::Mat form Color Frame
+    color_mat = cv::Mat( color_height, color_width, CV_8UC3, const_cast<void*>( color_frame.get_data() ) );
+}
+
+// Draw Depth
+inline void RealSense::drawDepth()
+{
+    // Create cv::Mat form Depth Frame
+    depth_mat = cv::Mat( depth_height, depth_width, CV_16SC1, const_cast<void*>( depth_frame.get_data() ) );
+}
+
+// Show Data
+void RealSense::show()
+{
+    // Show Color
+    showColor();
+
+    // Show Depth
+    showDepth();
+}
+
+// Show Color
+inline void RealSense::showColor()
+{
+    if( color_mat.empty() ){
+        return;
+    }
+
+    // Show Color Image
+    cv::imshow( "Color", color_mat );
+}
+
+// Show Depth
+inline void RealSense::showDepth()
+{
+    if( depth_mat.empty() ){
+        return;
+    }
+
+    // Scaling
+    cv::Mat scale_mat;
+    depth_mat.convertTo( scale_mat, CV_8U, -255.0 / 10000.0, 255.0 ); // 0-10000 -> 255(white)-0(black)
+
+    // Show Depth Image
+    cv::imshow( "Depth", scale_mat );
+}
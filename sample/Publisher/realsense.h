@@ -0,0 +1,114 @@
+#ifndef __REALSENSE__
+#define __REALSENSE__
+
+#include <librealsense2/rs.hpp>
+#include <opencv2/opencv.hpp>
+
+#ifdef SYNTHETIC
+#include "synthetic_device.h"
+#endif
+
+#include "shared_frame_ring.h"
+
+#include <memory>
+#include <string>
+
+class RealSense
+{
+private:
+#ifdef SYNTHETIC
+    // Synthetic Device
+    rs2::context context;
+    synthetic_device synthetic;
+#endif
+
+    // RealSense
+    rs2::pipeline pipeline;
+    rs2::pipeline_profile pipeline_profile;
+    rs2::frameset frameset;
+
+    // Color Buffer
+    rs2::frame color_frame;
+    cv::Mat color_mat;
+    uint32_t color_width = 640;
+    uint32_t color_height = 480;
+    uint32_t color_fps = 30;
+
+    // Depth Buffer
+    rs2::frame depth_frame;
+    cv::Mat depth_mat;
+    uint32_t depth_width = 640;
+    uint32_t depth_height = 480;
+    uint32_t depth_fps = 30;
+
+    // Publisher
+    std::unique_ptr<shared_frame_writer> color_writer;
+    std::unique_ptr<shared_frame_writer> depth_writer;
+    std::string color_shared_name = "/realsense_color";
+    std::string depth_shared_name = "/realsense_depth";
+    uint32_t num_slots = 4;
+
+    // Preview (Publisher keeps running without window)
+    bool enable_preview = true;
+
+public:
+    // Constructor
+    RealSense();
+
+    // Destructor
+    ~RealSense();
+
+    // Processing
+    void run();
+
+private:
+    // Initialize
+    void initialize();
+
+    // Initialize Sensor
+    inline void initializeSensor();
+
+    // Initialize Publisher
+    inline void initializePublisher();
+
+    // Finalize
+    void finalize();
+
+    // Update Data
+    void update();
+
+    // Update Frame
+    inline void updateFrame();
+
+    // Update Color
+    inline void updateColor();
+
+    // Update Depth
+    inline void updateDepth();
+
+    // Publish Data
+    void publish();
+
+    // Publish Frame
+    inline void publishFrame( shared_frame_writer& writer, const rs2::frame& frame );
+
+    // Draw Data
+    void draw();
+
+    // Draw Color
+    inline void drawColor();
+
+    // Draw Depth
+    inline void drawDepth();
+
+    // Show Data
+    void show();
+
+    // Show Color
+    inline void showColor();
+
+    // Show Depth
+    inline void showDepth();
+};
+
+#endif // __REALSENSE__
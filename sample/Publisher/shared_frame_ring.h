@@ -0,0 +1,293 @@
+// This is minimum implementation of shared memory frame ring for multiple local consumer processes (POSIX).
+// Producer writes each frame once into fixed slots of ring, and never waits for consumers.
+// Each slot is protected by sequence lock. Sequence is odd while slot is being written, and consumer validates that sequence is unchanged after reading.
+// Consumer can read slot in place (zero-copy), but it must check validate() before using the result.
+
+#ifndef __SHARED_FRAME_RING__
+#define __SHARED_FRAME_RING__
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace shared_frame
+{
+    static constexpr uint32_t magic = 0x52533246; // "RS2F"
+    static constexpr uint32_t version = 1;
+    static constexpr size_t alignment = 64;
+
+    // Header of Ring
+    struct ring_header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t num_slots;
+        uint32_t slot_size;
+        alignas( alignment ) std::atomic<uint64_t> write_count;
+    };
+
+    // Header of Slot
+    struct slot_header
+    {
+        std::atomic<uint64_t> sequence;
+        uint64_t frame_number;
+        double timestamp;
+        uint32_t width;
+        uint32_t height;
+        uint32_t bytes_per_pixel;
+        uint32_t stride;
+        uint32_t size;
+    };
+
+    static_assert( sizeof( std::atomic<uint64_t> ) == sizeof( uint64_t ) && ATOMIC_LLONG_LOCK_FREE == 2, "lock-free 64bit atomic is required for shared memory" );
+
+    inline size_t align( const size_t size )
+    {
+        return ( size + alignment - 1 ) / alignment * alignment;
+    }
+
+    inline size_t header_size()
+    {
+        return align( sizeof( ring_header ) );
+    }
+
+    inline size_t slot_stride( const uint32_t slot_size )
+    {
+        return align( sizeof( slot_header ) ) + align( slot_size );
+    }
+
+    inline size_t mapping_size( const uint32_t num_slots, const uint32_t slot_size )
+    {
+        return header_size() + slot_stride( slot_size ) * num_slots;
+    }
+
+    // View of Frame in Shared Memory
+    struct frame_view
+    {
+        const uint8_t* data = nullptr;
+        uint64_t sequence = 0;
+        uint64_t frame_number = 0;
+        double timestamp = 0.0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t bytes_per_pixel = 0;
+        uint32_t stride = 0;
+        uint32_t size = 0;
+        uint32_t slot = 0;
+    };
+}
+
+// Producer of Shared Memory Frame Ring
+class shared_frame_writer
+{
+private:
+    std::string name;
+    uint8_t* mapping = nullptr;
+    size_t length = 0;
+    shared_frame::ring_header* header = nullptr;
+
+public:
+    shared_frame_writer( const std::string& name, const uint32_t slot_size, const uint32_t num_slots = 4 )
+        : name( name )
+    {
+        // Create Shared Memory (Owner Only, Consumers of Same User Open It Read-Only)
+        // Mode of memory left by previous run is also restricted, because O_CREAT doesn't change mode of existing memory.
+        const int fd = shm_open( name.c_str(), O_CREAT | O_RDWR, 0600 );
+        if( fd < 0 ){
+            throw std::runtime_error( "failed to create shared memory " + name );
+        }
+        if( fchmod( fd, 0600 ) != 0 ){
+            close( fd );
+            throw std::runtime_error( "failed to restrict shared memory " + name );
+        }
+
+        length = shared_frame::mapping_size( num_slots, slot_size );
+        if( ftruncate( fd, static_cast<off_t>( length ) ) != 0 ){
+            close( fd );
+            throw std::runtime_error( "failed to resize shared memory " + name );
+        }
+
+        void* address = mmap( nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        close( fd );
+        if( address == MAP_FAILED ){
+            throw std::runtime_error( "failed to map shared memory " + name );
+        }
+        mapping = static_cast<uint8_t*>( address );
+
+        // Initialize Header (Magic is Written Last to Publish Ring)
+        header = reinterpret_cast<shared_frame::ring_header*>( mapping );
+        header->magic = 0;
+        header->version = shared_frame::version;
+        header->num_slots = num_slots;
+        header->slot_size = slot_size;
+        header->write_count.store( 0, std::memory_order_relaxed );
+        for( uint32_t i = 0; i < num_slots; i++ ){
+            slot( i )->sequence.store( 0, std::memory_order_relaxed );
+        }
+        std::atomic_thread_fence( std::memory_order_release );
+        header->magic = shared_frame::magic;
+    }
+
+    ~shared_frame_writer()
+    {
+        if( mapping ){
+            munmap( mapping, length );
+            shm_unlink( name.c_str() );
+        }
+    }
+
+    shared_frame_writer( const shared_frame_writer& ) = delete;
+    shared_frame_writer& operator=( const shared_frame_writer& ) = delete;
+
+    // Write Frame into Next Slot (Never Blocks)
+    void write( const void* data, const uint32_t width, const uint32_t height, const uint32_t bytes_per_pixel, const uint32_t stride, const uint64_t frame_number, const double timestamp )
+    {
+        const uint32_t size = stride * height;
+        if( size > header->slot_size ){
+            throw std::runtime_error( "frame is larger than slot of " + name );
+        }
+
+        const uint64_t count = header->write_count.load( std::memory_order_relaxed );
+        shared_frame::slot_header* target = slot( static_cast<uint32_t>( count % header->num_slots ) );
+
+        // Mark Slot as Writing (Odd Sequence)
+        target->sequence.store( count * 2 + 1, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+
+        // Write Frame
+        target->frame_number = frame_number;
+        target->timestamp = timestamp;
+        target->width = width;
+        target->height = height;
+        target->bytes_per_pixel = bytes_per_pixel;
+        target->stride = stride;
+        target->size = size;
+        std::memcpy( payload( target ), data, size );
+
+        // Mark Slot as Written (Even Sequence) and Publish
+        target->sequence.store( count * 2 + 2, std::memory_order_release );
+        header->write_count.store( count + 1, std::memory_order_release );
+    }
+
+private:
+    shared_frame::slot_header* slot( const uint32_t index ) const
+    {
+        return reinterpret_cast<shared_frame::slot_header*>( mapping + shared_frame::header_size() + shared_frame::slot_stride( header->slot_size ) * index );
+    }
+
+    static uint8_t* payload( shared_frame::slot_header* target )
+    {
+        return reinterpret_cast<uint8_t*>( target ) + shared_frame::align( sizeof( shared_frame::slot_header ) );
+    }
+};
+
+// Consumer of Shared Memory Frame Ring
+class shared_frame_reader
+{
+private:
+    std::string name;
+    const uint8_t* mapping = nullptr;
+    size_t length = 0;
+    const shared_frame::ring_header* header = nullptr;
+
+public:
+    shared_frame_reader( const std::string& name )
+        : name( name )
+    {
+        // Open Shared Memory (Read Only)
+        const int fd = shm_open( name.c_str(), O_RDONLY, 0 );
+        if( fd < 0 ){
+            throw std::runtime_error( "failed to open shared memory " + name );
+        }
+
+        struct stat status;
+        if( fstat( fd, &status ) != 0 || static_cast<size_t>( status.st_size ) < shared_frame::header_size() ){
+            close( fd );
+            throw std::runtime_error( "invalid shared memory " + name );
+        }
+        length = static_cast<size_t>( status.st_size );
+
+        void* address = mmap( nullptr, length, PROT_READ, MAP_SHARED, fd, 0 );
+        close( fd );
+        if( address == MAP_FAILED ){
+            throw std::runtime_error( "failed to map shared memory " + name );
+        }
+        mapping = static_cast<const uint8_t*>( address );
+
+        // Check Header
+        header = reinterpret_cast<const shared_frame::ring_header*>( mapping );
+        if( header->magic != shared_frame::magic || header->version != shared_frame::version || length < shared_frame::mapping_size( header->num_slots, header->slot_size ) ){
+            munmap( const_cast<uint8_t*>( mapping ), length );
+            throw std::runtime_error( "incompatible shared memory " + name );
+        }
+        std::atomic_thread_fence( std::memory_order_acquire );
+    }
+
+    ~shared_frame_reader()
+    {
+        if( mapping ){
+            munmap( const_cast<uint8_t*>( mapping ), length );
+        }
+    }
+
+    shared_frame_reader( const shared_frame_reader& ) = delete;
+    shared_frame_reader& operator=( const shared_frame_reader& ) = delete;
+
+    // Retrieve Number of Frames Written by Producer
+    uint64_t written() const
+    {
+        return header->write_count.load( std::memory_order_acquire );
+    }
+
+    // Acquire View of Latest Frame (Zero-Copy)
+    // Returns false if no frame is available, or if producer is overwriting slot at the moment.
+    bool latest( shared_frame::frame_view& view ) const
+    {
+        const uint64_t count = header->write_count.load( std::memory_order_acquire );
+        if( !count ){
+            return false;
+        }
+
+        const uint32_t index = static_cast<uint32_t>( ( count - 1 ) % header->num_slots );
+        const shared_frame::slot_header* source = slot( index );
+        const uint64_t sequence = source->sequence.load( std::memory_order_acquire );
+        if( sequence & 1 ){
+            return false;
+        }
+
+        view.sequence = sequence;
+        view.slot = index;
+        view.frame_number = source->frame_number;
+        view.timestamp = source->timestamp;
+        view.width = source->width;
+        view.height = source->height;
+        view.bytes_per_pixel = source->bytes_per_pixel;
+        view.stride = source->stride;
+        view.size = source->size;
+        view.data = reinterpret_cast<const uint8_t*>( source ) + shared_frame::align( sizeof( shared_frame::slot_header ) );
+
+        return validate( view ) && view.size <= header->slot_size;
+    }
+
+    // Validate that View was Not Overwritten while Reading
+    bool validate( const shared_frame::frame_view& view ) const
+    {
+        std::atomic_thread_fence( std::memory_order_acquire );
+        return slot( view.slot )->sequence.load( std::memory_order_relaxed ) == view.sequence;
+    }
+
+private:
+    const shared_frame::slot_header* slot( const uint32_t index ) const
+    {
+        return reinterpret_cast<const shared_frame::slot_header*>( mapping + shared_frame::header_size() + shared_frame::slot_stride( header->slot_size ) * index );
+    }
+};
+
+#endif // __SHARED_FRAME_RING__
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <sstream>
+
+#include <opencv2/opencv.hpp>
+
+#include "shared_frame_ring.h"
+
+// Example of consumer process that attaches to frame rings of Publisher
+int main( int argc, char* argv[] )
+{
+    try{
+        // Attach to Shared Memory Frame Ring
+        shared_frame_reader color_reader( "/realsense_color" );
+        shared_frame_reader depth_reader( "/realsense_depth" );
+
+        uint64_t color_sequence = 0;
+        uint64_t depth_sequence = 0;
+
+        // Main Loop
+        while( true ){
+            shared_frame::frame_view view;
+
+            // Show Color Image when New Frame is Available
+            if( color_reader.latest( view ) && view.sequence != color_sequence ){
+                // Wrap Shared Memory without Copy, then Validate after Use
+                const cv::Mat color_mat( view.height, view.width, CV_8UC3, const_cast<uint8_t*>( view.data ), view.stride );
+                cv::Mat show_mat;
+                color_mat.copyTo( show_mat );
+                if( color_reader.validate( view ) ){
+                    cv::imshow( "Color (Subscriber)", show_mat );
+                    color_sequence = view.sequence;
+                }
+            }
+
+            // Show Depth Image when New Frame is Available
+            if( depth_reader.latest( view ) && view.sequence != depth_sequence ){
+                // Scaling Reads Shared Memory Directly
+                const cv::Mat depth_mat( view.height, view.width, CV_16UC1, const_cast<uint8_t*>( view.data ), view.stride );
+                cv::Mat scale_mat;
+                depth_mat.convertTo( scale_mat, CV_8U, -255.0 / 10000.0, 255.0 ); // 0-10000 -> 255(white)-0(black)
+                if( depth_reader.validate( view ) ){
+                    cv::imshow( "Depth (Subscriber)", scale_mat );
+                    depth_sequence = view.sequence;
+                }
+            }
+
+            // Key Check
+            const int32_t key = cv::waitKey( 1 );
+            if( key == 'q' ){
+                break;
+            }
+        }
+    } catch( std::exception& ex ){
+        std::cout << ex.what() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+// This is minimum implementation of bounded blocking queue.
+// Producer waits while queue is full (backpressure) instead of dropping, and consumer waits while queue is empty.
+// Closing queue releases both of them, consumer can still pop remaining items after close.
+
+#ifndef __BOUNDED_QUEUE__
+#define __BOUNDED_QUEUE__
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#include <cstddef>
+
+template<typename T>
+class bounded_queue
+{
+private:
+    std::deque<T> queue;
+    size_t capacity;
+    bool closed = false;
+    mutable std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+
+public:
+    explicit bounded_queue( const size_t capacity = 8 )
+        : capacity( capacity > 0 ? capacity : 1 )
+    {
+    }
+
+    bounded_queue( const bounded_queue& ) = delete;
+    bounded_queue& operator=( const bounded_queue& ) = delete;
+
+    // Push Item (Wait while Full, Return false if Closed)
+    bool push( T value )
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        not_full.wait( lock, [this]{ return closed || queue.size() < capacity; } );
+        if( closed ){
+            return false;
+        }
+        queue.push_back( std::move( value ) );
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Pop Item (Wait while Empty, Return false if Closed and Drained)
+    bool pop( T& value )
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        not_empty.wait( lock, [this]{ return closed || !queue.empty(); } );
+        if( queue.empty() ){
+            return false;
+        }
+        value = std::move( queue.front() );
+        queue.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Close Queue (Release Waiting Producers and Consumers)
+    void close()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        closed = true;
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+    // Reopen Closed Queue (Remaining Items are Discarded)
+    void reopen()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        queue.clear();
+        closed = false;
+    }
+
+    bool is_closed() const
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        return closed;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        return queue.size();
+    }
+};
+
+#endif // __BOUNDED_QUEUE__
\ No newline at end of file
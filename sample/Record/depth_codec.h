@@ -0,0 +1,416 @@
+// This is minimum implementation of lossless depth codec based on RVL (Run length Variable Length).
+// A. D. Wilson, "Fast Lossless Depth Image Compression", ISS 2017.
+// Runs of zero (invalid) pixels and runs of valid pixels are encoded alternately.
+// Valid pixels are encoded as zigzag delta from previous valid pixel, with variable length code of 3bit nibbles.
+// Nibbles are packed from least significant bit of 32bit words (original RVL packs from most significant bit), so streams are not compatible with original implementation.
+// Tiled mode splits image into horizontal tiles that are encoded and decoded independently in parallel.
+
+#ifndef __DEPTH_CODEC__
+#define __DEPTH_CODEC__
+
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define DEPTH_CODEC_SSE2
+#endif
+
+namespace depth_codec
+{
+    // Number of Trailing Zero Bits (Value must be Non-Zero)
+    inline uint32_t trailing_zeros( const uint32_t value )
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward( &index, value );
+        return static_cast<uint32_t>( index );
+#else
+        return static_cast<uint32_t>( __builtin_ctz( value ) );
+#endif
+    }
+
+    // Number of Significant Bits (Zero is 1bit)
+    inline uint32_t bit_length( const uint32_t value )
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse( &index, value | 1 );
+        return static_cast<uint32_t>( index ) + 1;
+#else
+        return 32 - static_cast<uint32_t>( __builtin_clz( value | 1 ) );
+#endif
+    }
+
+    // Find First Pixel that is Zero (zero = true) or Non-Zero (zero = false)
+    inline const uint16_t* find( const uint16_t* begin, const uint16_t* end, const bool zero )
+    {
+#ifdef DEPTH_CODEC_SSE2
+        const __m128i zeros = _mm_setzero_si128();
+        const int32_t mask = zero ? 0 : 0xffff;
+        for( ; begin + 8 <= end; begin += 8 ){
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( begin ) );
+            const int32_t found = _mm_movemask_epi8( _mm_cmpeq_epi16( pixels, zeros ) ) ^ mask;
+            if( found ){
+                return begin + trailing_zeros( static_cast<uint32_t>( found ) ) / 2;
+            }
+        }
+#endif
+        for( ; begin != end && ( *begin == 0 ) != zero; begin++ );
+        return begin;
+    }
+
+    // Spread 18bit Value into 6 Nibbles of 3bit (Continuation Bits are Cleared)
+    inline uint32_t spread( const uint32_t value )
+    {
+        return ( value & 0x7 ) | ( ( value & 0x38 ) << 1 ) | ( ( value & 0x1c0 ) << 2 ) | ( ( value & 0xe00 ) << 3 ) | ( ( value & 0x7000 ) << 4 ) | ( ( value & 0x38000 ) << 5 );
+    }
+
+    // Compact 6 Nibbles of 3bit into 18bit Value (Continuation Bits are Ignored)
+    inline uint32_t compact( const uint32_t code )
+    {
+        return ( code & 0x7 ) | ( ( code >> 1 ) & 0x38 ) | ( ( code >> 2 ) & 0x1c0 ) | ( ( code >> 3 ) & 0xe00 ) | ( ( code >> 4 ) & 0x7000 ) | ( ( code >> 5 ) & 0x38000 );
+    }
+
+    // Code Table of Short Values
+    // Encode : value -> code (lower 24bit) and length in bits (upper 8bit)
+    // Decode : lower 3 nibbles of stream -> value (lower 24bit) and length in bits (upper 8bit, 0 if value is longer than 3 nibbles)
+    struct code_table
+    {
+        static constexpr uint32_t size = 4096;
+        uint32_t codes[size];
+        uint32_t values[size];
+
+        code_table()
+        {
+            for( uint32_t value = 0; value < size; value++ ){
+                const uint32_t count = ( bit_length( value ) + 2 ) / 3;
+                const uint32_t continuation = 0x888888 & ( ( 1u << ( 4 * ( count - 1 ) ) ) - 1 );
+                codes[value] = spread( value ) | continuation | ( ( 4 * count ) << 24 );
+            }
+            for( uint32_t code = 0; code < size; code++ ){
+                const uint32_t stop = ~code & 0x888;
+                if( !stop ){
+                    values[code] = 0;
+                    continue;
+                }
+                const uint32_t length = trailing_zeros( stop ) + 1;
+                values[code] = compact( code & ( ( 1u << length ) - 1 ) ) | ( length << 24 );
+            }
+        }
+
+        static const code_table& instance()
+        {
+            static const code_table table;
+            return table;
+        }
+    };
+
+    // Encoder State of Nibble Stream
+    // Nibbles are packed from least significant bit, so that code of each value is built and written without branch per nibble.
+    class encoder
+    {
+    private:
+        uint32_t* buffer;
+        uint64_t word = 0;
+        size_t bits = 0;
+        const uint32_t* codes;
+
+    public:
+        encoder( uint32_t* buffer )
+            : buffer( buffer )
+            , codes( code_table::instance().codes )
+        {
+        }
+
+        // Encode Value of Any Length (Run Length)
+        inline void encode( uint32_t value )
+        {
+            while( value >> 18 ){
+                put( spread( value & 0x3ffff ) | 0x888888, 24 );
+                value >>= 18;
+            }
+            encode_short( value );
+        }
+
+        // Encode Value of 18bit or Less (Zigzag Delta)
+        inline void encode_short( const uint32_t value )
+        {
+            if( value < code_table::size ){
+                const uint32_t code = codes[value];
+                put( code & 0xffffff, code >> 24 );
+                return;
+            }
+
+            const uint32_t count = ( bit_length( value ) + 2 ) / 3;
+            const uint32_t continuation = 0x888888 & ( ( 1u << ( 4 * ( count - 1 ) ) ) - 1 );
+            put( spread( value ) | continuation, 4 * count );
+        }
+
+        // Flush Remaining Nibbles and Return End of Buffer
+        uint32_t* flush()
+        {
+            if( bits ){
+                *buffer++ = static_cast<uint32_t>( word );
+                word = 0;
+                bits = 0;
+            }
+            return buffer;
+        }
+
+    private:
+        inline void put( const uint64_t code, const size_t length )
+        {
+            // Write Lower 32bit Always, and Advance only when Word is Filled (Branchless)
+            word |= code << bits;
+            bits += length;
+            *buffer = static_cast<uint32_t>( word );
+            const size_t filled = bits >> 5;
+            buffer += filled;
+            word >>= filled << 5;
+            bits &= 31;
+        }
+    };
+
+    // Decoder State of Nibble Stream
+    class decoder
+    {
+    private:
+        const uint32_t* buffer;
+        const uint32_t* end;
+        uint64_t word = 0;
+        size_t bits = 0;
+        const uint32_t* values;
+
+    public:
+        decoder( const uint32_t* buffer, const uint32_t* end )
+            : buffer( buffer )
+            , end( end )
+            , values( code_table::instance().values )
+        {
+        }
+
+        // Decode Value of Any Length (Run Length)
+        inline uint32_t decode()
+        {
+            uint64_t value = 0;
+            for( uint32_t shift = 0; shift < 32; shift += 18 ){
+                refill();
+                const uint32_t code = static_cast<uint32_t>( word ) & 0xffffff;
+                const uint32_t stop = ~code & 0x888888;
+                if( stop ){
+                    value |= static_cast<uint64_t>( take( code, stop ) ) << shift;
+                    if( value >> 32 ){
+                        break;
+                    }
+                    return static_cast<uint32_t>( value );
+                }
+                value |= static_cast<uint64_t>( compact( code ) ) << shift;
+                consume( 24 );
+            }
+            throw std::runtime_error( "depth codec stream is corrupted" );
+        }
+
+        // Decode Value of 18bit or Less (Zigzag Delta)
+        inline uint32_t decode_short()
+        {
+            refill();
+            const uint32_t value = values[word & ( code_table::size - 1 )];
+            if( value >> 24 ){
+                consume( value >> 24 );
+                return value & 0xffffff;
+            }
+
+            const uint32_t code = static_cast<uint32_t>( word ) & 0xffffff;
+            const uint32_t stop = ~code & 0x888888;
+            if( !stop ){
+                throw std::runtime_error( "depth codec stream is corrupted" );
+            }
+            return take( code, stop );
+        }
+
+    private:
+        inline void refill()
+        {
+            if( bits < 32 && buffer != end ){
+                word |= static_cast<uint64_t>( *buffer++ ) << bits;
+                bits += 32;
+            }
+        }
+
+        inline void consume( const size_t length )
+        {
+            if( length > bits ){
+                throw std::runtime_error( "depth codec stream is truncated" );
+            }
+            word >>= length;
+            bits -= length;
+        }
+
+        // Take Nibbles until First Nibble without Continuation Bit
+        inline uint32_t take( const uint32_t code, const uint32_t stop )
+        {
+            const uint32_t length = trailing_zeros( stop ) + 1;
+            consume( length );
+            return compact( code & ( ( 1u << length ) - 1 ) );
+        }
+    };
+
+    // Maximum Encoded Size in Bytes of Pixels (Worst Case)
+    inline size_t bound( const size_t num_pixels )
+    {
+        // Each pixel needs at most 6 nibbles for delta and 2 nibbles for run lengths (32bit per pixel)
+        return ( num_pixels + 2 ) * sizeof( uint32_t );
+    }
+
+    // Encode Pixels and Return Encoded Size in Bytes
+    inline size_t encode( const uint16_t* input, const size_t num_pixels, uint8_t* output )
+    {
+        encoder stream( reinterpret_cast<uint32_t*>( output ) );
+        const uint16_t* end = input + num_pixels;
+        int32_t previous = 0;
+        while( input != end ){
+            // Run of Zeros
+            const uint16_t* nonzero = find( input, end, false );
+            stream.encode( static_cast<uint32_t>( nonzero - input ) );
+            input = nonzero;
+
+            // Run of Non-Zeros
+            const uint32_t nonzeros = static_cast<uint32_t>( find( input, end, true ) - input );
+            stream.encode( nonzeros );
+
+            // Zigzag Delta of Non-Zeros
+            for( uint32_t i = 0; i < nonzeros; i++ ){
+                const int32_t current = *input++;
+                const int32_t delta = current - previous;
+                stream.encode_short( ( static_cast<uint32_t>( delta ) << 1 ) ^ static_cast<uint32_t>( delta >> 31 ) );
+                previous = current;
+            }
+        }
+        return reinterpret_cast<uint8_t*>( stream.flush() ) - output;
+    }
+
+    // Decode Pixels from Encoded Data
+    inline void decode( const uint8_t* input, const size_t size, uint16_t* output, const size_t num_pixels )
+    {
+        const uint32_t* words = reinterpret_cast<const uint32_t*>( input );
+        decoder stream( words, words + size / sizeof( uint32_t ) );
+        uint16_t* end = output + num_pixels;
+        int32_t previous = 0;
+        while( output != end ){
+            const uint32_t zeros = stream.decode();
+            const uint32_t nonzeros = stream.decode();
+            if( static_cast<size_t>( zeros ) + nonzeros > static_cast<size_t>( end - output ) ){
+                throw std::runtime_error( "depth codec stream is corrupted" );
+            }
+
+            std::memset( output, 0, zeros * sizeof( uint16_t ) );
+            output += zeros;
+            for( uint32_t i = 0; i < nonzeros; i++ ){
+                const uint32_t positive = stream.decode_short();
+                const int32_t delta = static_cast<int32_t>( positive >> 1 ) ^ -static_cast<int32_t>( positive & 1 );
+                previous += delta;
+                *output++ = static_cast<uint16_t>( previous );
+            }
+        }
+    }
+
+    // Tiled Frame Format
+    // [width][height][num_tiles][size of tile 0]...[size of tile N-1][tile 0]...[tile N-1] (uint32, 4 bytes aligned)
+    static constexpr size_t tile_header_size = 3;
+
+    // Encode Frame in Parallel Tiles (Output Buffer is Reused)
+    inline void encode_tiled( const uint16_t* input, const uint32_t width, const uint32_t height, const uint32_t num_tiles, std::vector<uint8_t>& output, std::vector<std::vector<uint8_t>>& tiles )
+    {
+        if( !num_tiles || num_tiles > height ){
+            throw std::invalid_argument( "invalid number of tiles" );
+        }
+
+        // Encode Each Tile into Its Own Buffer
+        tiles.resize( num_tiles );
+        std::vector<size_t> sizes( num_tiles );
+        #pragma omp parallel for schedule( dynamic, 1 )
+        for( int32_t tile = 0; tile < static_cast<int32_t>( num_tiles ); tile++ ){
+            const uint32_t begin = height * tile / num_tiles;
+            const uint32_t end = height * ( tile + 1 ) / num_tiles;
+            const size_t num_pixels = static_cast<size_t>( end - begin ) * width;
+            if( tiles[tile].size() < bound( num_pixels ) ){
+                tiles[tile].resize( bound( num_pixels ) );
+            }
+            sizes[tile] = encode( input + static_cast<size_t>( begin ) * width, num_pixels, tiles[tile].data() );
+        }
+
+        // Concatenate Tiles
+        size_t total = ( tile_header_size + num_tiles ) * sizeof( uint32_t );
+        for( const size_t size : sizes ){
+            total += size;
+        }
+        output.resize( total );
+
+        uint32_t* header = reinterpret_cast<uint32_t*>( output.data() );
+        header[0] = width;
+        header[1] = height;
+        header[2] = num_tiles;
+        size_t offset = ( tile_header_size + num_tiles ) * sizeof( uint32_t );
+        for( uint32_t tile = 0; tile < num_tiles; tile++ ){
+            header[tile_header_size + tile] = static_cast<uint32_t>( sizes[tile] );
+            std::memcpy( output.data() + offset, tiles[tile].data(), sizes[tile] );
+            offset += sizes[tile];
+        }
+    }
+
+    // Decode Frame of Parallel Tiles (Output Buffer is Reused)
+    inline void decode_tiled( const uint8_t* input, const size_t size, std::vector<uint16_t>& output, uint32_t& width, uint32_t& height )
+    {
+        if( size < tile_header_size * sizeof( uint32_t ) ){
+            throw std::runtime_error( "depth codec frame is truncated" );
+        }
+
+        const uint32_t* header = reinterpret_cast<const uint32_t*>( input );
+        width = header[0];
+        height = header[1];
+        const uint32_t num_tiles = header[2];
+        if( !num_tiles || num_tiles > height || size < ( tile_header_size + num_tiles ) * sizeof( uint32_t ) ){
+            throw std::runtime_error( "depth codec frame is corrupted" );
+        }
+
+        // Calculate Offsets of Tiles
+        std::vector<size_t> offsets( num_tiles + 1 );
+        offsets[0] = ( tile_header_size + num_tiles ) * sizeof( uint32_t );
+        for( uint32_t tile = 0; tile < num_tiles; tile++ ){
+            offsets[tile + 1] = offsets[tile] + header[tile_header_size + tile];
+        }
+        if( offsets[num_tiles] > size ){
+            throw std::runtime_error( "depth codec frame is truncated" );
+        }
+
+        // Decode Each Tile
+        output.resize( static_cast<size_t>( width ) * height );
+        bool failed = false;
+        #pragma omp parallel for schedule( dynamic, 1 )
+        for( int32_t tile = 0; tile < static_cast<int32_t>( num_tiles ); tile++ ){
+            const uint32_t begin = height * tile / num_tiles;
+            const uint32_t end = height * ( tile + 1 ) / num_tiles;
+            try{
+                decode( input + offsets[tile], offsets[tile + 1] - offsets[tile], output.data() + static_cast<size_t>( begin ) * width, static_cast<size_t>( end - begin ) * width );
+            } catch( const std::exception& ){
+                #pragma omp critical
+                failed = true;
+            }
+        }
+
+        if( failed ){
+            throw std::runtime_error( "depth codec frame is corrupted" );
+        }
+    }
+}
+
+#endif // __DEPTH_CODEC__
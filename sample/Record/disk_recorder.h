@@ -0,0 +1,421 @@
+// This is minimum implementation of disk-throughput-aware recorder.
+// Frames are copied into per-stream queues and written to frame file (frame_file.h) by background thread in timestamp order.
+// Recorder measures write bandwidth and queue depth, and applies degradation policy (drop infrared, decimate color, compress depth) step by step when disk falls behind.
+// Capture is never blocked. Frames that are not recorded (policy, queue overflow) and gaps of frame number in input are logged to sidecar file (.gaps.csv).
+
+#ifndef __DISK_RECORDER__
+#define __DISK_RECORDER__
+
+#include <librealsense2/rs.hpp>
+
+#include "depth_codec.h"
+#include "frame_file.h"
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+namespace disk
+{
+    // Degradation Action
+    enum class action
+    {
+        drop_infrared,
+        decimate_color,
+        compress_depth
+    };
+
+    inline const char* to_string( const action action )
+    {
+        switch( action ){
+            case action::drop_infrared:
+                return "drop infrared";
+            case action::decimate_color:
+                return "decimate color";
+            case action::compress_depth:
+                return "compress depth";
+            default:
+                return "unknown";
+        }
+    }
+
+    // Options
+    struct options
+    {
+        std::string file_name = "file.frames"; // gaps are logged to file_name + ".gaps.csv"
+        size_t queue_budget = static_cast<size_t>( 256 ) << 20; // bytes of all queues (frames over budget are dropped)
+        double high_watermark = 0.5; // rate of budget to step up degradation
+        double low_watermark = 0.1; // rate of budget to step down degradation
+        double step_interval = 0.5; // seconds between steps up
+        double recover_time = 2.0; // seconds below low watermark to step down
+        std::vector<action> policy = { action::drop_infrared, action::decimate_color, action::compress_depth }; // applied in order
+        uint32_t color_decimation = 2; // record one of N color frames
+    };
+}
+
+class disk_recorder
+{
+private:
+    // Queued Frame
+    struct item
+    {
+        frame_file::header header;
+        std::vector<uint8_t> data;
+    };
+
+    // Run of Missing Frames (Coalesced into One Line of Sidecar)
+    struct run
+    {
+        bool active = false;
+        uint64_t first = 0;
+        uint64_t last = 0;
+        double timestamp = 0.0;
+        const char* reason = "";
+    };
+
+    // Stream
+    struct stream
+    {
+        std::string name;
+        std::deque<item> queue;
+        size_t bytes = 0;
+        bool has_last = false;
+        uint64_t last_frame_number = 0;
+        uint64_t color_count = 0;
+        run missing;
+
+        // Statistics
+        uint64_t received = 0;
+        uint64_t written = 0;
+        uint64_t dropped_policy = 0;
+        uint64_t dropped_overflow = 0;
+        uint64_t missing_input = 0;
+    };
+
+    disk::options option;
+    std::ofstream file;
+    std::ofstream gaps;
+
+    // Queues (Key is Stream Type and Index)
+    std::map<std::pair<uint8_t, uint8_t>, stream> streams;
+    size_t queued_bytes = 0;
+
+    // Degradation Level (Number of Actions of Policy in Effect)
+    std::atomic<uint32_t> level;
+    std::chrono::steady_clock::time_point level_changed;
+    std::chrono::steady_clock::time_point below_since;
+    bool below = false;
+
+    // Bandwidth
+    uint64_t incoming_bytes = 0;
+    uint64_t written_bytes = 0;
+    double write_time = 0.0; // seconds spent in writing
+    std::chrono::steady_clock::time_point report_time;
+    uint64_t report_incoming_bytes = 0;
+    uint64_t report_written_bytes = 0;
+    double report_write_time = 0.0;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+public:
+    explicit disk_recorder( const disk::options& option = disk::options() )
+        : option( option )
+        , level( 0 )
+    {
+        file.open( option.file_name, std::ios::binary );
+        if( !file.is_open() ){
+            throw std::runtime_error( "failed to open " + option.file_name );
+        }
+        gaps.open( option.file_name + ".gaps.csv" );
+        if( !gaps.is_open() ){
+            throw std::runtime_error( "failed to open " + option.file_name + ".gaps.csv" );
+        }
+        gaps << "stream,first,last,count,timestamp,reason\n";
+
+        level_changed = report_time = std::chrono::steady_clock::now();
+        thread = std::thread( &disk_recorder::write, this );
+    }
+
+    ~disk_recorder()
+    {
+        // Write All Queued Frames
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            stopping = true;
+        }
+        condition.notify_all();
+        thread.join();
+
+        // Log Remaining Runs of Missing Frames
+        for( std::pair<const std::pair<uint8_t, uint8_t>, stream>& stream : streams ){
+            flush( stream.second );
+        }
+    }
+
+    disk_recorder( const disk_recorder& ) = delete;
+    disk_recorder& operator=( const disk_recorder& ) = delete;
+
+    // Push Video Frame (Capture Thread, Never Blocks on Disk)
+    void push( const rs2::frame& frame )
+    {
+        if( !frame ){
+            return;
+        }
+
+        const rs2::video_frame video_frame = frame.as<rs2::video_frame>();
+        const rs2::stream_profile profile = frame.get_profile();
+        item item;
+        item.header.stream = static_cast<uint8_t>( profile.stream_type() );
+        item.header.index = static_cast<uint8_t>( profile.stream_index() );
+        item.header.format = static_cast<uint8_t>( profile.format() );
+        item.header.encoding = frame_file::raw;
+        item.header.width = static_cast<uint32_t>( video_frame.get_width() );
+        item.header.height = static_cast<uint32_t>( video_frame.get_height() );
+        item.header.frame_number = frame.get_frame_number();
+        item.header.timestamp = frame.get_timestamp();
+
+        stream& stream = find( item.header );
+
+        // Apply Degradation Policy
+        const uint32_t current = level;
+        if( ( active( disk::action::drop_infrared, current ) && item.header.stream == RS2_STREAM_INFRARED ) ||
+            ( active( disk::action::decimate_color, current ) && item.header.stream == RS2_STREAM_COLOR && stream.color_count++ % std::max( option.color_decimation, 1u ) != 0 ) ){
+            std::lock_guard<std::mutex> lock( mutex );
+            receive( stream, item.header );
+            drop( stream, item.header, "policy" );
+            stream.dropped_policy++;
+            return;
+        }
+
+        // Copy Frame Data (Compress Depth if Policy is in Effect)
+        const uint32_t bpp = static_cast<uint32_t>( video_frame.get_bytes_per_pixel() );
+        const uint32_t stride = static_cast<uint32_t>( video_frame.get_stride_in_bytes() );
+        const uint8_t* data = static_cast<const uint8_t*>( video_frame.get_data() );
+        const size_t row = static_cast<size_t>( item.header.width ) * bpp;
+        if( active( disk::action::compress_depth, current ) && item.header.format == RS2_FORMAT_Z16 && stride == row ){
+            const size_t num_pixels = static_cast<size_t>( item.header.width ) * item.header.height;
+            item.data.resize( depth_codec::bound( num_pixels ) );
+            item.data.resize( depth_codec::encode( reinterpret_cast<const uint16_t*>( data ), num_pixels, item.data.data() ) );
+            item.header.encoding = frame_file::rvl;
+        }
+        else{
+            item.data.resize( row * item.header.height );
+            for( uint32_t y = 0; y < item.header.height; y++ ){
+                std::memcpy( item.data.data() + y * row, data + static_cast<size_t>( y ) * stride, row );
+            }
+        }
+        item.header.size = static_cast<uint32_t>( item.data.size() );
+
+        std::lock_guard<std::mutex> lock( mutex );
+        receive( stream, item.header );
+        incoming_bytes += item.data.size();
+
+        // Drop Frame if Queues are over Budget
+        if( queued_bytes + item.data.size() > option.queue_budget ){
+            drop( stream, item.header, "overflow" );
+            stream.dropped_overflow++;
+            degrade();
+            return;
+        }
+
+        flush( stream );
+        stream.bytes += item.data.size();
+        queued_bytes += item.data.size();
+        stream.queue.push_back( std::move( item ) );
+        degrade();
+        condition.notify_one();
+    }
+
+    // Degradation Level (Number of Actions of Policy in Effect)
+    uint32_t degradation_level() const
+    {
+        return level;
+    }
+
+    // Telemetry since Last Report (Bandwidth, Queue Depth, Drops per Stream)
+    std::string report()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const double interval = std::chrono::duration<double>( now - report_time ).count();
+        const double megabyte = 1024.0 * 1024.0;
+        const double incoming = ( incoming_bytes - report_incoming_bytes ) / megabyte / interval;
+        const double written = ( written_bytes - report_written_bytes ) / megabyte / interval;
+        const double busy = write_time - report_write_time;
+        const double disk = busy > 0.0 ? ( written_bytes - report_written_bytes ) / megabyte / busy : 0.0;
+
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision( 1 );
+        oss << "recorder : incoming " << incoming << " MB/s, written " << written << " MB/s (disk " << disk << " MB/s while busy, " << 100.0 * busy / interval << "% busy)";
+        oss << ", queued " << queued_bytes / megabyte << " MB, level " << level;
+        for( uint32_t i = 0; i < level && i < option.policy.size(); i++ ){
+            oss << ( i ? " + " : " (" ) << disk::to_string( option.policy[i] ) << ( i + 1 == level ? ")" : "" );
+        }
+        for( const std::pair<const std::pair<uint8_t, uint8_t>, stream>& stream : streams ){
+            oss << "\n  " << stream.second.name << " : queue " << stream.second.queue.size() << " (" << stream.second.bytes / megabyte << " MB)"
+                << ", received " << stream.second.received << ", written " << stream.second.written
+                << ", dropped " << stream.second.dropped_policy << " (policy) " << stream.second.dropped_overflow << " (overflow)"
+                << ", missing " << stream.second.missing_input << " (input)";
+        }
+
+        report_time = now;
+        report_incoming_bytes = incoming_bytes;
+        report_written_bytes = written_bytes;
+        report_write_time = write_time;
+        return oss.str();
+    }
+
+private:
+    // Find Stream of Frame (Capture Thread Only Adds Streams)
+    stream& find( const frame_file::header& header )
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        stream& stream = streams[std::make_pair( header.stream, header.index )];
+        if( stream.name.empty() ){
+            const char* names[] = { "any", "depth", "color", "infrared", "fisheye", "gyro", "accel", "gpio", "pose", "confidence" };
+            stream.name = ( header.stream < sizeof( names ) / sizeof( names[0] ) ) ? names[header.stream] : "stream";
+            if( header.index ){
+                stream.name += " " + std::to_string( header.index );
+            }
+        }
+        return stream;
+    }
+
+    bool active( const disk::action action, const uint32_t level ) const
+    {
+        const std::vector<disk::action>::const_iterator it = std::find( option.policy.begin(), option.policy.end(), action );
+        return it != option.policy.end() && static_cast<uint32_t>( it - option.policy.begin() ) < level;
+    }
+
+    // Check Gap of Frame Number in Input
+    void receive( stream& stream, const frame_file::header& header )
+    {
+        stream.received++;
+        if( stream.has_last && header.frame_number > stream.last_frame_number + 1 ){
+            flush( stream );
+            const uint64_t count = header.frame_number - stream.last_frame_number - 1;
+            gaps << stream.name << "," << stream.last_frame_number + 1 << "," << header.frame_number - 1 << "," << count << "," << std::fixed << std::setprecision( 3 ) << header.timestamp << ",input\n";
+            stream.missing_input += count;
+        }
+        if( !stream.has_last || header.frame_number > stream.last_frame_number ){
+            stream.last_frame_number = header.frame_number;
+        }
+        stream.has_last = true;
+    }
+
+    // Add Frame to Run of Dropped Frames
+    void drop( stream& stream, const frame_file::header& header, const char* reason )
+    {
+        run& run = stream.missing;
+        if( run.active && run.reason == reason && run.last + 1 == header.frame_number ){
+            run.last = header.frame_number;
+            return;
+        }
+        flush( stream );
+        run.active = true;
+        run.first = run.last = header.frame_number;
+        run.timestamp = header.timestamp;
+        run.reason = reason;
+    }
+
+    // Log Run of Dropped Frames
+    void flush( stream& stream )
+    {
+        run& run = stream.missing;
+        if( !run.active ){
+            return;
+        }
+        gaps << stream.name << "," << run.first << "," << run.last << "," << run.last - run.first + 1 << "," << std::fixed << std::setprecision( 3 ) << run.timestamp << "," << run.reason << "\n";
+        run.active = false;
+    }
+
+    // Step Degradation Level Up or Down by Fill of Queues
+    void degrade()
+    {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const double fill = static_cast<double>( queued_bytes ) / option.queue_budget;
+        const double since = std::chrono::duration<double>( now - level_changed ).count();
+
+        if( fill >= option.high_watermark ){
+            below = false;
+            if( level < option.policy.size() && since >= option.step_interval ){
+                level++;
+                level_changed = now;
+            }
+            return;
+        }
+
+        if( fill <= option.low_watermark ){
+            if( !below ){
+                below = true;
+                below_since = now;
+            }
+            if( level > 0 && std::chrono::duration<double>( now - below_since ).count() >= option.recover_time && since >= option.recover_time ){
+                level--;
+                level_changed = now;
+                below_since = now;
+            }
+            return;
+        }
+
+        below = false;
+    }
+
+    // Write Frames in Timestamp Order (Writer Thread)
+    void write()
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        while( true ){
+            // Find Oldest Frame among Queues
+            stream* oldest = nullptr;
+            for( std::pair<const std::pair<uint8_t, uint8_t>, stream>& stream : streams ){
+                if( !stream.second.queue.empty() && ( !oldest || stream.second.queue.front().header.timestamp < oldest->queue.front().header.timestamp ) ){
+                    oldest = &stream.second;
+                }
+            }
+
+            if( !oldest ){
+                if( stopping ){
+                    break;
+                }
+                condition.wait( lock );
+                continue;
+            }
+
+            item item = std::move( oldest->queue.front() );
+            oldest->queue.pop_front();
+            lock.unlock();
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            frame_file::write( file, item.header, item.data.data() );
+            const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+            lock.lock();
+            oldest->bytes -= item.data.size();
+            oldest->written++;
+            queued_bytes -= item.data.size();
+            written_bytes += item.data.size() + frame_file::header_size;
+            write_time += elapsed;
+        }
+        file.flush();
+    }
+};
+
+#endif // __DISK_RECORDER__
\ No newline at end of file
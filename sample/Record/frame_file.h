@@ -0,0 +1,98 @@
+// This is minimum implementation of frame file (.frames) that is written by pre-trigger recorder and disk recorder.
+// Frame file is sequence of frames, each frame is fixed size header and data (raw pixels, or compressed with RVL or JPEG).
+//
+// File Format (Little Endian, per Frame):
+//   [stream (uint8)][index (uint8)][format (uint8)][encoding (uint8)][width (uint32)][height (uint32)][frame number (uint64)][timestamp (double)][size (uint32)][data]
+
+#ifndef __FRAME_FILE__
+#define __FRAME_FILE__
+
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+namespace frame_file
+{
+    // Encoding of Frame Data
+    enum encoding : uint8_t
+    {
+        raw = 0,
+        rvl = 1, // depth_codec::encode()
+        jpeg = 2 // cv::imencode()
+    };
+
+    // Header of Frame
+    struct header
+    {
+        uint8_t stream;
+        uint8_t index;
+        uint8_t format;
+        uint8_t encoding;
+        uint32_t width;
+        uint32_t height;
+        uint64_t frame_number;
+        double timestamp;
+        uint32_t size;
+    };
+
+    // Size of Header in File
+    const size_t header_size = 4 * sizeof( uint8_t ) + 2 * sizeof( uint32_t ) + sizeof( uint64_t ) + sizeof( double ) + sizeof( uint32_t );
+
+    // Write Frame
+    inline void write( std::ostream& stream, const header& header, const uint8_t* data )
+    {
+        stream.write( reinterpret_cast<const char*>( &header.stream ), sizeof( header.stream ) );
+        stream.write( reinterpret_cast<const char*>( &header.index ), sizeof( header.index ) );
+        stream.write( reinterpret_cast<const char*>( &header.format ), sizeof( header.format ) );
+        stream.write( reinterpret_cast<const char*>( &header.encoding ), sizeof( header.encoding ) );
+        stream.write( reinterpret_cast<const char*>( &header.width ), sizeof( header.width ) );
+        stream.write( reinterpret_cast<const char*>( &header.height ), sizeof( header.height ) );
+        stream.write( reinterpret_cast<const char*>( &header.frame_number ), sizeof( header.frame_number ) );
+        stream.write( reinterpret_cast<const char*>( &header.timestamp ), sizeof( header.timestamp ) );
+        stream.write( reinterpret_cast<const char*>( &header.size ), sizeof( header.size ) );
+        stream.write( reinterpret_cast<const char*>( data ), header.size );
+    }
+
+    // Parse Header from Bytes (Size of Bytes is header_size)
+    inline void parse( const uint8_t* bytes, header& header )
+    {
+        auto get = [&bytes]( void* value, const size_t size ){
+            std::memcpy( value, bytes, size );
+            bytes += size;
+        };
+        get( &header.stream, sizeof( header.stream ) );
+        get( &header.index, sizeof( header.index ) );
+        get( &header.format, sizeof( header.format ) );
+        get( &header.encoding, sizeof( header.encoding ) );
+        get( &header.width, sizeof( header.width ) );
+        get( &header.height, sizeof( header.height ) );
+        get( &header.frame_number, sizeof( header.frame_number ) );
+        get( &header.timestamp, sizeof( header.timestamp ) );
+        get( &header.size, sizeof( header.size ) );
+    }
+
+    // Read Frame (Return false at End of File)
+    inline bool read( std::istream& stream, header& header, std::vector<uint8_t>& data )
+    {
+        stream.read( reinterpret_cast<char*>( &header.stream ), sizeof( header.stream ) );
+        stream.read( reinterpret_cast<char*>( &header.index ), sizeof( header.index ) );
+        stream.read( reinterpret_cast<char*>( &header.format ), sizeof( header.format ) );
+        stream.read( reinterpret_cast<char*>( &header.encoding ), sizeof( header.encoding ) );
+        stream.read( reinterpret_cast<char*>( &header.width ), sizeof( header.width ) );
+        stream.read( reinterpret_cast<char*>( &header.height ), sizeof( header.height ) );
+        stream.read( reinterpret_cast<char*>( &header.frame_number ), sizeof( header.frame_number ) );
+        stream.read( reinterpret_cast<char*>( &header.timestamp ), sizeof( header.timestamp ) );
+        stream.read( reinterpret_cast<char*>( &header.size ), sizeof( header.size ) );
+        if( !stream ){
+            return false;
+        }
+
+        data.resize( header.size );
+        stream.read( reinterpret_cast<char*>( data.data() ), header.size );
+        return static_cast<bool>( stream );
+    }
+}
+
+#endif // __FRAME_FILE__
\ No newline at end of file
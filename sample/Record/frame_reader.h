@@ -0,0 +1,339 @@
+// This is minimum implementation of read-ahead prefetching reader of frame file (frame_file.h).
+// Reader thread reads file sequentially with large reads (and posix_fadvise on POSIX), and next K frames are decoded on worker pool (RVL, JPEG, raw).
+// Decoded frames are handed out in file order from bounded ring of K slots, so consumer gets ready frames with near-zero wait and memory is bounded.
+// This is useful when read latency of storage (e.g. NAS) is bottleneck, because reading and decoding are overlapped with processing.
+
+#ifndef __FRAME_READER__
+#define __FRAME_READER__
+
+#include <librealsense2/rs.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "depth_codec.h"
+#include "frame_file.h"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace prefetch
+{
+    // Options
+    struct options
+    {
+        uint32_t depth = 32; // number of frames read ahead (K)
+        uint32_t workers = 0; // number of decoder threads (0 is number of hardware threads)
+        size_t read_size = static_cast<size_t>( 8 ) << 20; // bytes per read
+        size_t advise_size = static_cast<size_t>( 64 ) << 20; // bytes ahead to advise kernel to read (posix_fadvise)
+    };
+
+    // Decoded Frame
+    struct frame
+    {
+        frame_file::header header;
+        cv::Mat image; // CV_16UC1 (Z16), CV_8UC3 (BGR8/RGB8), CV_8UC1 (Y8), ...
+    };
+
+    // Type of cv::Mat for Format of Raw Frame
+    inline int32_t type( const frame_file::header& header )
+    {
+        switch( header.format ){
+            case RS2_FORMAT_Z16:
+            case RS2_FORMAT_Y16:
+            case RS2_FORMAT_DISPARITY16:
+                return CV_16UC1;
+            case RS2_FORMAT_YUYV:
+            case RS2_FORMAT_UYVY:
+                return CV_8UC2;
+            case RS2_FORMAT_RGB8:
+            case RS2_FORMAT_BGR8:
+                return CV_8UC3;
+            case RS2_FORMAT_RGBA8:
+            case RS2_FORMAT_BGRA8:
+                return CV_8UC4;
+            default:
+                return CV_8UC1;
+        }
+    }
+}
+
+class frame_reader
+{
+private:
+    // Slot of Ring (Frame is Decoded in Slot of Its Sequence Number)
+    struct slot
+    {
+        enum state_type { empty, pending, ready } state = empty;
+        std::vector<uint8_t> data; // encoded
+        prefetch::frame frame; // decoded
+    };
+
+    prefetch::options option;
+    std::string file_name;
+    std::FILE* file = nullptr;
+
+    // Read Buffer
+    std::vector<uint8_t> buffer;
+    size_t buffer_begin = 0;
+    size_t buffer_end = 0;
+    uint64_t file_offset = 0; // offset of buffer_end in file
+    uint64_t advised = 0; // offset advised to kernel
+
+    // Ring of Slots
+    std::vector<slot> slots;
+    uint64_t read_sequence = 0; // next sequence to read
+    uint64_t next_sequence = 0; // next sequence to hand out
+    bool eof = false;
+    std::exception_ptr exception;
+
+    // Decode Jobs (Sequence Numbers)
+    std::deque<uint64_t> jobs;
+
+    // Statistics
+    double wait_time = 0.0;
+    uint64_t frames = 0;
+
+    std::thread reader;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable slot_freed;
+    std::condition_variable job_added;
+    std::condition_variable frame_ready;
+    bool stopping = false;
+
+public:
+    explicit frame_reader( const std::string& file_name, const prefetch::options& option = prefetch::options() )
+        : option( option )
+        , file_name( file_name )
+        , buffer( std::max<size_t>( option.read_size, frame_file::header_size ) )
+        , slots( std::max<uint32_t>( option.depth, 1 ) )
+    {
+        file = std::fopen( file_name.c_str(), "rb" );
+        if( !file ){
+            throw std::runtime_error( "failed to open " + file_name );
+        }
+        std::setvbuf( file, nullptr, _IONBF, 0 );
+
+#if defined( POSIX_FADV_SEQUENTIAL )
+        // Advise Kernel that File is Read Sequentially (Larger Read-Ahead)
+        posix_fadvise( fileno( file ), 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+
+        const uint32_t num_workers = option.workers ? option.workers : std::max( std::thread::hardware_concurrency(), 1u );
+        reader = std::thread( &frame_reader::read, this );
+        for( uint32_t i = 0; i < num_workers; i++ ){
+            workers.emplace_back( &frame_reader::decode, this );
+        }
+    }
+
+    ~frame_reader()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            stopping = true;
+        }
+        slot_freed.notify_all();
+        job_added.notify_all();
+        frame_ready.notify_all();
+        reader.join();
+        for( std::thread& worker : workers ){
+            worker.join();
+        }
+        std::fclose( file );
+    }
+
+    frame_reader( const frame_reader& ) = delete;
+    frame_reader& operator=( const frame_reader& ) = delete;
+
+    // Next Decoded Frame in File Order (Return false at End of File)
+    bool next( prefetch::frame& frame )
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock( mutex );
+        slot& slot = slots[next_sequence % slots.size()];
+        frame_ready.wait( lock, [&]{ return slot.state == slot::ready || exception || ( eof && next_sequence == read_sequence ); } );
+        if( exception ){
+            std::rethrow_exception( exception );
+        }
+        if( slot.state != slot::ready ){
+            return false;
+        }
+
+        frame = std::move( slot.frame );
+        slot.frame = prefetch::frame();
+        slot.state = slot::empty;
+        next_sequence++;
+        frames++;
+        wait_time += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        slot_freed.notify_all();
+        return true;
+    }
+
+    // Average Wait Time of next() (seconds)
+    double average_wait() const
+    {
+        return frames ? wait_time / frames : 0.0;
+    }
+
+    // Number of Frames Ready to Hand Out
+    size_t ready()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        size_t count = 0;
+        for( uint64_t sequence = next_sequence; sequence < read_sequence && slots[sequence % slots.size()].state == slot::ready; sequence++ ){
+            count++;
+        }
+        return count;
+    }
+
+private:
+    // Ensure Buffer has Bytes (Large Reads, Return false at End of File)
+    bool fill( const size_t size )
+    {
+        if( buffer_end - buffer_begin >= size ){
+            return true;
+        }
+
+        // Move Remaining Bytes to Front
+        std::memmove( buffer.data(), buffer.data() + buffer_begin, buffer_end - buffer_begin );
+        buffer_end -= buffer_begin;
+        buffer_begin = 0;
+        if( buffer.size() < size ){
+            buffer.resize( size );
+        }
+
+        while( buffer_end < size ){
+#if defined( POSIX_FADV_WILLNEED )
+            // Advise Kernel to Read Ahead, and Drop Pages that were Already Read
+            if( file_offset + option.advise_size / 2 >= advised ){
+                posix_fadvise( fileno( file ), static_cast<off_t>( file_offset ), static_cast<off_t>( option.advise_size ), POSIX_FADV_WILLNEED );
+                if( file_offset > option.advise_size ){
+                    posix_fadvise( fileno( file ), 0, static_cast<off_t>( file_offset - option.advise_size ), POSIX_FADV_DONTNEED );
+                }
+                advised = file_offset + option.advise_size;
+            }
+#endif
+            const size_t bytes = std::fread( buffer.data() + buffer_end, 1, buffer.size() - buffer_end, file );
+            if( bytes == 0 ){
+                return false;
+            }
+            buffer_end += bytes;
+            file_offset += bytes;
+        }
+        return true;
+    }
+
+    // Read Frames into Empty Slots (Reader Thread)
+    void read()
+    {
+        try{
+            while( true ){
+                // Wait Empty Slot
+                slot* slot;
+                {
+                    std::unique_lock<std::mutex> lock( mutex );
+                    slot = &slots[read_sequence % slots.size()];
+                    slot_freed.wait( lock, [&]{ return stopping || slot->state == slot::empty; } );
+                    if( stopping ){
+                        return;
+                    }
+                }
+
+                // Read Header and Data (Truncated Frame at End of File is Ignored)
+                frame_file::header header;
+                if( !fill( frame_file::header_size ) ){
+                    break;
+                }
+                frame_file::parse( buffer.data() + buffer_begin, header );
+                if( !fill( frame_file::header_size + header.size ) ){
+                    break;
+                }
+                slot->frame.header = header;
+                slot->data.assign( buffer.data() + buffer_begin + frame_file::header_size, buffer.data() + buffer_begin + frame_file::header_size + header.size );
+                buffer_begin += frame_file::header_size + header.size;
+
+                // Add Decode Job
+                std::lock_guard<std::mutex> lock( mutex );
+                slot->state = slot::pending;
+                jobs.push_back( read_sequence++ );
+                job_added.notify_one();
+            }
+        }
+        catch( ... ){
+            std::lock_guard<std::mutex> lock( mutex );
+            exception = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock( mutex );
+        eof = true;
+        frame_ready.notify_all();
+    }
+
+    // Decode Frames (Worker Threads)
+    void decode()
+    {
+        while( true ){
+            slot* slot;
+            {
+                std::unique_lock<std::mutex> lock( mutex );
+                job_added.wait( lock, [&]{ return stopping || !jobs.empty(); } );
+                if( stopping ){
+                    return;
+                }
+                slot = &slots[jobs.front() % slots.size()];
+                jobs.pop_front();
+            }
+
+            try{
+                decodeFrame( *slot );
+            }
+            catch( ... ){
+                std::lock_guard<std::mutex> lock( mutex );
+                exception = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock( mutex );
+            slot->state = slot::ready;
+            frame_ready.notify_all();
+        }
+    }
+
+    void decodeFrame( slot& slot )
+    {
+        prefetch::frame& frame = slot.frame;
+        const frame_file::header& header = frame.header;
+        switch( header.encoding ){
+            case frame_file::rvl:
+                frame.image.create( header.height, header.width, CV_16UC1 );
+                depth_codec::decode( slot.data.data(), slot.data.size(), frame.image.ptr<uint16_t>(), frame.image.total() );
+                break;
+            case frame_file::jpeg:
+                frame.image = cv::imdecode( slot.data, cv::IMREAD_UNCHANGED );
+                break;
+            default:
+                frame.image.create( header.height, header.width, prefetch::type( header ) );
+                if( frame.image.total() * frame.image.elemSize() != slot.data.size() ){
+                    throw std::runtime_error( "frame size is not matched in " + file_name );
+                }
+                std::memcpy( frame.image.data, slot.data.data(), slot.data.size() );
+                break;
+        }
+    }
+};
+
+#endif // __FRAME_READER__
\ No newline at end of file
@@ -0,0 +1,316 @@
+// This is minimum implementation of pre-trigger recorder.
+// Frames of last N seconds are kept in preallocated memory (ring of bytes), depth (RVL) and color (JPEG) can be compressed to keep longer window.
+// When triggered, frames in window and frames of next M seconds are written to file by background thread, capture is never blocked by disk.
+// While writing, frames that are not written yet are never overwritten. When memory is full, new frames are dropped (and counted) until writer catches up.
+// Frames are written in frame file format (frame_file.h).
+
+#ifndef __PRETRIGGER_RECORDER__
+#define __PRETRIGGER_RECORDER__
+
+#include <librealsense2/rs.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "depth_codec.h"
+#include "frame_file.h"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <cstring>
+#include <cstdint>
+
+namespace pretrigger
+{
+    // Options
+    struct options
+    {
+        double window = 10.0; // seconds kept before trigger
+        double post = 5.0; // seconds written after trigger
+        size_t capacity = static_cast<size_t>( 512 ) << 20; // bytes of ring
+        bool compress_depth = true;
+        bool compress_color = false;
+        int32_t jpeg_quality = 90;
+        std::string prefix = "trigger"; // file name is prefix_YYYYMMDD_HHMMSS.frames
+    };
+}
+
+class pretrigger_recorder
+{
+private:
+    // Frame in Ring
+    struct entry : frame_file::header
+    {
+        std::chrono::steady_clock::time_point arrival;
+        size_t offset;
+    };
+
+    pretrigger::options option;
+
+    // Ring (Entries are in Arrival Order, Front is Oldest)
+    std::vector<uint8_t> arena;
+    std::deque<entry> entries;
+    size_t head = 0;
+
+    // Flush State
+    bool flushing = false;
+    std::chrono::steady_clock::time_point flush_end;
+    std::string flush_file_name;
+    std::ofstream file;
+
+    // Scratch Buffer of Encoding (Producer Thread Only)
+    std::vector<uint8_t> scratch;
+    std::vector<uint8_t> packed;
+    cv::Mat swapped; // RGB8 in BGR order for JPEG
+
+    // Statistics
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> written;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+public:
+    explicit pretrigger_recorder( const pretrigger::options& option = pretrigger::options() )
+        : option( option )
+        , arena( option.capacity )
+        , dropped( 0 )
+        , written( 0 )
+    {
+        thread = std::thread( &pretrigger_recorder::write, this );
+    }
+
+    ~pretrigger_recorder()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            stopping = true;
+        }
+        condition.notify_all();
+        thread.join();
+    }
+
+    pretrigger_recorder( const pretrigger_recorder& ) = delete;
+    pretrigger_recorder& operator=( const pretrigger_recorder& ) = delete;
+
+    // Push Video Frame (Capture Thread)
+    void push( const rs2::frame& frame )
+    {
+        if( !frame ){
+            return;
+        }
+
+        const rs2::video_frame video_frame = frame.as<rs2::video_frame>();
+        const rs2::stream_profile profile = frame.get_profile();
+        entry entry;
+        entry.stream = static_cast<uint8_t>( profile.stream_type() );
+        entry.index = static_cast<uint8_t>( profile.stream_index() );
+        entry.format = static_cast<uint8_t>( profile.format() );
+        entry.width = static_cast<uint32_t>( video_frame.get_width() );
+        entry.height = static_cast<uint32_t>( video_frame.get_height() );
+        entry.frame_number = frame.get_frame_number();
+        entry.timestamp = frame.get_timestamp();
+        entry.arrival = std::chrono::steady_clock::now();
+
+        // Encode Frame (Outside of Lock)
+        const uint8_t* data = encode( video_frame, entry );
+
+        std::lock_guard<std::mutex> lock( mutex );
+
+        // Evict Frames Older than Window (Unless Waiting to be Written)
+        const std::chrono::steady_clock::time_point expire = entry.arrival - seconds( option.window );
+        while( !flushing && !entries.empty() && entries.front().arrival < expire ){
+            entries.pop_front();
+        }
+
+        // Allocate Space in Ring
+        size_t offset;
+        while( !allocate( entry.size, offset ) ){
+            if( flushing || entries.empty() ){
+                dropped++;
+                return;
+            }
+            entries.pop_front();
+        }
+
+        std::memcpy( arena.data() + offset, data, entry.size );
+        entry.offset = offset;
+        head = offset + entry.size;
+        entries.push_back( entry );
+        condition.notify_all();
+    }
+
+    // Trigger (Thread-Safe, Returns Immediately)
+    // Triggering again while writing extends the end of file.
+    void trigger()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        flush_end = std::chrono::steady_clock::now() + seconds( option.post );
+        if( !flushing ){
+            flushing = true;
+            flush_file_name = name();
+        }
+        condition.notify_all();
+    }
+
+    bool is_flushing()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        return flushing;
+    }
+
+    uint64_t dropped_frames() const
+    {
+        return dropped;
+    }
+
+    uint64_t written_frames() const
+    {
+        return written;
+    }
+
+private:
+    static std::chrono::steady_clock::duration seconds( const double seconds )
+    {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( seconds ) );
+    }
+
+    // File Name from Current Time
+    std::string name() const
+    {
+        const std::time_t now = std::time( nullptr );
+        char buffer[32];
+        std::strftime( buffer, sizeof( buffer ), "%Y%m%d_%H%M%S", std::localtime( &now ) );
+        return option.prefix + "_" + buffer + ".frames";
+    }
+
+    // Encode Frame into Scratch Buffer (or Return Frame Data as It Is)
+    const uint8_t* encode( const rs2::video_frame& frame, entry& entry )
+    {
+        const uint32_t bpp = static_cast<uint32_t>( frame.get_bytes_per_pixel() );
+        const uint32_t stride = static_cast<uint32_t>( frame.get_stride_in_bytes() );
+        const uint8_t* data = static_cast<const uint8_t*>( frame.get_data() );
+
+        // Pack Rows if Stride has Padding
+        if( stride != entry.width * bpp ){
+            packed.resize( static_cast<size_t>( entry.width ) * entry.height * bpp );
+            for( uint32_t y = 0; y < entry.height; y++ ){
+                std::memcpy( packed.data() + static_cast<size_t>( y ) * entry.width * bpp, data + static_cast<size_t>( y ) * stride, entry.width * bpp );
+            }
+            data = packed.data();
+        }
+
+        const size_t num_pixels = static_cast<size_t>( entry.width ) * entry.height;
+        if( option.compress_depth && entry.format == RS2_FORMAT_Z16 ){
+            scratch.resize( depth_codec::bound( num_pixels ) );
+            entry.size = static_cast<uint32_t>( depth_codec::encode( reinterpret_cast<const uint16_t*>( data ), num_pixels, scratch.data() ) );
+            entry.encoding = frame_file::rvl;
+            return scratch.data();
+        }
+
+        if( option.compress_color && ( entry.format == RS2_FORMAT_BGR8 || entry.format == RS2_FORMAT_RGB8 ) ){
+            // JPEG is in BGR Order (RGB8 is Swapped and Recorded as BGR8, Decoded Image is BGR)
+            cv::Mat mat( entry.height, entry.width, CV_8UC3, const_cast<uint8_t*>( data ) );
+            if( entry.format == RS2_FORMAT_RGB8 ){
+                cv::cvtColor( mat, swapped, cv::COLOR_RGB2BGR );
+                mat = swapped;
+                entry.format = static_cast<uint8_t>( RS2_FORMAT_BGR8 );
+            }
+            cv::imencode( ".jpg", mat, scratch, { cv::IMWRITE_JPEG_QUALITY, option.jpeg_quality } );
+            entry.size = static_cast<uint32_t>( scratch.size() );
+            entry.encoding = frame_file::jpeg;
+            return scratch.data();
+        }
+
+        entry.size = static_cast<uint32_t>( num_pixels * bpp );
+        entry.encoding = frame_file::raw;
+        return data;
+    }
+
+    // Find Contiguous Space after Newest Frame that doesn't Overlap Oldest Frame
+    bool allocate( const size_t size, size_t& offset ) const
+    {
+        if( size > arena.size() ){
+            return false;
+        }
+        if( entries.empty() ){
+            offset = 0;
+            return true;
+        }
+
+        const size_t tail = entries.front().offset;
+        if( tail < head ){
+            if( head + size <= arena.size() ){
+                offset = head;
+                return true;
+            }
+            if( size < tail ){
+                offset = 0;
+                return true;
+            }
+            return false;
+        }
+        if( head + size < tail ){
+            offset = head;
+            return true;
+        }
+        return false;
+    }
+
+    // Write Frames to File (Writer Thread)
+    void write()
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        while( true ){
+            if( flushing ){
+                // Write Oldest Frame (Ring Never Overwrites It while Flushing)
+                if( !entries.empty() && entries.front().arrival <= flush_end ){
+                    const entry entry = entries.front();
+                    if( !file.is_open() ){
+                        file.open( flush_file_name, std::ios::binary );
+                    }
+                    lock.unlock();
+                    writeEntry( entry );
+                    lock.lock();
+                    entries.pop_front();
+                    continue;
+                }
+
+                // Close File after Post-Trigger Window
+                if( stopping || std::chrono::steady_clock::now() > flush_end ){
+                    if( file.is_open() ){
+                        file.close();
+                    }
+                    flushing = false;
+                    continue;
+                }
+            }
+
+            if( stopping ){
+                break;
+            }
+
+            condition.wait_for( lock, std::chrono::milliseconds( 100 ) );
+        }
+    }
+
+    void writeEntry( const entry& entry )
+    {
+        if( !file.is_open() ){
+            return;
+        }
+
+        frame_file::write( file, entry, arena.data() + entry.offset );
+        written++;
+    }
+};
+
+#endif // __PRETRIGGER_RECORDER__
\ No newline at end of file
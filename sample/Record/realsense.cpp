@@ -1,7 +1,21 @@
 #include "realsense.h"
 
+#include <iostream>
+#include <algorithm>
+#include <csignal>
+#include <thread>
+
 #define RECORD
 
+// Trigger Requested by Signal (SIGUSR1)
+static volatile std::sig_atomic_t trigger_requested = 0;
+#ifdef RECORD
+static void requestTrigger( int )
+{
+    trigger_requested = 1;
+}
+#endif
+
 // Constructor
 RealSense::RealSense()
 {
@@ -24,6 +38,11 @@ void RealSense::run()
         // Update Data
         update();
 
+        // Exit when Batch Playback or Prefetch Playback Reached End of File
+        if( batch_finished || prefetch_finished ){
+            break;
+        }
+
         // Draw Data
         draw();
 
@@ -31,13 +50,38 @@ void RealSense::run()
         show();
 
         // Key Check
-        const int32_t key = cv::waitKey( 10 );
+        const int32_t key = cv::waitKey( enable_batch_playback ? 1 : 10 );
         if( key == 'q' ){
             break;
         }
+        // Trigger Pre-Trigger Recording when Pressed 't' key
+        else if( key == 't' ){
+            trigger();
+        }
+        // Pause/Resume Segmented Recording when Pressed 'p' key
+        else if( key == 'p' && segmented_recorder ){
+            if( segmented_recorder->is_paused() ){
+                segmented_recorder->resume();
+            }
+            else{
+                segmented_recorder->pause();
+            }
+            std::cout << "segment : " << ( segmented_recorder->is_paused() ? "paused" : "resumed" ) << std::endl;
+        }
     }
 }
 
+// Trigger Pre-Trigger Recording
+void RealSense::trigger()
+{
+    if( !trigger_recorder ){
+        return;
+    }
+
+    trigger_recorder->trigger();
+    std::cout << "trigger : writing last " << pretrigger_options.window << " s and next " << pretrigger_options.post << " s" << std::endl;
+}
+
 // Initialize
 void RealSense::initialize()
 {
@@ -57,15 +101,90 @@ inline void RealSense::initializeSensor()
     config.enable_stream( rs2_stream::RS2_STREAM_DEPTH, depth_width, depth_height, rs2_format::RS2_FORMAT_Z16, depth_fps );
     config.enable_stream( rs2_stream::RS2_STREAM_INFRARED, infrared_width, infrared_height, rs2_format::RS2_FORMAT_Y8, infrared_fps );
 
-    // Set Record File
-    config.enable_record_to_file( file_name );
+    if( enable_pretrigger ){
+        // Keep Frames in Memory until Triggered by Key, Signal or trigger()
+        trigger_recorder.reset( new pretrigger_recorder( pretrigger_options ) );
+#ifdef SIGUSR1
+        std::signal( SIGUSR1, requestTrigger );
+#endif
+    }
+    else if( enable_disk_recorder ){
+        // Write Frames to Frame File with Monitored Queues
+        monitored_recorder.reset( new disk_recorder( disk_options ) );
+        disk_report_time = std::chrono::steady_clock::now();
+    }
+    else if( !enable_segmented ){
+        // Set Record File
+        config.enable_record_to_file( file_name );
+    }
+
+    // Open Depth Codec File (Only with Continuous Recording, Pre-Trigger, Segmented and Disk Recorder Write Their Own Files)
+    // [frame number (uint64)][timestamp (double)][size (uint32)][tiled frame] per frame
+    if( enable_depth_codec && !enable_pretrigger && !enable_disk_recorder && !enable_segmented ){
+        depth_codec_file.open( depth_codec_file_name, std::ios::binary );
+        if( !depth_codec_file.is_open() ){
+            throw std::runtime_error( "failed to open " + depth_codec_file_name );
+        }
+    }
 #else
-    // Set Play File
-    config.enable_device_from_file( file_name );
+    if( enable_prefetch_playback ){
+        // Read Frame File without Pipeline (Frames are Read and Decoded Ahead of Processing)
+        prefetch_reader.reset( new frame_reader( prefetch_file_name, prefetch_options ) );
+        prefetch_start = std::chrono::steady_clock::now();
+        return;
+    }
+
+    // Set Play File (Batch Playback doesn't Repeat to Process Every Frame Exactly Once)
+    config.enable_device_from_file( file_name, !enable_batch_playback );
+#endif
+
+#if defined( SYNTHETIC ) && defined( RECORD )
+    // Use Synthetic Device instead of Live Device
+    synthetic.add_to( context );
+    pipeline = rs2::pipeline( context );
+    config.enable_device( synthetic.serial() );
+#endif
+
+#ifndef RECORD
+    if( enable_batch_playback ){
+        // Disable Real-Time Pacing, and Close Queue at End of File
+        // Playback device is resolved before start (pipeline starts same device), so first frames are not paced and end of short file is not missed.
+        rs2::playback playback = config.resolve( pipeline ).get_device().as<rs2::playback>();
+        playback.set_real_time( false );
+        playback.set_status_changed_callback( [this]( const rs2_playback_status status ){
+            if( status == rs2_playback_status::RS2_PLAYBACK_STATUS_STOPPED ){
+                batch_queue.close();
+            }
+        } );
+
+        // Start Pipeline with Callback that Waits while Queue is Full
+        // In non real-time mode, playback reads next frame after callback returned, so slow processing throttles reading instead of dropping frames.
+        batch_start = std::chrono::steady_clock::now();
+        pipeline_profile = pipeline.start( config, [this]( const rs2::frame& frame ){
+            const rs2::frameset frameset = frame.as<rs2::frameset>();
+            if( frameset ){
+                batch_queue.push( frameset );
+            }
+        } );
+        return;
+    }
 #endif
 
     // Start Pipeline
     pipeline_profile = pipeline.start( config );
+
+#if defined( SYNTHETIC ) && defined( RECORD )
+    // Start Generating Frames of Synthetic Device
+    synthetic.start( pipeline_profile );
+#endif
+
+#ifdef RECORD
+    // Start Segmented Recording of Active Streams
+    if( enable_segmented && !enable_pretrigger ){
+        segmented_recorder.reset( new segment_recorder( pipeline_profile, segmented_options ) );
+        std::cout << "segment : " << segmented_recorder->file_name() << std::endl;
+    }
+#endif
 }
 
 // Finalize
@@ -74,8 +193,45 @@ void RealSense::finalize()
     // Close Windows
     cv::destroyAllWindows();
 
-    // Stop Pipline
-    pipeline.stop();
+    // Release Callback Waiting for Queue
+    batch_queue.close();
+
+#if defined( SYNTHETIC ) && defined( RECORD )
+    // Stop Generating Frames of Synthetic Device before Pipeline
+    synthetic.stop();
+#endif
+
+    // Stop Pipline (Pipeline is not Started in Prefetch Playback)
+    if( !prefetch_reader ){
+        pipeline.stop();
+    }
+
+    // Write Remaining Frames of Pre-Trigger Recording
+    if( trigger_recorder ){
+        trigger_recorder.reset();
+    }
+
+    // Close Segmented Recording
+    if( segmented_recorder ){
+        segmented_recorder.reset();
+    }
+
+    // Write Queued Frames of Disk Recording
+    if( monitored_recorder ){
+        std::cout << monitored_recorder->report() << std::endl;
+        monitored_recorder.reset();
+    }
+
+    // Report Batch Playback Speed
+    if( enable_batch_playback && batch_framesets ){
+        reportBatch();
+    }
+
+    // Report Prefetch Playback
+    if( prefetch_reader ){
+        reportPrefetch();
+        prefetch_reader.reset();
+    }
 }
 
 // Update Data
@@ -83,6 +239,9 @@ void RealSense::update()
 {
     // Update Frame
     updateFrame();
+    if( batch_finished || prefetch_reader ){
+        return;
+    }
 
     // Update Color
     updateColor();
@@ -92,20 +251,159 @@ void RealSense::update()
 
     // Update Infrared
     updateInfrared();
+
+#ifdef RECORD
+    // Encode Depth
+    encodeDepth();
+
+    // Update Pre-Trigger Recording
+    updatePretrigger();
+
+    // Update Segmented Recording
+    updateSegmented();
+
+    // Update Disk Recording
+    updateDiskRecorder();
+#else
+    // Benchmark Depth Codec
+    benchmarkDepthCodec();
+#endif
 }
 
 // Update Frame
 inline void RealSense::updateFrame()
 {
+#ifndef RECORD
+    if( prefetch_reader ){
+        // Update Prefetch Playback
+        updatePrefetch();
+        return;
+    }
+
+    if( enable_batch_playback ){
+        // Wait Next Frameset (Queue is Closed and Drained at End of File)
+        if( !batch_queue.pop( frameset ) ){
+            batch_finished = true;
+            return;
+        }
+
+        // Update Batch Playback Statistics
+        updateBatch();
+        return;
+    }
+#endif
+
     // Update Frame
     frameset = pipeline.wait_for_frames();
 }
 
+// Update Batch Playback Statistics
+inline void RealSense::updateBatch()
+{
+    // Count Frames and Track Range of Timestamps (Recorded Time)
+    for( size_t i = 0; i < frameset.size(); i++ ){
+        const double timestamp = frameset[i].get_timestamp();
+        if( batch_frames == 0 ){
+            batch_first_timestamp = batch_last_timestamp = timestamp;
+        }
+        batch_first_timestamp = std::min( batch_first_timestamp, timestamp );
+        batch_last_timestamp = std::max( batch_last_timestamp, timestamp );
+        batch_frames++;
+    }
+
+    // Report Every 30 Framesets
+    batch_framesets++;
+    if( batch_framesets % 30 == 0 ){
+        reportBatch();
+    }
+}
+
+// Report Batch Playback Speed
+inline void RealSense::reportBatch()
+{
+    const double wall = std::chrono::duration<double>( std::chrono::steady_clock::now() - batch_start ).count();
+    const double media = ( batch_last_timestamp - batch_first_timestamp ) / 1000.0;
+    std::cout << "batch playback : " << batch_framesets << " framesets"
+              << ", " << batch_frames << " frames"
+              << ", recorded " << media << " s"
+              << ", processed " << wall << " s"
+              << ", speed-up x" << ( wall > 0.0 ? media / wall : 0.0 )
+              << ", " << ( wall > 0.0 ? batch_framesets / wall : 0.0 ) << " fps" << std::endl;
+}
+
+// Update Prefetch Playback
+inline void RealSense::updatePrefetch()
+{
+    // Take Decoded Frames until Stream Repeats (One Frame per Stream for Each Update)
+    const uint64_t previous_frames = prefetch_frames;
+    std::vector<uint8_t> streams;
+    while( true ){
+        prefetch::frame frame;
+        if( prefetch_has_pending ){
+            frame = std::move( prefetch_pending );
+            prefetch_has_pending = false;
+        }
+        else if( !prefetch_reader->next( frame ) ){
+            prefetch_finished = streams.empty();
+            break;
+        }
+
+        if( std::find( streams.begin(), streams.end(), frame.header.stream ) != streams.end() ){
+            prefetch_pending = std::move( frame );
+            prefetch_has_pending = true;
+            break;
+        }
+        streams.push_back( frame.header.stream );
+
+        // Pace by Recorded Timestamp (Batch Playback Processes As Fast As Possible)
+        if( prefetch_frames++ == 0 ){
+            prefetch_first_timestamp = frame.header.timestamp;
+        }
+        if( !enable_batch_playback ){
+            const std::chrono::duration<double, std::milli> elapsed( frame.header.timestamp - prefetch_first_timestamp );
+            std::this_thread::sleep_until( prefetch_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>( elapsed ) );
+        }
+
+        // Retrieve Image of Stream
+        switch( frame.header.stream ){
+            case rs2_stream::RS2_STREAM_COLOR:
+                color_mat = frame.image;
+                break;
+            case rs2_stream::RS2_STREAM_DEPTH:
+                depth_mat = frame.image;
+                break;
+            case rs2_stream::RS2_STREAM_INFRARED:
+                infrared_mat = frame.image;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Report Every 300 Frames
+    if( prefetch_frames / 300 != previous_frames / 300 ){
+        reportPrefetch();
+    }
+}
+
+// Report Prefetch Playback
+inline void RealSense::reportPrefetch()
+{
+    const double wall = std::chrono::duration<double>( std::chrono::steady_clock::now() - prefetch_start ).count();
+    std::cout << "prefetch playback : " << prefetch_frames << " frames"
+              << ", " << ( wall > 0.0 ? prefetch_frames / wall : 0.0 ) << " fps"
+              << ", average wait " << prefetch_reader->average_wait() * 1000.0 << " ms"
+              << ", " << prefetch_reader->ready() << "/" << prefetch_options.depth << " frames ready" << std::endl;
+}
+
 // Update Color
 inline void RealSense::updateColor()
 {
     // Retrieve Color Flame
     color_frame = frameset.get_color_frame();
+    if( !color_frame ){
+        return;
+    }
 
     // Retrive Frame Size
     color_width = color_frame.as<rs2::video_frame>().get_width();
@@ -117,6 +415,9 @@ inline void RealSense::updateDepth()
 {
     // Retrieve Depth Flame
     depth_frame = frameset.get_depth_frame();
+    if( !depth_frame ){
+        return;
+    }
 
     // Retrive Frame Size
     depth_width = depth_frame.as<rs2::video_frame>().get_width();
@@ -127,16 +428,160 @@ inline void RealSense::updateDepth()
 inline void RealSense::updateInfrared()
 {
     // Retrieve Infrared Flame
-    infrared_frame = frameset.first( rs2_stream::RS2_STREAM_INFRARED );
+    infrared_frame = frameset.first_or_default( rs2_stream::RS2_STREAM_INFRARED );
+    if( !infrared_frame ){
+        return;
+    }
 
     // Retrive Frame Size
     infrared_width = infrared_frame.as<rs2::video_frame>().get_width();
     infrared_height = infrared_frame.as<rs2::video_frame>().get_height();
 }
 
+// Encode Depth
+inline void RealSense::encodeDepth()
+{
+    if( !depth_codec_file.is_open() || !depth_frame ){
+        return;
+    }
+
+    // Encode Depth Frame in Parallel Tiles
+    const uint16_t* depth = static_cast<const uint16_t*>( depth_frame.get_data() );
+    depth_codec::encode_tiled( depth, depth_width, depth_height, depth_codec_tiles, depth_codec_buffer, depth_codec_tile_buffers );
+
+    // Write Encoded Frame
+    const uint64_t frame_number = depth_frame.get_frame_number();
+    const double timestamp = depth_frame.get_timestamp();
+    const uint32_t size = static_cast<uint32_t>( depth_codec_buffer.size() );
+    depth_codec_file.write( reinterpret_cast<const char*>( &frame_number ), sizeof( frame_number ) );
+    depth_codec_file.write( reinterpret_cast<const char*>( &timestamp ), sizeof( timestamp ) );
+    depth_codec_file.write( reinterpret_cast<const char*>( &size ), sizeof( size ) );
+    depth_codec_file.write( reinterpret_cast<const char*>( depth_codec_buffer.data() ), size );
+}
+
+// Update Pre-Trigger Recording
+inline void RealSense::updatePretrigger()
+{
+    if( !trigger_recorder ){
+        return;
+    }
+
+    // Push Frames to Ring
+    trigger_recorder->push( color_frame );
+    trigger_recorder->push( depth_frame );
+    trigger_recorder->push( infrared_frame );
+
+    // Trigger by Signal
+    if( trigger_requested ){
+        trigger_requested = 0;
+        trigger();
+    }
+}
+
+// Update Segmented Recording
+inline void RealSense::updateSegmented()
+{
+    if( !segmented_recorder ){
+        return;
+    }
+
+    // Push Frames to Current Segment
+    segmented_recorder->push( color_frame );
+    segmented_recorder->push( depth_frame );
+    segmented_recorder->push( infrared_frame );
+}
+
+// Update Disk Recording
+inline void RealSense::updateDiskRecorder()
+{
+    if( !monitored_recorder ){
+        return;
+    }
+
+    // Push Frames to Queues
+    monitored_recorder->push( color_frame );
+    monitored_recorder->push( depth_frame );
+    monitored_recorder->push( infrared_frame );
+
+    // Report Telemetry Every Second
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if( now - disk_report_time >= std::chrono::seconds( 1 ) ){
+        std::cout << monitored_recorder->report() << std::endl;
+        disk_report_time = now;
+    }
+}
+
+// Benchmark Depth Codec
+inline void RealSense::benchmarkDepthCodec()
+{
+    if( !enable_depth_codec_benchmark || !depth_frame ){
+        return;
+    }
+
+    const uint16_t* depth = static_cast<const uint16_t*>( depth_frame.get_data() );
+    const size_t num_pixels = static_cast<size_t>( depth_width ) * depth_height;
+    depth_decoded.resize( num_pixels );
+    if( depth_codec_buffer.size() < depth_codec::bound( num_pixels ) ){
+        depth_codec_buffer.resize( depth_codec::bound( num_pixels ) );
+    }
+
+    auto elapsed = []( const std::chrono::high_resolution_clock::time_point& start ) -> double {
+        return std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - start ).count();
+    };
+
+    // Single Thread
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    const size_t size = depth_codec::encode( depth, num_pixels, depth_codec_buffer.data() );
+    benchmark_encode_time += elapsed( start );
+
+    start = std::chrono::high_resolution_clock::now();
+    depth_codec::decode( depth_codec_buffer.data(), size, depth_decoded.data(), num_pixels );
+    benchmark_decode_time += elapsed( start );
+
+    // Mismatch of Round Trip is Counted and Reported (Playback is not Stopped by Benchmark)
+    if( std::memcmp( depth, depth_decoded.data(), num_pixels * sizeof( uint16_t ) ) != 0 ){
+        benchmark_mismatches++;
+    }
+
+    // Parallel Tiles
+    start = std::chrono::high_resolution_clock::now();
+    depth_codec::encode_tiled( depth, depth_width, depth_height, depth_codec_tiles, depth_tiled, depth_codec_tile_buffers );
+    benchmark_tiled_encode_time += elapsed( start );
+
+    uint32_t width, height;
+    start = std::chrono::high_resolution_clock::now();
+    depth_codec::decode_tiled( depth_tiled.data(), depth_tiled.size(), depth_decoded, width, height );
+    benchmark_tiled_decode_time += elapsed( start );
+
+    if( std::memcmp( depth, depth_decoded.data(), num_pixels * sizeof( uint16_t ) ) != 0 ){
+        benchmark_mismatches++;
+    }
+
+    // Report Every 30 Frames
+    benchmark_frames++;
+    benchmark_raw_bytes += num_pixels * sizeof( uint16_t );
+    benchmark_encoded_bytes += size;
+    if( benchmark_frames % 30 == 0 ){
+        const double megabytes = benchmark_raw_bytes / ( 1024.0 * 1024.0 );
+        std::cout << "depth codec : " << benchmark_frames << " frames"
+                  << ", ratio " << static_cast<double>( benchmark_raw_bytes ) / benchmark_encoded_bytes
+                  << ", encode " << megabytes / benchmark_encode_time << " MB/s"
+                  << ", decode " << megabytes / benchmark_decode_time << " MB/s"
+                  << ", tiled encode " << megabytes / benchmark_tiled_encode_time << " MB/s"
+                  << ", tiled decode " << megabytes / benchmark_tiled_decode_time << " MB/s"
+                  << " (" << depth_codec_tiles << " tiles)"
+                  << ", " << benchmark_mismatches << " not lossless" << std::endl;
+    }
+}
+
 // Draw Data
 void RealSense::draw()
 {
+    // Images are Decoded by Prefetch Playback
+    if( prefetch_reader ){
+        return;
+    }
+
     // Draw Color
     drawColor();
 
@@ -150,6 +595,12 @@ void RealSense::draw()
 // Draw Color
 inline void RealSense::drawColor()
 {
+    // Frameset may not Contain Color Frame (Release Previous Image)
+    if( !color_frame ){
+        color_mat = cv::Mat();
+        return;
+    }
+
     // Create cv::Mat form Color Frame
     color_mat = cv::Mat( color_height, color_width, CV_8UC3, const_cast<void*>( color_frame.get_data() ) );
 }
@@ -157,6 +608,12 @@ inline void RealSense::drawColor()
 // Draw Depth
 inline void RealSense::drawDepth()
 {
+    // Frameset may not Contain Depth Frame (Release Previous Image)
+    if( !depth_frame ){
+        depth_mat = cv::Mat();
+        return;
+    }
+
     // Create cv::Mat form Depth Frame
     depth_mat = cv::Mat( depth_height, depth_width, CV_16SC1, const_cast<void*>( depth_frame.get_data() ) );
 }
@@ -164,6 +621,12 @@ inline void RealSense::drawDepth()
 // Draw Infrared
 inline void RealSense::drawInfrared()
 {
+    // Frameset may not Contain Infrared Frame (Release Previous Image)
+    if( !infrared_frame ){
+        infrared_mat = cv::Mat();
+        return;
+    }
+
     // Create cv::Mat form Infrared Frame
     infrared_mat = cv::Mat( infrared_height, infrared_width, CV_8UC1, const_cast<void*>( infrared_frame.get_data() ) );
 }
@@ -4,11 +4,32 @@
 #include <librealsense2/rs.hpp>
 #include <opencv2/opencv.hpp>
 
+#ifdef SYNTHETIC
+#include "synthetic_device.h"
+#endif
+
+#include "depth_codec.h"
+#include "bounded_queue.h"
+#include "pretrigger_recorder.h"
+#include "segment_recorder.h"
+#include "disk_recorder.h"
+#include "frame_reader.h"
+
 #include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <memory>
 
 class RealSense
 {
 private:
+#ifdef SYNTHETIC
+    // Synthetic Device
+    rs2::context context;
+    synthetic_device synthetic;
+#endif
+
     // RealSense
     rs2::pipeline pipeline;
     rs2::pipeline_profile pipeline_profile;
@@ -38,6 +59,65 @@ private:
     // File
     std::string file_name = "file.bag";
 
+    // Pre-Trigger Recording (Keep Last Seconds in Memory, Write on Trigger instead of Recording Everything)
+    bool enable_pretrigger = false;
+    pretrigger::options pretrigger_options;
+    std::unique_ptr<pretrigger_recorder> trigger_recorder;
+
+    // Segmented Recording (Rotate File by Time or Size, Delete Oldest Files)
+    bool enable_segmented = false;
+    segmented::options segmented_options;
+    std::unique_ptr<segment_recorder> segmented_recorder;
+
+    // Disk Recording (Measure Throughput, Degrade Streams when Disk Falls Behind, Log Gaps)
+    bool enable_disk_recorder = false;
+    disk::options disk_options;
+    std::unique_ptr<disk_recorder> monitored_recorder;
+    std::chrono::steady_clock::time_point disk_report_time;
+
+    // Batch Playback (As Fast As Possible, Every Frame Exactly Once)
+    bool enable_batch_playback = false;
+    bounded_queue<rs2::frameset> batch_queue;
+    bool batch_finished = false;
+    uint64_t batch_framesets = 0;
+    uint64_t batch_frames = 0;
+    double batch_first_timestamp = 0.0;
+    double batch_last_timestamp = 0.0;
+    std::chrono::steady_clock::time_point batch_start;
+
+    // Prefetch Playback (Read Ahead Frame File and Decode on Worker Pool instead of Playback Device)
+    bool enable_prefetch_playback = false;
+    std::string prefetch_file_name = "file.frames";
+    prefetch::options prefetch_options;
+    std::unique_ptr<frame_reader> prefetch_reader;
+    prefetch::frame prefetch_pending;
+    bool prefetch_has_pending = false;
+    bool prefetch_finished = false;
+    uint64_t prefetch_frames = 0;
+    double prefetch_first_timestamp = 0.0;
+    std::chrono::steady_clock::time_point prefetch_start;
+
+    // Depth Codec (Sidecar File of Continuous Recording, Encoded on Capture Loop)
+    bool enable_depth_codec = false;
+    std::string depth_codec_file_name = "file.rvl";
+    std::ofstream depth_codec_file;
+    uint32_t depth_codec_tiles = 4;
+    std::vector<uint8_t> depth_codec_buffer;
+    std::vector<std::vector<uint8_t>> depth_codec_tile_buffers;
+
+    // Depth Codec Benchmark (Playback, Encode and Decode Every Frame)
+    bool enable_depth_codec_benchmark = false;
+    std::vector<uint16_t> depth_decoded;
+    std::vector<uint8_t> depth_tiled;
+    uint64_t benchmark_frames = 0;
+    uint64_t benchmark_raw_bytes = 0;
+    uint64_t benchmark_encoded_bytes = 0;
+    double benchmark_encode_time = 0.0;
+    double benchmark_decode_time = 0.0;
+    double benchmark_tiled_encode_time = 0.0;
+    double benchmark_tiled_decode_time = 0.0;
+    uint64_t benchmark_mismatches = 0;
+
 public:
     // Constructor
     RealSense();
@@ -48,6 +128,9 @@ public:
     // Processing
     void run();
 
+    // Trigger Pre-Trigger Recording (Thread-Safe)
+    void trigger();
+
 private:
     // Initialize
     void initialize();
@@ -64,6 +147,18 @@ private:
     // Update Frame
     inline void updateFrame();
 
+    // Update Batch Playback Statistics
+    inline void updateBatch();
+
+    // Report Batch Playback Speed
+    inline void reportBatch();
+
+    // Update Prefetch Playback
+    inline void updatePrefetch();
+
+    // Report Prefetch Playback
+    inline void reportPrefetch();
+
     // Update Color
     inline void updateColor();
 
@@ -73,6 +168,21 @@ private:
     // Update Infrared
     inline void updateInfrared();
 
+    // Encode Depth
+    inline void encodeDepth();
+
+    // Update Pre-Trigger Recording
+    inline void updatePretrigger();
+
+    // Update Segmented Recording
+    inline void updateSegmented();
+
+    // Update Disk Recording
+    inline void updateDiskRecorder();
+
+    // Benchmark Depth Codec
+    inline void benchmarkDepthCodec();
+
     // Draw Data
     void draw();
 
@@ -0,0 +1,404 @@
+// This is minimum implementation of rolling segmented recorder.
+// Frames of live pipeline are re-published through software device, and software device is recorded by rs2::recorder to segment file (.bag).
+// Segment is rotated every N seconds or N bytes by switching to next segment that is preopened in background thread, so live capture is never restarted and no frames are dropped at boundary.
+// Closing segments and deleting oldest segments (retention) are also done in background thread.
+// Recording can be paused and resumed with rs2::recorder::pause()/resume().
+
+#ifndef __SEGMENT_RECORDER__
+#define __SEGMENT_RECORDER__
+
+#include <librealsense2/rs.hpp>
+#include <librealsense2/hpp/rs_internal.hpp>
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+namespace segmented
+{
+    // Options
+    struct options
+    {
+        double duration = 600.0; // seconds per segment (0 is unlimited)
+        uint64_t size = static_cast<uint64_t>( 4 ) << 30; // bytes of frame data per segment (0 is unlimited)
+        uint32_t max_segments = 0; // number of closed segments to keep (0 is unlimited)
+        uint64_t max_bytes = 0; // bytes of closed segments to keep (0 is unlimited)
+        std::string prefix = "segment"; // file name is prefix_YYYYMMDD_HHMMSS_NNNN.bag
+    };
+}
+
+class segment_recorder
+{
+private:
+    // Stream of Segment (Software Sensor and Profile that Mirrors Live Stream)
+    struct stream
+    {
+        rs2::software_sensor sensor;
+        rs2::stream_profile profile;
+    };
+
+    // Segment
+    struct segment
+    {
+        uint32_t index = 0;
+        std::string file_name;
+        rs2::software_device device;
+        std::map<int32_t, stream> streams; // key is unique id of live stream
+        std::unique_ptr<rs2::recorder> recorder;
+        std::vector<rs2::sensor> sensors; // sensors of recorder
+        std::chrono::steady_clock::time_point start;
+        uint64_t bytes = 0;
+    };
+
+    // Closed Segment (for Retention)
+    struct closed
+    {
+        std::string file_name;
+        uint64_t bytes;
+    };
+
+    segmented::options option;
+    rs2::pipeline_profile pipeline_profile;
+
+    // Current Segment (Capture Thread Only)
+    std::unique_ptr<segment> current;
+    bool paused = false;
+
+    // Shared with Background Thread
+    std::unique_ptr<segment> next;
+    std::deque<std::unique_ptr<segment>> closing;
+    std::deque<closed> finished;
+    uint32_t next_index = 0;
+    bool stopping = false;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+public:
+    segment_recorder( const rs2::pipeline_profile& pipeline_profile, const segmented::options& option = segmented::options() )
+        : option( option )
+        , pipeline_profile( pipeline_profile )
+    {
+        // Open First Segment, and Preopen Next Segment in Background
+        current = create( next_index++, false );
+        thread = std::thread( &segment_recorder::work, this );
+    }
+
+    ~segment_recorder()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            closing.push_back( std::move( current ) );
+            stopping = true;
+        }
+        condition.notify_all();
+        thread.join();
+
+        // Remove Preopened Segment that was never Used
+        if( next ){
+            const std::string file_name = next->file_name;
+            close( *next );
+            next.reset();
+            std::remove( file_name.c_str() );
+        }
+    }
+
+    segment_recorder( const segment_recorder& ) = delete;
+    segment_recorder& operator=( const segment_recorder& ) = delete;
+
+    // Push Video Frame of Live Stream (Capture Thread)
+    void push( const rs2::frame& frame )
+    {
+        if( !frame ){
+            return;
+        }
+
+        // Rotate Segment
+        if( due() ){
+            rotate();
+        }
+
+        const std::map<int32_t, stream>::iterator it = current->streams.find( frame.get_profile().unique_id() );
+        if( it == current->streams.end() ){
+            return;
+        }
+
+        // Copy Frame Data to Software Sensor (Frame is Recorded through Recorder)
+        const rs2::video_frame video_frame = frame.as<rs2::video_frame>();
+        const int32_t stride = video_frame.get_stride_in_bytes();
+        const size_t size = static_cast<size_t>( stride ) * video_frame.get_height();
+        uint8_t* pixels = new uint8_t[size];
+        std::memcpy( pixels, video_frame.get_data(), size );
+        it->second.sensor.on_video_frame( { pixels, []( void* pixels ){ delete[] static_cast<uint8_t*>( pixels ); }, stride, video_frame.get_bytes_per_pixel(), frame.get_timestamp(), frame.get_frame_timestamp_domain(), static_cast<int32_t>( frame.get_frame_number() ), it->second.profile.get() } );
+
+        if( !paused ){
+            current->bytes += size;
+        }
+    }
+
+    // Pause Recording (Frames are not Written until Resumed)
+    void pause()
+    {
+        if( !paused ){
+            current->recorder->pause();
+            paused = true;
+        }
+    }
+
+    // Resume Recording
+    void resume()
+    {
+        if( paused ){
+            current->recorder->resume();
+            paused = false;
+        }
+    }
+
+    bool is_paused() const
+    {
+        return paused;
+    }
+
+    // File Name of Current Segment
+    const std::string& file_name() const
+    {
+        return current->file_name;
+    }
+
+private:
+    // Segment Reached Duration or Size
+    bool due() const
+    {
+        const bool duration = option.duration > 0.0 && std::chrono::duration<double>( std::chrono::steady_clock::now() - current->start ).count() >= option.duration;
+        const bool size = option.size > 0 && current->bytes >= option.size;
+        return duration || size;
+    }
+
+    // Switch to Preopened Segment (Keep Current Segment if Next Segment is not Ready Yet)
+    void rotate()
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        if( !next ){
+            return;
+        }
+
+        std::unique_ptr<segment> prepared = std::move( next );
+        if( !paused ){
+            prepared->recorder->resume();
+        }
+        prepared->start = std::chrono::steady_clock::now();
+        closing.push_back( std::move( current ) );
+        current = std::move( prepared );
+        lock.unlock();
+
+        condition.notify_all();
+        std::cout << "segment : " << current->file_name << std::endl;
+    }
+
+    // File Name from Current Time and Index
+    std::string name( const uint32_t index ) const
+    {
+        const std::time_t now = std::time( nullptr );
+        char buffer[48];
+        std::strftime( buffer, sizeof( buffer ), "%Y%m%d_%H%M%S", std::localtime( &now ) );
+        char number[16];
+        std::snprintf( number, sizeof( number ), "_%04u", index );
+        return option.prefix + "_" + buffer + number + ".bag";
+    }
+
+    // Create Segment that Mirrors Streams of Live Device, and Start Recording
+    // Preopened segment is paused until it is used, so that time of waiting is not included in timeline of recording.
+    std::unique_ptr<segment> create( const uint32_t index, const bool pause )
+    {
+        std::unique_ptr<segment> segment( new segment_recorder::segment );
+        segment->index = index;
+        segment->file_name = name( index );
+
+        // Copy Device Info
+        const rs2::device live_device = pipeline_profile.get_device();
+        for( const rs2_camera_info info : { RS2_CAMERA_INFO_NAME, RS2_CAMERA_INFO_SERIAL_NUMBER, RS2_CAMERA_INFO_FIRMWARE_VERSION } ){
+            if( live_device.supports( info ) ){
+                segment->device.register_info( info, live_device.get_info( info ) );
+            }
+        }
+
+        // Add Software Sensor for Each Live Sensor that has Active Streams
+        const std::vector<rs2::stream_profile> active = pipeline_profile.get_streams();
+        for( const rs2::sensor& live_sensor : live_device.query_sensors() ){
+            std::vector<rs2::video_stream_profile> profiles;
+            for( const rs2::stream_profile& live_profile : live_sensor.get_stream_profiles() ){
+                for( const rs2::stream_profile& profile : active ){
+                    if( profile.unique_id() == live_profile.unique_id() && profile.is<rs2::video_stream_profile>() ){
+                        profiles.push_back( profile.as<rs2::video_stream_profile>() );
+                    }
+                }
+            }
+            if( profiles.empty() ){
+                continue;
+            }
+
+            rs2::software_sensor sensor = segment->device.add_sensor( live_sensor.get_info( RS2_CAMERA_INFO_NAME ) );
+            if( live_sensor.is<rs2::depth_sensor>() ){
+                sensor.add_read_only_option( RS2_OPTION_DEPTH_UNITS, live_sensor.as<rs2::depth_sensor>().get_depth_scale() );
+            }
+            for( const rs2::video_stream_profile& profile : profiles ){
+                const rs2_intrinsics intrinsics = profile.get_intrinsics();
+                const int32_t bpp = bytes_per_pixel( profile.format() );
+                const rs2::stream_profile software_profile = sensor.add_video_stream( { profile.stream_type(), profile.stream_index(), profile.unique_id(), profile.width(), profile.height(), profile.fps(), bpp, profile.format(), intrinsics }, true );
+                segment->streams.insert( std::make_pair( profile.unique_id(), stream{ sensor, software_profile } ) );
+            }
+        }
+
+        // Copy Extrinsics between Streams
+        for( std::pair<const int32_t, stream>& from : segment->streams ){
+            for( const std::pair<const int32_t, stream>& to : segment->streams ){
+                if( from.first == to.first ){
+                    continue;
+                }
+                const rs2_extrinsics extrinsics = find( active, from.first ).get_extrinsics_to( find( active, to.first ) );
+                from.second.profile.register_extrinsics_to( to.second.profile, extrinsics );
+            }
+        }
+
+        // Start Recording (File is Opened Here)
+        segment->recorder.reset( new rs2::recorder( segment->file_name, segment->device ) );
+        for( rs2::sensor& sensor : segment->recorder->query_sensors() ){
+            const std::vector<rs2::stream_profile> profiles = sensor.get_stream_profiles();
+            if( profiles.empty() ){
+                continue;
+            }
+            sensor.open( profiles );
+            sensor.start( []( rs2::frame ){} );
+            segment->sensors.push_back( sensor );
+        }
+
+        if( pause ){
+            segment->recorder->pause();
+        }
+
+        segment->start = std::chrono::steady_clock::now();
+        return segment;
+    }
+
+    // Stop Recording and Close File
+    void close( segment& segment )
+    {
+        for( rs2::sensor& sensor : segment.sensors ){
+            sensor.stop();
+            sensor.close();
+        }
+        segment.sensors.clear();
+        segment.recorder.reset();
+    }
+
+    // Delete Oldest Segments over Retention Limits
+    void retain()
+    {
+        uint64_t total = 0;
+        for( const closed& closed : finished ){
+            total += closed.bytes;
+        }
+
+        while( !finished.empty() && ( ( option.max_segments && finished.size() > option.max_segments ) || ( option.max_bytes && total > option.max_bytes ) ) ){
+            std::remove( finished.front().file_name.c_str() );
+            std::cout << "segment : " << finished.front().file_name << " is deleted (retention)" << std::endl;
+            total -= finished.front().bytes;
+            finished.pop_front();
+        }
+    }
+
+    // Background Thread (Close Segments, Delete Old Segments, Preopen Next Segment)
+    void work()
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        while( true ){
+            if( !closing.empty() ){
+                std::unique_ptr<segment> closed_segment = std::move( closing.front() );
+                closing.pop_front();
+                lock.unlock();
+                close( *closed_segment );
+                std::ifstream file( closed_segment->file_name, std::ios::binary | std::ios::ate );
+                const closed closed = { closed_segment->file_name, file ? static_cast<uint64_t>( file.tellg() ) : 0 };
+                closed_segment.reset();
+                lock.lock();
+                finished.push_back( closed );
+                retain();
+                continue;
+            }
+
+            if( stopping ){
+                break;
+            }
+
+            if( !next ){
+                const uint32_t index = next_index++;
+                lock.unlock();
+                std::unique_ptr<segment> prepared;
+                try{
+                    prepared = create( index, true );
+                }
+                catch( const std::exception& ex ){
+                    std::cout << "segment : failed to preopen next segment (" << ex.what() << ")" << std::endl;
+                }
+                lock.lock();
+                if( prepared ){
+                    next = std::move( prepared );
+                }
+                else{
+                    condition.wait_for( lock, std::chrono::seconds( 1 ) );
+                }
+                continue;
+            }
+
+            condition.wait( lock );
+        }
+    }
+
+    // Find Profile by Unique ID
+    static rs2::stream_profile find( const std::vector<rs2::stream_profile>& profiles, const int32_t unique_id )
+    {
+        for( const rs2::stream_profile& profile : profiles ){
+            if( profile.unique_id() == unique_id ){
+                return profile;
+            }
+        }
+        return rs2::stream_profile();
+    }
+
+    // Bytes per Pixel of Video Format
+    static int32_t bytes_per_pixel( const rs2_format format )
+    {
+        switch( format ){
+            case RS2_FORMAT_Z16:
+            case RS2_FORMAT_DISPARITY16:
+            case RS2_FORMAT_Y16:
+            case RS2_FORMAT_YUYV:
+            case RS2_FORMAT_UYVY:
+                return 2;
+            case RS2_FORMAT_RGB8:
+            case RS2_FORMAT_BGR8:
+                return 3;
+            case RS2_FORMAT_RGBA8:
+            case RS2_FORMAT_BGRA8:
+            case RS2_FORMAT_DISPARITY32:
+                return 4;
+            default:
+                return 1;
+        }
+    }
+};
+
+#endif // __SEGMENT_RECORDER__
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include <iostream>
+#include <sstream>
+
+#include "reprocess.h"
+
+int main( int argc, char* argv[] )
+{
+    try{
+        Reprocess reprocess( argc, argv );
+        reprocess.run();
+    } catch( std::exception& ex ){
+        std::cout << ex.what() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,291 @@
+#include "reprocess.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+// Constructor
+Reprocess::Reprocess( int argc, char* argv[] )
+{
+    // Initialize
+    initialize( argc, argv );
+}
+
+// Destructor
+Reprocess::~Reprocess()
+{
+    // Finalize
+    finalize();
+}
+
+// Processing
+void Reprocess::run()
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Process Each Range on Its Own Worker
+    worker_results.assign( ranges.size(), std::vector<result>() );
+    std::vector<std::exception_ptr> exceptions( ranges.size() );
+    std::vector<std::thread> threads;
+    for( size_t i = 0; i < ranges.size(); i++ ){
+        threads.emplace_back( [this, i, &exceptions](){
+            try{
+                process( ranges[i], worker_results[i] );
+            }
+            catch( ... ){
+                exceptions[i] = std::current_exception();
+            }
+        } );
+    }
+    for( std::thread& thread : threads ){
+        thread.join();
+    }
+    for( const std::exception_ptr& exception : exceptions ){
+        if( exception ){
+            std::rethrow_exception( exception );
+        }
+    }
+
+    elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    // Merge Results of Workers
+    merge();
+
+    // Report Result
+    report();
+}
+
+// Initialize
+void Reprocess::initialize( int argc, char* argv[] )
+{
+    cv::setUseOptimized( true );
+
+    // Parse Arguments
+    parseArguments( argc, argv );
+
+    // Split Recording into Ranges
+    split();
+}
+
+// Parse Arguments
+inline void Reprocess::parseArguments( int argc, char* argv[] )
+{
+    const std::string usage = "usage : Reprocess [--workers N] [--warmup seconds] [--output reprocess.csv] file.bag";
+    for( int32_t i = 1; i < argc; i++ ){
+        const std::string argument = argv[i];
+        const bool has_value = i + 1 < argc;
+        if( argument == "--workers" && has_value ){
+            workers = static_cast<uint32_t>( std::stoul( argv[++i] ) );
+        }
+        else if( argument == "--warmup" && has_value ){
+            warmup = std::stod( argv[++i] );
+        }
+        else if( argument == "--output" && has_value ){
+            output_file_name = argv[++i];
+        }
+        else if( !argument.empty() && argument[0] != '-' ){
+            file_name = argument;
+        }
+        else{
+            throw std::runtime_error( usage );
+        }
+    }
+
+    if( file_name.empty() || warmup < 0.0 ){
+        throw std::runtime_error( usage );
+    }
+
+    if( !workers ){
+        workers = std::max( std::thread::hardware_concurrency(), 1u );
+    }
+}
+
+// Split Recording into Ranges
+inline void Reprocess::split()
+{
+    // Retrieve Duration from Index of Recording
+    rs2::context context;
+    rs2::playback playback = context.load_device( file_name );
+    duration = playback.get_duration();
+
+    // Split into Equal Ranges (Range is not Shorter than Warm-Up)
+    const std::chrono::nanoseconds minimum = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::duration<double>( std::max( warmup, 1.0 ) ) );
+    const int64_t count = std::max<int64_t>( 1, std::min<int64_t>( workers, duration.count() / minimum.count() ) );
+    ranges.clear();
+    for( int64_t i = 0; i < count; i++ ){
+        range range;
+        range.begin = std::chrono::nanoseconds( duration.count() * i / count );
+        range.end = std::chrono::nanoseconds( duration.count() * ( i + 1 ) / count );
+        ranges.push_back( range );
+    }
+    ranges.back().end = std::chrono::nanoseconds::max();
+
+    std::cout << file_name << " : " << std::chrono::duration<double>( duration ).count() << " s, " << ranges.size() << " ranges" << std::endl;
+}
+
+// Finalize
+void Reprocess::finalize()
+{
+}
+
+// Process Range (Worker)
+void Reprocess::process( const range& range, std::vector<result>& results )
+{
+    // Open Playback Device of This Worker (Each Device Decodes on Its Own Thread)
+    rs2::context context;
+    rs2::playback playback = context.load_device( file_name );
+    playback.set_real_time( false );
+
+    // Find Depth Stream
+    rs2::sensor depth_sensor;
+    rs2::stream_profile depth_profile;
+    for( const rs2::sensor& sensor : playback.query_sensors() ){
+        for( const rs2::stream_profile& profile : sensor.get_stream_profiles() ){
+            if( profile.stream_type() == rs2_stream::RS2_STREAM_DEPTH && profile.format() == rs2_format::RS2_FORMAT_Z16 ){
+                depth_sensor = sensor;
+                depth_profile = profile;
+            }
+        }
+    }
+    if( !depth_profile ){
+        throw std::runtime_error( "depth stream is not found in " + file_name );
+    }
+    const double depth_scale = rs2::depth_sensor( depth_sensor ).get_depth_scale();
+
+    // Filters of This Worker (Temporal Filter has State)
+    rs2::disparity_transform depth_to_disparity( true );
+    rs2::disparity_transform disparity_to_depth( false );
+    rs2::spatial_filter spatial_filter;
+    rs2::temporal_filter temporal_filter;
+
+    // Warm-Up Starts before Range, and Guard Continues after Range
+    const std::chrono::nanoseconds warmup_begin = std::max( std::chrono::nanoseconds( 0 ), range.begin - std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::duration<double>( warmup ) ) );
+    const std::chrono::nanoseconds guard_end = ( range.end == std::chrono::nanoseconds::max() ) ? range.end : range.end + std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::duration<double>( guard ) );
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<bool> finished( false );
+    auto finish = [&](){
+        std::lock_guard<std::mutex> lock( mutex );
+        finished = true;
+        condition.notify_all();
+    };
+
+    // Finish at End of File
+    playback.set_status_changed_callback( [&]( const rs2_playback_status status ){
+        if( status == rs2_playback_status::RS2_PLAYBACK_STATUS_STOPPED ){
+            finish();
+        }
+    } );
+
+    // Seek to Warm-Up Position before Start
+    playback.seek( warmup_begin );
+
+    // Process Frames in Callback (Position of Non Real-Time Playback is of This Frame)
+    depth_sensor.open( depth_profile );
+    depth_sensor.start( [&]( rs2::frame frame ){
+        if( finished ){
+            return;
+        }
+
+        const std::chrono::nanoseconds position = playback.get_position();
+        if( position < warmup_begin ){
+            return;
+        }
+        if( position >= guard_end ){
+            finish();
+            return;
+        }
+
+        // Apply Filters (Warm-Up Frames Update State of Temporal Filter Only)
+        rs2::frame filtered = depth_to_disparity.process( frame );
+        filtered = spatial_filter.process( filtered );
+        filtered = temporal_filter.process( filtered );
+        filtered = disparity_to_depth.process( filtered );
+        if( position < range.begin ){
+            return;
+        }
+
+        // Calculate Statistics of Filtered Depth
+        const rs2::video_frame video_frame = filtered.as<rs2::video_frame>();
+        const cv::Mat depth_mat( video_frame.get_height(), video_frame.get_width(), CV_16UC1, const_cast<void*>( video_frame.get_data() ) );
+        const cv::Mat valid_mat = depth_mat > 0;
+        const int32_t valid = cv::countNonZero( valid_mat );
+
+        result result;
+        result.frame_number = frame.get_frame_number();
+        result.timestamp = frame.get_timestamp();
+        result.position = position;
+        result.owned = position < range.end;
+        result.valid = static_cast<double>( valid ) / depth_mat.total();
+        result.mean = valid ? cv::mean( depth_mat, valid_mat )[0] * depth_scale : 0.0;
+        results.push_back( result );
+    } );
+
+    // Wait until Range is Processed
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        condition.wait( lock, [&]{ return finished.load(); } );
+    }
+
+    depth_sensor.stop();
+    depth_sensor.close();
+}
+
+// Merge Results of Workers in Timestamp Order
+inline void Reprocess::merge()
+{
+    results.clear();
+    for( const std::vector<result>& worker_result : worker_results ){
+        results.insert( results.end(), worker_result.begin(), worker_result.end() );
+    }
+
+    // Sort by Timestamp (Result of Owner is First when Frame is Processed by Two Workers at Boundary)
+    std::sort( results.begin(), results.end(), []( const result& a, const result& b ){
+        if( a.timestamp != b.timestamp ){
+            return a.timestamp < b.timestamp;
+        }
+        if( a.frame_number != b.frame_number ){
+            return a.frame_number < b.frame_number;
+        }
+        return a.owned && !b.owned;
+    } );
+
+    // Remove Duplicates
+    const size_t size = results.size();
+    results.erase( std::unique( results.begin(), results.end(), []( const result& a, const result& b ){
+        return a.frame_number == b.frame_number && a.timestamp == b.timestamp;
+    } ), results.end() );
+    duplicates = size - results.size();
+}
+
+// Report Result
+void Reprocess::report()
+{
+    std::ofstream ofs( output_file_name );
+    if( !ofs.is_open() ){
+        throw std::runtime_error( "failed to open " + output_file_name );
+    }
+
+    ofs << "frame_number,timestamp,position,valid,mean\n";
+    ofs << std::fixed << std::setprecision( 6 );
+    for( const result& result : results ){
+        ofs << result.frame_number << "," << result.timestamp << "," << std::chrono::duration<double>( result.position ).count() << "," << result.valid << "," << result.mean << "\n";
+    }
+
+    const double recorded = std::chrono::duration<double>( duration ).count();
+    std::cout << "reprocess : " << results.size() << " frames"
+              << ", " << ranges.size() << " workers"
+              << ", " << duplicates << " duplicates at boundaries"
+              << ", recorded " << recorded << " s"
+              << ", processed " << elapsed << " s"
+              << ", speed-up x" << ( elapsed > 0.0 ? recorded / elapsed : 0.0 )
+              << ", " << ( elapsed > 0.0 ? results.size() / elapsed : 0.0 ) << " fps" << std::endl;
+    std::cout << "result is written to " << output_file_name << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef __REPROCESS__
+#define __REPROCESS__
+
+#include <librealsense2/rs.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+// Offline Reprocessing of Recording (.bag) Sharded across Cores
+// Recording is split into time ranges, and each range is processed on its own worker thread with its own playback device.
+// Stateful filters (temporal filter) are warmed up on frames before range, and results are merged in timestamp order.
+class Reprocess
+{
+private:
+    // Settings
+    uint32_t workers = 0; // 0 is Number of Hardware Threads
+    double warmup = 1.0; // seconds before range to warm up stateful filters
+    double guard = 0.1; // seconds after range to cover frames at boundary
+
+    // File
+    std::string file_name;
+    std::string output_file_name = "reprocess.csv";
+
+    // Time Range of Recording (Position in File)
+    struct range
+    {
+        std::chrono::nanoseconds begin;
+        std::chrono::nanoseconds end;
+    };
+    std::vector<range> ranges;
+    std::chrono::nanoseconds duration;
+
+    // Result of Frame
+    struct result
+    {
+        uint64_t frame_number;
+        double timestamp; // milliseconds
+        std::chrono::nanoseconds position;
+        bool owned; // frame is inside range of worker (otherwise guard region)
+        double valid; // rate of valid pixels
+        double mean; // mean depth of valid pixels (meters)
+    };
+    std::vector<std::vector<result>> worker_results;
+    std::vector<result> results;
+
+    // Statistics
+    double elapsed = 0.0;
+    size_t duplicates = 0;
+
+public:
+    // Constructor
+    Reprocess( int argc, char* argv[] );
+
+    // Destructor
+    ~Reprocess();
+
+    // Processing
+    void run();
+
+private:
+    // Initialize
+    void initialize( int argc, char* argv[] );
+
+    // Parse Arguments
+    inline void parseArguments( int argc, char* argv[] );
+
+    // Split Recording into Ranges
+    inline void split();
+
+    // Finalize
+    void finalize();
+
+    // Process Range (Worker)
+    void process( const range& range, std::vector<result>& results );
+
+    // Merge Results of Workers in Timestamp Order
+    inline void merge();
+
+    // Report Result
+    void report();
+};
+
+#endif // __REPROCESS__
\ No newline at end of file
@@ -0,0 +1,318 @@
+#include "realsense.h"
+
+#include <fstream>
+#include <iostream>
+
+// Constructor
+RealSense::RealSense()
+{
+    // Initialize
+    initialize();
+}
+
+// Destructor
+RealSense::~RealSense()
+{
+    // Finalize
+    finalize();
+}
+
+// Processing
+void RealSense::run()
+{
+    // Main Loop
+    while( true ){
+        // Update Data
+        update();
+
+        // Draw Data
+        draw();
+
+        // Show Data
+        show();
+
+        // Key Check
+        const int32_t key = cv::waitKey( 1 );
+        if( key == 'q' ){
+            break;
+        }
+        // Reset Volume when Pressed 'r' key
+        else if( key == 'r' ){
+            volume.reset();
+        }
+        // Save Volume to File when Pressed 's' key
+        else if( key == 's' ){
+            saveVolume();
+        }
+    }
+}
+
+// Initialize
+void RealSense::initialize()
+{
+    cv::setUseOptimized( true );
+
+    // Initialize Sensor
+    initializeSensor();
+
+    // Initialize Pose
+    initializePose();
+}
+
+// Initialize Sensor
+inline void RealSense::initializeSensor()
+{
+    // Set Device Config
+    rs2::config config;
+    config.enable_stream( rs2_stream::RS2_STREAM_DEPTH, depth_width, depth_height, rs2_format::RS2_FORMAT_Z16, depth_fps );
+
+#ifdef SYNTHETIC
+    // Use Synthetic Device instead of Live Device
+    synthetic.add_to( context );
+    pipeline = rs2::pipeline( context );
+    config.enable_device( synthetic.serial() );
+#endif
+
+    // Start Pipeline
+    pipeline_profile = pipeline.start( config );
+
+#ifdef SYNTHETIC
+    // Start Generating Frames of Synthetic Device
+    synthetic.start( pipeline_profile );
+#endif
+
+    // Retrieve Depth Intrinsics and Depth Scale
+    depth_intrinsics = pipeline_profile.get_stream( rs2_stream::RS2_STREAM_DEPTH ).as<rs2::video_stream_profile>().get_intrinsics();
+    depth_scale = pipeline_profile.get_device().first<rs2::depth_sensor>().get_depth_scale();
+
+    // Ray-Cast in Half Resolution for Preview
+    raycast_intrinsics = depth_intrinsics;
+    raycast_intrinsics.width /= 2;
+    raycast_intrinsics.height /= 2;
+    raycast_intrinsics.fx /= 2.0f;
+    raycast_intrinsics.fy /= 2.0f;
+    raycast_intrinsics.ppx /= 2.0f;
+    raycast_intrinsics.ppy /= 2.0f;
+}
+
+// Initialize Pose
+inline void RealSense::initializePose()
+{
+    // Start Pipeline of Tracking Camera if Connected
+    // Camera is assumed to be static at origin without tracking camera.
+    try{
+        rs2::config config;
+        config.enable_stream( rs2_stream::RS2_STREAM_POSE, rs2_format::RS2_FORMAT_6DOF );
+        pose_pipeline.start( config );
+        pose_enabled = true;
+    } catch( const rs2::error& error ){
+        std::cout << "Pose is disabled (" << error.what() << ")" << std::endl;
+        pose_enabled = false;
+    }
+}
+
+// Finalize
+void RealSense::finalize()
+{
+    // Close Windows
+    cv::destroyAllWindows();
+
+#ifdef SYNTHETIC
+    // Stop Generating Frames of Synthetic Device before Pipeline
+    synthetic.stop();
+#endif
+
+    // Stop Pipline
+    pipeline.stop();
+    if( pose_enabled ){
+        pose_pipeline.stop();
+    }
+}
+
+// Update Data
+void RealSense::update()
+{
+    // Update Frame
+    updateFrame();
+
+    // Update Depth
+    updateDepth();
+
+    // Update Pose
+    updatePose();
+
+    // Update Volume
+    updateVolume();
+}
+
+// Update Frame
+inline void RealSense::updateFrame()
+{
+    // Update Frame
+    frameset = pipeline.wait_for_frames();
+}
+
+// Update Depth
+inline void RealSense::updateDepth()
+{
+    // Retrieve Depth Frame
+    depth_frame = frameset.get_depth_frame();
+
+    // Retrive Frame Size
+    depth_width = depth_frame.as<rs2::video_frame>().get_width();
+    depth_height = depth_frame.as<rs2::video_frame>().get_height();
+}
+
+// Update Pose
+inline void RealSense::updatePose()
+{
+    if( !pose_enabled ){
+        return;
+    }
+
+    // Retrieve Latest Pose Frame without Blocking
+    rs2::frameset pose_frameset;
+    if( !pose_pipeline.poll_for_frames( &pose_frameset ) ){
+        return;
+    }
+    pose_frame = pose_frameset.first_or_default( rs2_stream::RS2_STREAM_POSE );
+    if( !pose_frame ){
+        return;
+    }
+
+    // Convert Pose to Camera to World Transform
+    const rs2_pose pose = pose_frame.as<rs2::pose_frame>().get_pose_data();
+    const float qx = pose.rotation.x, qy = pose.rotation.y, qz = pose.rotation.z, qw = pose.rotation.w;
+    cv::Matx44f tracking_to_world = cv::Matx44f::eye();
+    tracking_to_world( 0, 0 ) = 1.0f - 2.0f * ( qy * qy + qz * qz );
+    tracking_to_world( 0, 1 ) = 2.0f * ( qx * qy - qz * qw );
+    tracking_to_world( 0, 2 ) = 2.0f * ( qx * qz + qy * qw );
+    tracking_to_world( 1, 0 ) = 2.0f * ( qx * qy + qz * qw );
+    tracking_to_world( 1, 1 ) = 1.0f - 2.0f * ( qx * qx + qz * qz );
+    tracking_to_world( 1, 2 ) = 2.0f * ( qy * qz - qx * qw );
+    tracking_to_world( 2, 0 ) = 2.0f * ( qx * qz - qy * qw );
+    tracking_to_world( 2, 1 ) = 2.0f * ( qy * qz + qx * qw );
+    tracking_to_world( 2, 2 ) = 1.0f - 2.0f * ( qx * qx + qy * qy );
+    tracking_to_world( 0, 3 ) = pose.translation.x;
+    tracking_to_world( 1, 3 ) = pose.translation.y;
+    tracking_to_world( 2, 3 ) = pose.translation.z;
+
+    // Tracking Camera is Y-Up and Z-Backward, Depth Camera is Y-Down and Z-Forward
+    // Depth camera is assumed to be mounted at origin of tracking camera.
+    cv::Matx44f camera_to_tracking = cv::Matx44f::eye();
+    camera_to_tracking( 1, 1 ) = -1.0f;
+    camera_to_tracking( 2, 2 ) = -1.0f;
+
+    camera_to_world = tracking_to_world * camera_to_tracking;
+}
+
+// Update Volume
+inline void RealSense::updateVolume()
+{
+    if( !depth_frame ){
+        return;
+    }
+
+    // Integrate Depth Frame into Volume
+    const cv::Mat depth( depth_height, depth_width, CV_16UC1, const_cast<void*>( depth_frame.get_data() ) );
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    volume.integrate( depth, depth_intrinsics, depth_scale, camera_to_world );
+    integration_time += std::chrono::steady_clock::now() - start;
+
+    // Report Integration Time
+    if( ++integrated_frames < report_frames ){
+        return;
+    }
+
+    const double milliseconds = std::chrono::duration<double, std::milli>( integration_time ).count() / integrated_frames;
+    std::cout << "Integration: " << milliseconds << " ms/frame, " << volume.allocated() << "/" << volume.capacity() << " blocks" << std::endl;
+    integrated_frames = 0;
+    integration_time = std::chrono::steady_clock::duration::zero();
+}
+
+// Draw Data
+void RealSense::draw()
+{
+    // Draw Depth
+    drawDepth();
+
+    // Draw Volume
+    drawVolume();
+}
+
+// Draw Depth
+inline void RealSense::drawDepth()
+{
+    // Create cv::Mat form Depth Frame
+    depth_mat = cv::Mat( depth_height, depth_width, CV_16UC1, const_cast<void*>( depth_frame.get_data() ) );
+}
+
+// Draw Volume
+inline void RealSense::drawVolume()
+{
+    // Ray-Cast Volume from Current Pose
+    volume.raycast( raycast_intrinsics, camera_to_world, raycast_depth_mat, raycast_shade_mat );
+}
+
+// Show Data
+void RealSense::show()
+{
+    // Show Depth
+    showDepth();
+
+    // Show Volume
+    showVolume();
+}
+
+// Show Depth
+inline void RealSense::showDepth()
+{
+    if( depth_mat.empty() ){
+        return;
+    }
+
+    // Scaling
+    cv::Mat scale_mat;
+    depth_mat.convertTo( scale_mat, CV_8U, -255.0 / 10000.0, 255.0 ); // 0-10000 -> 255(white)-0(black)
+
+    // Show Depth Image
+    cv::imshow( "Depth", scale_mat );
+}
+
+// Show Volume
+inline void RealSense::showVolume()
+{
+    if( raycast_shade_mat.empty() ){
+        return;
+    }
+
+    // Show Ray-Casted Volume Image
+    cv::imshow( "Volume", raycast_shade_mat );
+}
+
+// Save Volume
+void RealSense::saveVolume()
+{
+    // Extract Surface Points
+    std::vector<cv::Vec3f> points;
+    volume.extract( points );
+
+    // Write Point Cloud to PLY File
+    std::ofstream ofs( file_name );
+    if( !ofs.is_open() ){
+        throw std::runtime_error( "failed to open " + file_name );
+    }
+
+    ofs << "ply\n"
+        << "format ascii 1.0\n"
+        << "element vertex " << points.size() << "\n"
+        << "property float x\n"
+        << "property float y\n"
+        << "property float z\n"
+        << "end_header\n";
+    for( const cv::Vec3f& point : points ){
+        ofs << point[0] << " " << point[1] << " " << point[2] << "\n";
+    }
+
+    std::cout << "Saved " << points.size() << " points to " << file_name << std::endl;
+}
@@ -0,0 +1,117 @@
+#ifndef __REALSENSE__
+#define __REALSENSE__
+
+#include <librealsense2/rs.hpp>
+#include <opencv2/opencv.hpp>
+
+#ifdef SYNTHETIC
+#include "synthetic_device.h"
+#endif
+
+#include "tsdf_volume.h"
+
+#include <string>
+#include <chrono>
+
+class RealSense
+{
+private:
+#ifdef SYNTHETIC
+    // Synthetic Device
+    rs2::context context;
+    synthetic_device synthetic;
+#endif
+
+    // RealSense
+    rs2::pipeline pipeline;
+    rs2::pipeline_profile pipeline_profile;
+    rs2::frameset frameset;
+
+    // Depth Buffer
+    rs2::frame depth_frame;
+    cv::Mat depth_mat;
+    uint32_t depth_width = 640;
+    uint32_t depth_height = 480;
+    uint32_t depth_fps = 30;
+    rs2_intrinsics depth_intrinsics;
+    float depth_scale = 0.001f;
+
+    // Pose Buffer (Tracking Camera is Optional)
+    rs2::pipeline pose_pipeline;
+    bool pose_enabled = false;
+    rs2::frame pose_frame;
+    cv::Matx44f camera_to_world = cv::Matx44f::eye();
+
+    // Volume Buffer
+    TSDFVolume volume;
+    rs2_intrinsics raycast_intrinsics;
+    cv::Mat raycast_depth_mat;
+    cv::Mat raycast_shade_mat;
+    std::string file_name = "tsdf.ply";
+
+    // Integration Time
+    uint32_t report_frames = 30;
+    uint32_t integrated_frames = 0;
+    std::chrono::steady_clock::duration integration_time = std::chrono::steady_clock::duration::zero();
+
+public:
+    // Constructor
+    RealSense();
+
+    // Destructor
+    ~RealSense();
+
+    // Processing
+    void run();
+
+private:
+    // Initialize
+    void initialize();
+
+    // Initialize Sensor
+    inline void initializeSensor();
+
+    // Initialize Pose
+    inline void initializePose();
+
+    // Finalize
+    void finalize();
+
+    // Update Data
+    void update();
+
+    // Update Frame
+    inline void updateFrame();
+
+    // Update Depth
+    inline void updateDepth();
+
+    // Update Pose
+    inline void updatePose();
+
+    // Update Volume
+    inline void updateVolume();
+
+    // Draw Data
+    void draw();
+
+    // Draw Depth
+    inline void drawDepth();
+
+    // Draw Volume
+    inline void drawVolume();
+
+    // Show Data
+    void show();
+
+    // Show Depth
+    inline void showDepth();
+
+    // Show Volume
+    inline void showVolume();
+
+    // Save Volume
+    void saveVolume();
+};
+
+#endif // __REALSENSE__
@@ -0,0 +1,375 @@
+#include "tsdf_volume.h"
+
+#include <algorithm>
+#include <cmath>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Transform Point by 4x4 Rigid Transform
+static inline cv::Vec3f transformPoint( const cv::Matx44f& transform, const float x, const float y, const float z )
+{
+    return cv::Vec3f( transform( 0, 0 ) * x + transform( 0, 1 ) * y + transform( 0, 2 ) * z + transform( 0, 3 ),
+                      transform( 1, 0 ) * x + transform( 1, 1 ) * y + transform( 1, 2 ) * z + transform( 1, 3 ),
+                      transform( 2, 0 ) * x + transform( 2, 1 ) * y + transform( 2, 2 ) * z + transform( 2, 3 ) );
+}
+
+// Rotate Direction by 4x4 Rigid Transform
+static inline cv::Vec3f rotateDirection( const cv::Matx44f& transform, const float x, const float y, const float z )
+{
+    return cv::Vec3f( transform( 0, 0 ) * x + transform( 0, 1 ) * y + transform( 0, 2 ) * z,
+                      transform( 1, 0 ) * x + transform( 1, 1 ) * y + transform( 1, 2 ) * z,
+                      transform( 2, 0 ) * x + transform( 2, 1 ) * y + transform( 2, 2 ) * z );
+}
+
+// Invert 4x4 Rigid Transform
+static inline cv::Matx44f invertRigid( const cv::Matx44f& transform )
+{
+    cv::Matx44f inverse = cv::Matx44f::eye();
+    for( int32_t r = 0; r < 3; r++ ){
+        for( int32_t c = 0; c < 3; c++ ){
+            inverse( r, c ) = transform( c, r );
+        }
+        inverse( r, 3 ) = -( transform( 0, r ) * transform( 0, 3 ) + transform( 1, r ) * transform( 1, 3 ) + transform( 2, r ) * transform( 2, 3 ) );
+    }
+    return inverse;
+}
+
+// Constructor
+TSDFVolume::TSDFVolume( const float voxel_size, const float truncation, const size_t max_blocks )
+    : voxel_size( voxel_size )
+    , truncation( truncation )
+    , max_weight( 64.0f )
+    , min_depth( 0.1f )
+    , max_depth( 4.0f )
+    , allocation_step( 2 )
+    , blocks( max_blocks )
+    , block_keys( max_blocks )
+{
+    block_table.reserve( max_blocks );
+}
+
+// Destructor
+TSDFVolume::~TSDFVolume()
+{
+}
+
+// Reset Volume
+void TSDFVolume::reset()
+{
+    block_table.clear();
+    num_blocks = 0;
+}
+
+// Integrate Depth Frame (CV_16UC1) with Camera to World Pose
+void TSDFVolume::integrate( const cv::Mat& depth_mat, const rs2_intrinsics& intrinsics, const float depth_scale, const cv::Matx44f& camera_to_world )
+{
+    if( depth_mat.empty() ){
+        return;
+    }
+
+    // Allocate Blocks in Truncation Band of Depth Frame
+    allocateBlocks( depth_mat, intrinsics, depth_scale, camera_to_world );
+
+    // Integrate Visible Blocks
+    integrateBlocks( depth_mat, intrinsics, depth_scale, invertRigid( camera_to_world ) );
+}
+
+// Allocate Blocks in Truncation Band of Depth Frame
+inline void TSDFVolume::allocateBlocks( const cv::Mat& depth_mat, const rs2_intrinsics& intrinsics, const float depth_scale, const cv::Matx44f& camera_to_world )
+{
+    #ifdef _OPENMP
+    thread_keys.resize( omp_get_max_threads() );
+    #else
+    thread_keys.resize( 1 );
+    #endif
+
+    const float block_length = voxel_size * block_size;
+    const float inverse_block_length = 1.0f / block_length;
+    const float band_step = block_length * 0.5f;
+
+    // Collect Keys of Blocks along Rays in Truncation Band
+    #pragma omp parallel
+    {
+        #ifdef _OPENMP
+        std::vector<uint64_t>& keys = thread_keys[omp_get_thread_num()];
+        #else
+        std::vector<uint64_t>& keys = thread_keys[0];
+        #endif
+        keys.clear();
+
+        #pragma omp for schedule( dynamic, 8 )
+        for( int32_t v = 0; v < depth_mat.rows; v += allocation_step ){
+            const uint16_t* depth_row = depth_mat.ptr<uint16_t>( v );
+            for( int32_t u = 0; u < depth_mat.cols; u += allocation_step ){
+                const float depth = depth_row[u] * depth_scale;
+                if( depth < min_depth || max_depth < depth ){
+                    continue;
+                }
+
+                const float x = ( u - intrinsics.ppx ) / intrinsics.fx;
+                const float y = ( v - intrinsics.ppy ) / intrinsics.fy;
+                for( float d = depth - truncation; d <= depth + truncation; d += band_step ){
+                    const cv::Vec3f point = transformPoint( camera_to_world, x * d, y * d, d );
+                    keys.push_back( key( static_cast<int32_t>( std::floor( point[0] * inverse_block_length ) ),
+                                         static_cast<int32_t>( std::floor( point[1] * inverse_block_length ) ),
+                                         static_cast<int32_t>( std::floor( point[2] * inverse_block_length ) ) ) );
+                }
+            }
+        }
+
+        // Remove Duplicated Keys in Thread
+        std::sort( keys.begin(), keys.end() );
+        keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+    }
+
+    // Merge Keys of All Threads
+    visible_keys.clear();
+    for( const std::vector<uint64_t>& keys : thread_keys ){
+        visible_keys.insert( visible_keys.end(), keys.begin(), keys.end() );
+    }
+    std::sort( visible_keys.begin(), visible_keys.end() );
+    visible_keys.erase( std::unique( visible_keys.begin(), visible_keys.end() ), visible_keys.end() );
+
+    // Allocate New Blocks (Blocks beyond Capacity are Ignored)
+    visible_blocks.clear();
+    for( const uint64_t block_key : visible_keys ){
+        std::unordered_map<uint64_t, int32_t>::const_iterator it = block_table.find( block_key );
+        if( it != block_table.end() ){
+            visible_blocks.push_back( it->second );
+            continue;
+        }
+
+        if( num_blocks == blocks.size() ){
+            continue;
+        }
+
+        const int32_t index = static_cast<int32_t>( num_blocks++ );
+        blocks[index] = Block();
+        block_keys[index] = block_key;
+        block_table.emplace( block_key, index );
+        visible_blocks.push_back( index );
+    }
+}
+
+// Integrate Visible Blocks
+inline void TSDFVolume::integrateBlocks( const cv::Mat& depth_mat, const rs2_intrinsics& intrinsics, const float depth_scale, const cv::Matx44f& world_to_camera )
+{
+    const int32_t num_visible_blocks = static_cast<int32_t>( visible_blocks.size() );
+    const float inverse_truncation = 1.0f / truncation;
+
+    #pragma omp parallel for schedule( dynamic, 16 )
+    for( int32_t i = 0; i < num_visible_blocks; i++ ){
+        const int32_t index = visible_blocks[i];
+        Block& block = blocks[index];
+
+        int32_t block_x, block_y, block_z;
+        unkey( block_keys[index], block_x, block_y, block_z );
+
+        for( int32_t z = 0; z < block_size; z++ ){
+            for( int32_t y = 0; y < block_size; y++ ){
+                for( int32_t x = 0; x < block_size; x++ ){
+                    // Project Voxel Center to Depth Frame
+                    const cv::Vec3f point = transformPoint( world_to_camera,
+                                                            ( block_x * block_size + x + 0.5f ) * voxel_size,
+                                                            ( block_y * block_size + y + 0.5f ) * voxel_size,
+                                                            ( block_z * block_size + z + 0.5f ) * voxel_size );
+                    if( point[2] <= 0.0f ){
+                        continue;
+                    }
+
+                    const int32_t u = static_cast<int32_t>( std::lround( point[0] / point[2] * intrinsics.fx + intrinsics.ppx ) );
+                    const int32_t v = static_cast<int32_t>( std::lround( point[1] / point[2] * intrinsics.fy + intrinsics.ppy ) );
+                    if( u < 0 || depth_mat.cols <= u || v < 0 || depth_mat.rows <= v ){
+                        continue;
+                    }
+
+                    const float depth = depth_mat.at<uint16_t>( v, u ) * depth_scale;
+                    if( depth < min_depth || max_depth < depth ){
+                        continue;
+                    }
+
+                    // Update Truncated Signed Distance by Running Weighted Average
+                    const float sdf = depth - point[2];
+                    if( sdf < -truncation ){
+                        continue;
+                    }
+
+                    Voxel& voxel = block.voxels[( z * block_size + y ) * block_size + x];
+                    const float tsdf = std::min( 1.0f, sdf * inverse_truncation );
+                    voxel.tsdf = ( voxel.tsdf * voxel.weight + tsdf ) / ( voxel.weight + 1.0f );
+                    voxel.weight = std::min( voxel.weight + 1.0f, max_weight );
+                }
+            }
+        }
+    }
+}
+
+// Ray-Cast Volume to Depth (CV_32FC1, [m]) and Shaded Image (CV_8UC1) from Camera to World Pose
+void TSDFVolume::raycast( const rs2_intrinsics& intrinsics, const cv::Matx44f& camera_to_world, cv::Mat& depth_mat, cv::Mat& shade_mat ) const
+{
+    depth_mat.create( intrinsics.height, intrinsics.width, CV_32FC1 );
+    shade_mat.create( intrinsics.height, intrinsics.width, CV_8UC1 );
+
+    const cv::Vec3f origin( camera_to_world( 0, 3 ), camera_to_world( 1, 3 ), camera_to_world( 2, 3 ) );
+    const float skip_step = voxel_size * block_size * 0.5f;
+
+    #pragma omp parallel for schedule( dynamic, 4 )
+    for( int32_t v = 0; v < intrinsics.height; v++ ){
+        float* depth_row = depth_mat.ptr<float>( v );
+        uint8_t* shade_row = shade_mat.ptr<uint8_t>( v );
+        for( int32_t u = 0; u < intrinsics.width; u++ ){
+            depth_row[u] = 0.0f;
+            shade_row[u] = 0;
+
+            // Ray Direction in Camera and World
+            const float x = ( u - intrinsics.ppx ) / intrinsics.fx;
+            const float y = ( v - intrinsics.ppy ) / intrinsics.fy;
+            const float inverse_norm = 1.0f / std::sqrt( x * x + y * y + 1.0f );
+            const cv::Vec3f direction = rotateDirection( camera_to_world, x * inverse_norm, y * inverse_norm, inverse_norm );
+
+            // March Ray until Zero Crossing from Positive to Negative
+            float previous_t = 0.0f;
+            float previous_tsdf = 0.0f;
+            bool previous_valid = false;
+            for( float t = min_depth / inverse_norm; t < max_depth / inverse_norm; ){
+                const cv::Vec3f position = origin + direction * t;
+                float tsdf;
+                if( !sample( position, tsdf ) ){
+                    previous_valid = false;
+                    t += skip_step;
+                    continue;
+                }
+
+                if( previous_valid && previous_tsdf > 0.0f && tsdf <= 0.0f ){
+                    // Interpolate Surface Position
+                    const float hit_t = previous_t + ( t - previous_t ) * previous_tsdf / ( previous_tsdf - tsdf );
+                    depth_row[u] = hit_t * inverse_norm;
+
+                    // Shade by Normal from TSDF Gradient
+                    const cv::Vec3f hit = origin + direction * hit_t;
+                    float nx0, nx1, ny0, ny1, nz0, nz1;
+                    if( sample( hit + cv::Vec3f( voxel_size, 0.0f, 0.0f ), nx1 ) && sample( hit - cv::Vec3f( voxel_size, 0.0f, 0.0f ), nx0 )
+                     && sample( hit + cv::Vec3f( 0.0f, voxel_size, 0.0f ), ny1 ) && sample( hit - cv::Vec3f( 0.0f, voxel_size, 0.0f ), ny0 )
+                     && sample( hit + cv::Vec3f( 0.0f, 0.0f, voxel_size ), nz1 ) && sample( hit - cv::Vec3f( 0.0f, 0.0f, voxel_size ), nz0 ) ){
+                        const cv::Vec3f gradient( nx1 - nx0, ny1 - ny0, nz1 - nz0 );
+                        const float norm = std::sqrt( gradient.dot( gradient ) );
+                        if( norm > 0.0f ){
+                            const float lambert = -gradient.dot( direction ) / norm;
+                            shade_row[u] = static_cast<uint8_t>( std::max( 0.0f, lambert ) * 255.0f );
+                        }
+                    }
+                    break;
+                }
+
+                // Step Proportional to Distance to Surface
+                previous_t = t;
+                previous_tsdf = tsdf;
+                previous_valid = true;
+                t += std::max( voxel_size, tsdf * truncation * 0.8f );
+            }
+        }
+    }
+}
+
+// Extract Surface Points (Zero Crossing of TSDF)
+void TSDFVolume::extract( std::vector<cv::Vec3f>& points ) const
+{
+    points.clear();
+
+    const int32_t num_allocated_blocks = static_cast<int32_t>( num_blocks );
+
+    #pragma omp parallel
+    {
+        std::vector<cv::Vec3f> thread_points;
+
+        #pragma omp for schedule( dynamic, 16 )
+        for( int32_t index = 0; index < num_allocated_blocks; index++ ){
+            const Block& block = blocks[index];
+
+            int32_t block_x, block_y, block_z;
+            unkey( block_keys[index], block_x, block_y, block_z );
+
+            for( int32_t z = 0; z < block_size; z++ ){
+                for( int32_t y = 0; y < block_size; y++ ){
+                    for( int32_t x = 0; x < block_size; x++ ){
+                        const Voxel& voxel = block.voxels[( z * block_size + y ) * block_size + x];
+                        if( voxel.weight == 0.0f ){
+                            continue;
+                        }
+
+                        // Find Sign Change to Neighbor Voxels (+X, +Y, +Z)
+                        const cv::Vec3f position( ( block_x * block_size + x + 0.5f ) * voxel_size,
+                                                  ( block_y * block_size + y + 0.5f ) * voxel_size,
+                                                  ( block_z * block_size + z + 0.5f ) * voxel_size );
+                        for( int32_t axis = 0; axis < 3; axis++ ){
+                            cv::Vec3f offset( 0.0f, 0.0f, 0.0f );
+                            offset[axis] = voxel_size;
+
+                            float neighbor_tsdf;
+                            if( !sample( position + offset, neighbor_tsdf ) ){
+                                continue;
+                            }
+
+                            if( ( voxel.tsdf > 0.0f ) == ( neighbor_tsdf > 0.0f ) ){
+                                continue;
+                            }
+
+                            const float ratio = voxel.tsdf / ( voxel.tsdf - neighbor_tsdf );
+                            thread_points.push_back( position + offset * ratio );
+                        }
+                    }
+                }
+            }
+        }
+
+        #pragma omp critical
+        points.insert( points.end(), thread_points.begin(), thread_points.end() );
+    }
+}
+
+// Retrieve TSDF at World Position (Returns false if Unobserved)
+inline bool TSDFVolume::sample( const cv::Vec3f& position, float& tsdf ) const
+{
+    const int32_t x = static_cast<int32_t>( std::floor( position[0] / voxel_size ) );
+    const int32_t y = static_cast<int32_t>( std::floor( position[1] / voxel_size ) );
+    const int32_t z = static_cast<int32_t>( std::floor( position[2] / voxel_size ) );
+
+    // Floor Division for Negative Index
+    const int32_t block_x = ( x >= 0 ) ? x / block_size : ( x - block_size + 1 ) / block_size;
+    const int32_t block_y = ( y >= 0 ) ? y / block_size : ( y - block_size + 1 ) / block_size;
+    const int32_t block_z = ( z >= 0 ) ? z / block_size : ( z - block_size + 1 ) / block_size;
+
+    std::unordered_map<uint64_t, int32_t>::const_iterator it = block_table.find( key( block_x, block_y, block_z ) );
+    if( it == block_table.end() ){
+        return false;
+    }
+
+    const Voxel& voxel = blocks[it->second].voxels[( ( z - block_z * block_size ) * block_size + ( y - block_y * block_size ) ) * block_size + ( x - block_x * block_size )];
+    if( voxel.weight == 0.0f ){
+        return false;
+    }
+
+    tsdf = voxel.tsdf;
+    return true;
+}
+
+// Pack Block Index into Key (21bit per Axis)
+inline uint64_t TSDFVolume::key( const int32_t x, const int32_t y, const int32_t z )
+{
+    constexpr int32_t offset = 1 << 20;
+    constexpr uint64_t mask = ( 1ull << 21 ) - 1;
+    return ( ( static_cast<uint64_t>( x + offset ) & mask ) << 42 )
+         | ( ( static_cast<uint64_t>( y + offset ) & mask ) << 21 )
+         | ( ( static_cast<uint64_t>( z + offset ) & mask ) );
+}
+
+// Unpack Key into Block Index
+inline void TSDFVolume::unkey( const uint64_t key, int32_t& x, int32_t& y, int32_t& z )
+{
+    constexpr int32_t offset = 1 << 20;
+    constexpr uint64_t mask = ( 1ull << 21 ) - 1;
+    x = static_cast<int32_t>( ( key >> 42 ) & mask ) - offset;
+    y = static_cast<int32_t>( ( key >> 21 ) & mask ) - offset;
+    z = static_cast<int32_t>( key & mask ) - offset;
+}
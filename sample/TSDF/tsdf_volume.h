@@ -0,0 +1,91 @@
+#ifndef __TSDF_VOLUME__
+#define __TSDF_VOLUME__
+
+#include <librealsense2/rs.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Truncated Signed Distance Field Volume on Sparse Voxel Block Hash
+class TSDFVolume
+{
+public:
+    // Voxel
+    struct Voxel
+    {
+        float tsdf = 1.0f;
+        float weight = 0.0f;
+    };
+
+    // Voxel Block (8x8x8 Voxels)
+    static constexpr int32_t block_size = 8;
+    struct Block
+    {
+        Voxel voxels[block_size * block_size * block_size];
+    };
+
+private:
+    // Volume Parameters
+    float voxel_size;      // [m]
+    float truncation;      // [m]
+    float max_weight;
+    float min_depth;       // [m]
+    float max_depth;       // [m]
+    int32_t allocation_step;
+
+    // Voxel Block Hash
+    std::vector<Block> blocks;
+    std::vector<uint64_t> block_keys;
+    std::unordered_map<uint64_t, int32_t> block_table;
+    size_t num_blocks = 0;
+
+    // Integration Buffer
+    std::vector<std::vector<uint64_t>> thread_keys;
+    std::vector<uint64_t> visible_keys;
+    std::vector<int32_t> visible_blocks;
+
+public:
+    // Constructor
+    TSDFVolume( const float voxel_size = 0.01f, const float truncation = 0.04f, const size_t max_blocks = 16384 );
+
+    // Destructor
+    ~TSDFVolume();
+
+    // Reset Volume
+    void reset();
+
+    // Integrate Depth Frame (CV_16UC1) with Camera to World Pose
+    void integrate( const cv::Mat& depth_mat, const rs2_intrinsics& intrinsics, const float depth_scale, const cv::Matx44f& camera_to_world );
+
+    // Ray-Cast Volume to Depth (CV_32FC1, [m]) and Shaded Image (CV_8UC1) from Camera to World Pose
+    void raycast( const rs2_intrinsics& intrinsics, const cv::Matx44f& camera_to_world, cv::Mat& depth_mat, cv::Mat& shade_mat ) const;
+
+    // Extract Surface Points (Zero Crossing of TSDF)
+    void extract( std::vector<cv::Vec3f>& points ) const;
+
+    // Retrieve Number of Allocated Blocks
+    size_t allocated() const { return num_blocks; }
+
+    // Retrieve Capacity of Blocks
+    size_t capacity() const { return blocks.size(); }
+
+private:
+    // Allocate Blocks in Truncation Band of Depth Frame
+    inline void allocateBlocks( const cv::Mat& depth_mat, const rs2_intrinsics& intrinsics, const float depth_scale, const cv::Matx44f& camera_to_world );
+
+    // Integrate Visible Blocks
+    inline void integrateBlocks( const cv::Mat& depth_mat, const rs2_intrinsics& intrinsics, const float depth_scale, const cv::Matx44f& world_to_camera );
+
+    // Retrieve TSDF at World Position (Returns false if Unobserved)
+    inline bool sample( const cv::Vec3f& position, float& tsdf ) const;
+
+    // Pack Block Index into Key (21bit per Axis)
+    static inline uint64_t key( const int32_t x, const int32_t y, const int32_t z );
+
+    // Unpack Key into Block Index
+    static inline void unkey( const uint64_t key, int32_t& x, int32_t& y, int32_t& z );
+};
+
+#endif // __TSDF_VOLUME__